@@ -36,6 +36,12 @@ namespace gs
 		std::string getCwd();
 		bool changeCwd(const std::string& dirname);
 
+		/**
+		 * Create the directory (only the last directory of the path).
+		 * @return True if the directory is created or already exist.
+		 */
+		bool createDirectory(const std::string& dirname);
+
 		std::string readFileAsString(const std::string& filename);
 
 		/**
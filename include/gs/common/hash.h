@@ -0,0 +1,41 @@
+#ifndef GLSLSCENE_HASH_H
+#define GLSLSCENE_HASH_H
+
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace gs
+{
+	namespace hash
+	{
+		// FNV-1a (64 bit). Fast and good enough for cache keys.
+		const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+		const uint64_t FNV_PRIME = 1099511628211ULL;
+
+		inline uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; ++i) {
+				hash ^= bytes[i];
+				hash *= FNV_PRIME;
+			}
+			return hash;
+		}
+
+		// the size is also hashed --> "ab" + "c" and "a" + "bc" are different
+		inline uint64_t hashString(uint64_t hash, const std::string& str)
+		{
+			uint64_t size = str.size();
+			hash = hashBytes(hash, &size, sizeof(size));
+			return hashBytes(hash, str.data(), str.size());
+		}
+
+		inline uint64_t hashU32(uint64_t hash, uint32_t value)
+		{
+			return hashBytes(hash, &value, sizeof(value));
+		}
+	}
+}
+
+#endif //GLSLSCENE_HASH_H
@@ -0,0 +1,55 @@
+#ifndef GLSLSCENE_SPSC_QUEUE_H
+#define GLSLSCENE_SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+namespace gs
+{
+	/**
+	 * Lock-free ring buffer for one producer thread and one consumer thread.
+	 * The producer only writes mHead and the consumer only writes mTail.
+	 * @param CAPACITY Must be a power of two.
+	 */
+	template<typename T, size_t CAPACITY>
+	class SpscQueue
+	{
+		static_assert(CAPACITY && !(CAPACITY & (CAPACITY - 1)), "CAPACITY must be a power of two");
+	public:
+		SpscQueue() :mItems(), mPad1(), mHead(0), mPad2(), mTail(0) {}
+
+		// must only be called by the producer. Return false if the queue is full.
+		bool push(const T& item)
+		{
+			size_t head = mHead.load(std::memory_order_relaxed);
+			if (head - mTail.load(std::memory_order_acquire) == CAPACITY) {
+				return false;
+			}
+			mItems[head & (CAPACITY - 1)] = item;
+			mHead.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		// must only be called by the consumer. Return false if the queue is empty.
+		bool pop(T& outItem)
+		{
+			size_t tail = mTail.load(std::memory_order_relaxed);
+			if (tail == mHead.load(std::memory_order_acquire)) {
+				return false;
+			}
+			outItem = mItems[tail & (CAPACITY - 1)];
+			mTail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+	private:
+		T mItems[CAPACITY];
+		// padding --> producer and consumer don't write to the same cache line
+		// (no alignas() because new doesn't support over-aligned types before C++17)
+		char mPad1[64];
+		std::atomic<size_t> mHead;
+		char mPad2[64];
+		std::atomic<size_t> mTail;
+	};
+}
+
+#endif //GLSLSCENE_SPSC_QUEUE_H
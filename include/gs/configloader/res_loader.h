@@ -15,9 +15,18 @@ namespace gs
 
 	namespace resloader
 	{
-		bool addResources(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValue);
+		/**
+		 * @param prevRm If not null then the unchanged resources of the
+		 *        previous resource manager are taken over (incremental
+		 *        reload of the scene). See ResourceManager::takeOverResources().
+		 */
+		bool addResources(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValue,
+				const ResourceManager* prevRm = nullptr);
 		TResourceId addResource(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValue);
+		bool setTextureCache(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValuePair);
+		bool setShaderCache(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValuePair);
 		TTextureId addTexture(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValuePair);
+		TTextureAtlasId addTextureAtlas(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValuePair);
 		TShaderId addShaderProgram(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValuePair);
 		TMeshId addMesh(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValuePair);
 		TFramebufferId addFramebuffer(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValuePair);
@@ -93,10 +93,15 @@ namespace gs
 
 	namespace sceneloader
 	{
+		/**
+		 * @param prevRm Previous resource manager. Is used to take over the
+		 *        unchanged resources. Can be null.
+		 */
 		bool reload(const cfg::NameValuePair& cfg,
 				const std::weak_ptr<FileChangeMonitoring>& fcm,
 				ResourceManager& rm, SceneManager& sm, RenderPassManager& pm,
-				bool reloadResourceManager, bool reloadSceneManager, bool reloadRenderPassManager);
+				bool reloadResourceManager, bool reloadSceneManager, bool reloadRenderPassManager,
+				const ResourceManager* prevRm = nullptr);
 
 		bool addTransform(const cfg::Value& cfgValue,
 				TransformComponent& transform2d);
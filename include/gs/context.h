@@ -5,6 +5,7 @@
 #include <gs/context_properties.h>
 #include <SDL.h>
 #include <memory>
+#include <future>
 
 namespace cfg
 {
@@ -18,6 +19,12 @@ namespace gs
 	class RenderPassManager;
 	class GuiManager;
 	class FileChangeMonitoring;
+	class ShaderBinaryCache;
+	class ShaderIncludeCache;
+	class ShaderObjectCache;
+	class TextureDecoder;
+	class RenderTargetPool;
+	class PixelBufferPool;
 
 	class Context
 	{
@@ -30,6 +37,24 @@ namespace gs
 		bool run();
 
 	private:
+		/**
+		 * Reloaded scene which is not used yet. The current scene is
+		 * rendered until the textures of the reloaded scene are uploaded.
+		 * A manager is null if the current manager is kept.
+		 */
+		class StagedReload
+		{
+		public:
+			std::unique_ptr<cfg::NameValuePair> mSceneConfig;
+			std::shared_ptr<FileChangeMonitoring> mFileMonitoring;
+			std::unique_ptr<ResourceManager> mResourceManager;
+			std::unique_ptr<SceneManager> mSceneManager;
+			std::unique_ptr<RenderPassManager> mPassManager;
+			// false if the resources, scenes and rendering are not changed
+			bool mIsChanged = false;
+			bool mIsLoaded = false;
+		};
+
 		std::unique_ptr<cfg::NameValuePair> mSceneConfig;
 
 		// to change the parameters for context creation,
@@ -46,6 +71,12 @@ namespace gs
 		unsigned int mHotReloadingId = 0;
 		std::shared_ptr<FileChangeMonitoring> mFileMonitoring;
 		bool mReloadSceneNow = false;
+		// the scene file is parsed and loaded by another thread (the scene
+		// config is null for a parse error)
+		std::future<std::unique_ptr<StagedReload> > mStagedReloadFuture;
+		std::unique_ptr<StagedReload> mStagedReload;
+		// record of the hot reload statistic for the scene file (0 for none)
+		unsigned int mSceneReloadId = 0;
 
 		Properties mProperties;
 
@@ -53,17 +84,47 @@ namespace gs
 		std::unique_ptr<SceneManager> mSceneManager;
 		std::unique_ptr<RenderPassManager> mPassManager;
 		std::unique_ptr<GuiManager> mGuiManager;
+		// is used by all resource managers (survive a reload of the scene)
+		std::shared_ptr<ShaderBinaryCache> mShaderBinaryCache;
+		std::shared_ptr<ShaderIncludeCache> mShaderIncludeCache;
+		std::shared_ptr<ShaderObjectCache> mShaderObjectCache;
+		// is used by all resource managers (before the decoder --> the
+		// decoder threads are stopped before the buffers are deleted)
+		std::shared_ptr<PixelBufferPool> mPixelBufferPool;
+		// is used by all resource managers (the threads survive a reload)
+		std::shared_ptr<TextureDecoder> mTextureDecoder;
+		// released render targets of a replaced scene can be reused
+		std::shared_ptr<RenderTargetPool> mRenderTargetPool;
 
 		// select and load config file for scene
 		bool selectScene(const std::string& progname);
 		void initContext();
 		void destroyContext();
+		// log the counters of the last frame and write it as TML file
+		void dumpRenderStatistic();
 
 		static void hotReloading(unsigned int callbackId,
 				const std::string& filename,
 				const std::shared_ptr<void>& fileMonitoring, void* thisContext);
 		void hotReloadingSceneFile(unsigned int callbackId, const std::string& filename);
-		void reload();
+		// start loading the scene file (asynchronously)
+		void startReload();
+		/**
+		 * Must be called once per frame by the GL thread.
+		 * @return True if the reloaded scene is applied.
+		 */
+		bool updateReload();
+		/**
+		 * Is called by the loading thread. Load the changed sections into
+		 * new managers without the GL context (the GPU objects are created
+		 * by updateReload()).
+		 */
+		std::unique_ptr<StagedReload> loadStagedReload();
+		// replace the current managers
+		void applyStagedReload();
+		void discardStagedReload();
+		// the reload of the scene file is not shown (e.g. error or not changed)
+		void releaseSceneReload();
 	};
 }
 
@@ -42,6 +42,7 @@ namespace gs
 		std::string mCreatedRenderer;
 		int mCreatedMajorVersion = -1; // -1 for not specified
 		int mCreatedMinorVersion = -1; // -1 for not specified
+		int mCreatedMaxTextureSize = 0; // GL_MAX_TEXTURE_SIZE
 
 		std::string mSceneDirName;
 
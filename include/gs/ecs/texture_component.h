@@ -35,12 +35,17 @@ namespace gs
 
 		// reset all other textures (if multitexturing is used) and only
 		// set one texture.
-		void setTextureId(TTextureId textureId, unsigned int textureUnit);
+		// fbAttachment is only used if the texture id is a framebuffer.
+		// See Framebuffer::getTexRes().
+		void setTextureId(TTextureId textureId, unsigned int textureUnit,
+				unsigned int fbAttachment = 0);
 		unsigned int getUsedFlags() const { return mIsUsedFlags; }
 		const TTextureId* getTextureIds() const { return mTextureIds; }
+		const unsigned int* getFramebufferAttachments() const { return mFbAttachments; }
 	private:
 		unsigned int mIsUsedFlags;
 		TTextureId mTextureIds[MAX_TEXTURE_UNITS];
+		unsigned int mFbAttachments[MAX_TEXTURE_UNITS];
 		//vertex::ETexCoordinateType mTexCoordType = vertex::TEX_NORMALIZED;
 	};
 }
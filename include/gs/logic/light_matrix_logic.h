@@ -3,10 +3,14 @@
 
 #include <gs/logic/logic.h>
 #include <gs/common/vector2.h>
+#include <gs/res/uniform.h>
 #include <string>
+#include <memory>
 
 namespace gs
 {
+	class ShaderProgram;
+
 	class LightMatrixLogic: public Logic
 	{
 	public:
@@ -21,6 +25,8 @@ namespace gs
 		const std::string mShaderIdName;
 		unsigned int mLightNr;
 		bool mWarningIsPrinted = false;
+		std::weak_ptr<ShaderProgram> mShader;
+		UniformHandle mModelMatrixHandle;
 	};
 }
 
@@ -17,6 +17,10 @@ namespace gs
 
 		bool mDrawNormals = false;
 
+		// is incremented for each frame. 0 --> unknown (e.g. the per frame
+		// uniforms of the shader programs are uploaded at each bind)
+		unsigned int mFrameNumber = 0;
+
 		uint32_t mTsMsec = 0;
 		float mTsSec = 0.0f;
 
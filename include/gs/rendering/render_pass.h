@@ -7,11 +7,23 @@
 #include <gs/common/size2.h>
 #include <glm/mat4x4.hpp>
 #include <memory>
+#include <stdint.h>
 
 namespace gs
 {
 	class Camera;
 
+	/**
+	 * What happens with the content of an attachment at the begin of a
+	 * render pass.
+	 */
+	enum class LoadAction
+	{
+		CLEAR = 0, // clear with the clear color (or depth 1.0)
+		KEEP, // content of the last rendering is kept
+		DONT_CARE, // content is undefined (glInvalidateFramebuffer() if supported)
+	};
+
 	class RenderPass
 	{
 	public:
@@ -24,9 +36,30 @@ namespace gs
 		std::shared_ptr<Camera> mCamera; // null if not used
 		unsigned int mSceneId;
 		bool mDepthTest = false;
+		LoadAction mColorLoad = LoadAction::CLEAR;
+		LoadAction mDepthLoad = LoadAction::CLEAR;
+
+		// Progressive rendering: The framebuffer is divided into tiles.
+		// Each frame only mTilesPerFrame tiles are rendered (with scissor
+		// test). Is only possible for a framebuffer (not for default).
+		unsigned int mTileCols = 1;
+		unsigned int mTileRows = 1;
+		unsigned int mTilesPerFrame = 1;
+		// false: the last complete image is shown (present buffer is used)
+		// true: the partial rendered image is shown
+		bool mProgressivePreview = false;
+		// state of the progressive rendering, is set by render pass manager
+		unsigned int mNextTile = 0;
+		unsigned int mCompletedImageCount = 0;
+		// the time is frozen for all tiles of one image
+		uint32_t mImageTsMsec = 0;
+		float mImageTsSec = 0.0f;
 
 		RenderPass(TResourceId fbId, const Color& clearColor, unsigned int sceneId);
 		~RenderPass();
+
+		bool isProgressive() const { return mTileCols * mTileRows > 1; }
+		unsigned int getTileCount() const { return mTileCols * mTileRows; }
 	};
 }
 
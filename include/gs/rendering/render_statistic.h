@@ -0,0 +1,86 @@
+#ifndef GLSLSCENE_RENDER_STATISTIC_H
+#define GLSLSCENE_RENDER_STATISTIC_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace gs
+{
+	/**
+	 * Counters for one render pass or for a whole frame.
+	 */
+	class RenderCounters
+	{
+	public:
+		unsigned int mDrawCalls = 0;
+		unsigned int mVertices = 0; // submitted vertices of all draw calls
+		unsigned int mProgramBinds = 0;
+		unsigned int mTextureBinds = 0;
+		unsigned int mVaoBinds = 0;
+		unsigned int mVboBinds = 0;
+		unsigned int mUniformUploads = 0;
+		uint64_t mBufferUploadBytes = 0;
+		unsigned int mFramebufferSwitches = 0;
+
+		void reset() { *this = RenderCounters(); }
+		RenderCounters& operator+=(const RenderCounters& c);
+
+		// one line with all counters. e.g. for logging
+		std::string toString() const;
+	};
+
+	/**
+	 * The render statistic is always enabled. The counters are increased
+	 * directly at the places where the gl calls happen (stacks, mesh, ...).
+	 * Therefore the counting is only an increment of an integer.
+	 *
+	 * The render pass manager calls endPass() after each render pass.
+	 * Everything which is counted after the last render pass (e.g. GUI) is
+	 * only added to the frame counters but not to a pass.
+	 * The values of the last finished frame can be read with
+	 * getFrameCounters() and getPassCounters().
+	 */
+	class RenderStatistic
+	{
+	public:
+		RenderStatistic();
+		~RenderStatistic();
+
+		// counters which are currently increased (current render pass)
+		RenderCounters& current() { return mCurrent; }
+
+		void endPass();
+		void endFrame();
+
+		// counters of the last finished frame (sum of all passes + the rest)
+		const RenderCounters& getFrameCounters() const { return mFrame; }
+		// counters of the last finished frame per render pass
+		const std::vector<RenderCounters>& getPassCounters() const { return mPasses; }
+		// count of finished frames
+		unsigned int getFrameNumber() const { return mFrameNumber; }
+
+		/**
+		 * Machine-readable dump of the last finished frame. The TML format
+		 * is used (same as for the scene files). Each counter is one
+		 * name value pair.
+		 */
+		std::string toTmlString() const;
+		bool writeToFile(const std::string& filename) const;
+	private:
+		RenderCounters mCurrent;
+		RenderCounters mCurrentFrame;
+		std::vector<RenderCounters> mCurrentPasses;
+
+		RenderCounters mFrame;
+		std::vector<RenderCounters> mPasses;
+		unsigned int mFrameNumber;
+	};
+
+	// always return a valid render statistic (never null)
+	RenderStatistic& getRenderStatistic();
+
+	inline RenderCounters& renderCounters() { return getRenderStatistic().current(); }
+}
+
+#endif //GLSLSCENE_RENDER_STATISTIC_H
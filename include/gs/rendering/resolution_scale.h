@@ -0,0 +1,67 @@
+#ifndef GLSLSCENE_RESOLUTION_SCALE_H
+#define GLSLSCENE_RESOLUTION_SCALE_H
+
+#include <stdint.h>
+
+namespace gs
+{
+	/**
+	 * Scale factor for the resolution of a framebuffer. The scale is fixed
+	 * or dynamic. For a dynamic scale a simple frame time controller is
+	 * used: If the average frame time is above the target frame time then
+	 * the scale is decreased. If the frame time is clearly below the target
+	 * then the scale is increased (up to the max scale).
+	 *
+	 * The scale is only changed in steps of SCALE_STEP and not more often
+	 * than every ADJUST_INTERVAL_MSEC. Otherwise the framebuffer would be
+	 * reallocated too often.
+	 */
+	class ResolutionScale
+	{
+	public:
+		static constexpr float SCALE_STEP = 0.05f;
+		static const uint32_t ADJUST_INTERVAL_MSEC = 500;
+
+		// fixed scale of 1.0
+		ResolutionScale();
+		~ResolutionScale();
+
+		void setFixed(float scale);
+		/**
+		 * @param targetFrameTimeMsec Frame time budget in milli seconds
+		 *        (e.g. 16.6 for 60 fps).
+		 */
+		void setDynamic(float targetFrameTimeMsec, float minScale, float maxScale);
+
+		/**
+		 * Should be called once per frame. If it's called more than once for
+		 * the same timestamp then only the first call is used.
+		 * @return True if the scale is changed.
+		 */
+		bool update(float deltaTimeSec, uint32_t tsMsec);
+
+		float getScale() const { return mScale; }
+		bool isDynamic() const { return mIsDynamic; }
+		// false for a fixed scale of 1.0 (no float compare by the caller)
+		bool isScaled() const { return mIsScaled; }
+		float getTargetFrameTimeMsec() const { return mTargetFrameTimeMsec; }
+		float getMinScale() const { return mMinScale; }
+		float getMaxScale() const { return mMaxScale; }
+		// average frame time which is used by the controller
+		float getAvgFrameTimeMsec() const { return mAvgFrameTimeMsec; }
+	private:
+		float mScale;
+		bool mIsDynamic;
+		bool mIsScaled;
+		float mTargetFrameTimeMsec;
+		float mMinScale;
+		float mMaxScale;
+
+		float mAvgFrameTimeMsec;
+		bool mHasTs;
+		uint32_t mLastTsMsec;
+		uint32_t mLastAdjustTsMsec;
+	};
+}
+
+#endif //GLSLSCENE_RESOLUTION_SCALE_H
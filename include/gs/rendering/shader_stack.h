@@ -7,8 +7,6 @@
 #include <memory>
 #include <array>
 
-//#define ENABLE_SHADER_STACK_STATISTIC
-
 namespace gs
 {
 	class ShaderProgram;
@@ -55,6 +53,8 @@ namespace gs
 
 		Properties mProperties;
 		Matrices mMatrices;
+		// is changed by setGlobalProperties() (see ShaderProgram::bind())
+		unsigned int mPassSerial;
 
 		void bindShaderProgram(ShaderProgram* shaderProgram);
 	};
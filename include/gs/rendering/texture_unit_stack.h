@@ -4,8 +4,6 @@
 #include <array>
 #include <memory>
 
-//#define ENABLE_TEXTURE_UNIT_STACK_STATISTIC
-
 namespace gs
 {
 	class Texture;
@@ -27,9 +25,6 @@ namespace gs
 		void switchToTextureUnitForLoading();
 		void switchToTextureUnit(unsigned int textureUnit);
 
-		void resetStatistic();
-		void printStatistic();
-
 		enum EDefs
 		{
 			MAX_UNITS = 8,
@@ -37,18 +32,6 @@ namespace gs
 		};
 
 	private:
-#ifdef ENABLE_TEXTURE_UNIT_STACK_STATISTIC
-		class Statistic
-		{
-		public:
-			int mBindCalls = 0;
-			void reset()
-			{
-				mBindCalls = 0;
-			}
-		};
-#endif
-
 		class TextureUnit
 		{
 		public:
@@ -62,18 +45,11 @@ namespace gs
 			// then mMustBeBinded is true or "out of range/layers"
 			Texture* mCurrentBindedTexture = nullptr;
 			Texture* mTextureToBind = nullptr;
-#ifdef ENABLE_CORE_TEXTURE_UNIT_STACK_STATISTIC
-			Statistic mStat;
-#endif
 		};
 
 		std::array<TextureUnit, MAX_UNITS> mUnits;
 		unsigned int mMustBeBinded;
 
-#ifdef ENABLE_CORE_TEXTURE_UNIT_STACK_STATISTIC
-		Statistic mStat;
-#endif
-
 		unsigned int mCurrentActiveTextureUnit; // 0 for GL_TEXTURE0, 1 for GL_TEXTURE1, ...
 		unsigned int mUsedTexUnitsFlags;
 
@@ -3,40 +3,159 @@
 
 #include <gs/res/resource.h>
 #include <gs/rendering/gl_api.h>
+#include <gs/rendering/resolution_scale.h>
+#include <vector>
+#include <stdint.h>
 
 namespace gs
 {
 	class Texture;
+	class RenderTargetPool;
+
+	enum class FbDepth
+	{
+		NONE = 0, // no depth buffer (e.g. for post processing passes)
+		RENDERBUFFER, // depth buffer which can't be used as texture
+		TEXTURE, // depth buffer which can be used as texture
+	};
+
+	/**
+	 * Describe the attachments of a framebuffer.
+	 * Default is one RGBA8 color attachment and a depth renderbuffer.
+	 */
+	class FramebufferFormat
+	{
+	public:
+		enum EDefs
+		{
+			MAX_COLOR_ATTACHMENTS = 8,
+		};
+
+		// Internal format for each color attachment (e.g. GL_RGBA8, GL_RG16F).
+		// Can be empty for a depth only framebuffer.
+		std::vector<GLint> mColorFormats;
+		FbDepth mDepth;
+		// If true then the mipmaps of the color attachments are generated
+		// after each render pass.
+		bool mMipmap;
+
+		FramebufferFormat()
+				:mColorFormats(1, GL_RGBA8), mDepth(FbDepth::RENDERBUFFER),
+				mMipmap(false) {}
+	};
 
 	class Framebuffer: public Resource
 	{
 	public:
-		Framebuffer(int width, int height);
+		enum EDefs
+		{
+			// attachment index for getTexRes() to get the depth texture
+			DEPTH_ATTACHMENT = 255,
+		};
+		/**
+		 * A window size change is only applied if the window size is not
+		 * changed for this time. Prevent a reallocation for each frame
+		 * while the window is resized by dragging the window border.
+		 */
+		static const uint32_t RESIZE_SETTLE_MSEC = 150;
+
+		/**
+		 * @param width Width in pixel or -1 for the window width.
+		 * @param height Height in pixel or -1 for the window height.
+		 * @param resolutionScale The real size of the framebuffer is the
+		 *        width and height (or window size) multiplied with the scale.
+		 * @param pool Is used for the texture attachments. Can be null.
+		 * The GPU objects are created by load() --> the framebuffer can
+		 * be constructed without the GL context.
+		 */
+		Framebuffer(int width, int height,
+				const FramebufferFormat& format = FramebufferFormat(),
+				const ResolutionScale& resolutionScale = ResolutionScale(),
+				const std::shared_ptr<RenderTargetPool>& pool = nullptr);
 		virtual ~Framebuffer();
 
 		virtual ResType getType() const { return ResType::FRAMEBUFFER; }
-		virtual bool load() { return true; }
+		// create the framebuffer and the attachments (if not already done)
+		virtual bool load();
 		virtual void unload() {}
 
-		const std::shared_ptr<Texture>& getTexRes() const { return mTexRes; };
+		/**
+		 * @param attachment Index of the color attachment or DEPTH_ATTACHMENT.
+		 * @return Null if the attachment doesn't exist or is not a texture.
+		 */
+		std::shared_ptr<Texture> getTexRes(unsigned int attachment = 0) const;
 
-		void bind(int windowWidth, int windowHeight);
+		/**
+		 * @param tsMsec Current timestamp. Is used to delay the resizing
+		 *               of framebuffers which use the window size.
+		 */
+		void bind(int windowWidth, int windowHeight, uint32_t tsMsec);
+		/**
+		 * Should be called once per frame before bind(). Only has an effect
+		 * for a dynamic resolution scale. The new size is used at bind().
+		 */
+		void updateResolutionScale(float deltaTimeSec, uint32_t tsMsec) { mResolutionScale.update(deltaTimeSec, tsMsec); }
+		// generate the mipmaps of the color attachments if mipmap is used
+		void generateMipmaps();
+		/**
+		 * With a present buffer the rendering goes into other color textures
+		 * than the textures which are returned by getTexRes(). presentWork()
+		 * exchange both. Is used for progressive rendering to show the last
+		 * complete image while the next image is rendered over several frames.
+		 */
+		bool setPresentBufferEnabled(bool enabled);
+		bool isPresentBufferEnabled() const { return mUsePresentBuffer; }
+		// The rendered color textures are used by getTexRes() and the
+		// previous presented textures are used for the next rendering.
+		void presentWork();
+		// real size of the framebuffer (scaled size)
 		unsigned int getWidth() const { return mWidth; }
 		unsigned int getHeight() const { return mHeight; }
+		// size before scaling (window size or configured size)
+		unsigned int getBaseWidth() const { return mBaseWidth; }
+		unsigned int getBaseHeight() const { return mBaseHeight; }
+		const ResolutionScale& getResolutionScale() const { return mResolutionScale; }
+		bool isScaled() const { return mResolutionScale.isScaled(); }
+		const FramebufferFormat& getFormat() const { return mFormat; }
+		unsigned int getColorAttachmentCount() const { return static_cast<unsigned int>(mFormat.mColorFormats.size()); }
+		bool hasDepth() const { return mFormat.mDepth != FbDepth::NONE; }
+		// true if a window size change is waiting for RESIZE_SETTLE_MSEC
+		bool isResizePending() const { return mResizePending; }
 	private:
 		bool mUseWindowWidth;
 		bool mUseWindowHeight;
+		unsigned int mBaseWidth;
+		unsigned int mBaseHeight;
 		unsigned int mWidth;
 		unsigned int mHeight;
+		FramebufferFormat mFormat;
+		ResolutionScale mResolutionScale;
+
+		// false until bind() is called the first time
+		bool mIsBound;
+		bool mResizePending;
+		unsigned int mPendingWidth;
+		unsigned int mPendingHeight;
+		uint32_t mPendingSinceMsec;
+
+		std::shared_ptr<RenderTargetPool> mPool;
 
 		GLuint mFbo; // frame buffer object
-		std::shared_ptr<Texture> mTexRes; // texture for rendering
-		//GLuint mTex; // texture for rendering
-		GLuint mRbo; // render buffer object
+		// textures for rendering, one for each color attachment
+		std::vector<std::shared_ptr<Texture> > mColorTexRes;
+		// only used if the present buffer is enabled
+		bool mUsePresentBuffer;
+		std::vector<std::shared_ptr<Texture> > mPresentColorTexRes;
+		std::shared_ptr<Texture> mDepthTexRes; // only for FbDepth::TEXTURE
+		GLuint mRbo; // render buffer object, only for FbDepth::RENDERBUFFER
 
 		bool createFramebuffer();
 		bool recreateFramebuffer();
 		void deleteFramebuffer();
+		void attachColorTextures();
+		// replace tex by a texture with the current size
+		bool reallocTexture(std::shared_ptr<Texture>& tex, GLint internalFormat,
+				bool mipmap);
 	};
 }
 
@@ -45,6 +45,13 @@ namespace gs
 		bool addVertices(const VertexV3C4* vertices,
 				unsigned int vertexCount);
 
+		/**
+		 * Map the texture coordinates s<texIndex>, t<texIndex> of all vertices
+		 * from 0.0 - 1.0 to s0 - s1 and t0 - t1 (e.g. region of a texture atlas).
+		 * @return False if the vertices don't have these texture coordinates.
+		 */
+		bool remapTexCoords(unsigned int texIndex, float s0, float t0, float s1, float t1);
+
 		void setPrimitiveType(PrimitiveType primitiveType) { mPrimitiveType = primitiveType; }
 		PrimitiveType getPrimitiveType() const { return mPrimitiveType; }
 		const char* getPrimitiveTypeAsString() const;
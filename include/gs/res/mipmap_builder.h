@@ -0,0 +1,26 @@
+#ifndef GLSLSCENE_MIPMAP_BUILDER_H
+#define GLSLSCENE_MIPMAP_BUILDER_H
+
+namespace gs
+{
+	/**
+	 * Halve the size of an image with a 2x2 box filter. The size of dst
+	 * must be max(1, srcWidth / 2) x max(1, srcHeight / 2).
+	 * Big images are split into stripes which are downsampled by several
+	 * threads.
+	 */
+	void downsampleImage(const unsigned char* src, unsigned int srcWidth,
+			unsigned int srcHeight, unsigned char* dst,
+			unsigned int bytePerPixel);
+
+	/**
+	 * Calculate the mipmap levels 1 to n with downsampleImage() and upload
+	 * them with glTexImage2D() to the currently bound texture. Level 0 must
+	 * be uploaded by the caller. Is the fallback for contexts without
+	 * glGenerateMipmap(). Only for RGBA8 (4 byte per pixel).
+	 */
+	void uploadMipmapLevels(const unsigned char* level0, unsigned int width,
+			unsigned int height);
+}
+
+#endif //GLSLSCENE_MIPMAP_BUILDER_H
@@ -0,0 +1,98 @@
+#ifndef GLSLSCENE_PIXEL_BUFFER_POOL_H
+#define GLSLSCENE_PIXEL_BUFFER_POOL_H
+
+#include <gs/rendering/gl_api.h>
+#include <memory>
+#include <vector>
+#include <stddef.h>
+
+namespace gs
+{
+	class TextureDecodeJob;
+
+	/**
+	 * Pixel buffer object which is mapped by the GL thread and filled by
+	 * a decoder thread (see TextureDecoder::copyToBuffer()). The texture
+	 * is uploaded from the bound buffer --> the driver can do the transfer
+	 * to the gpu asynchronously and the GL thread doesn't copy the pixels.
+	 */
+	class PixelBuffer
+	{
+	public:
+		PixelBuffer() {}
+		PixelBuffer(const PixelBuffer&) = delete;
+		PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+		GLuint getPbo() const { return mPbo; }
+		// null if the buffer is not mapped
+		unsigned char* getMappedData() const { return mMappedData; }
+	private:
+		friend class PixelBufferPool;
+
+		GLuint mPbo = 0;
+		size_t mCapacity = 0;
+		unsigned char* mMappedData = nullptr;
+		// GLsync of the upload (void* because glad has no sync objects)
+		void* mFence = nullptr;
+		// the decoder thread writes into the mapped buffer until the job is copied
+		std::shared_ptr<TextureDecodeJob> mCopyJob;
+		bool mIsFree = false;
+	};
+
+	/**
+	 * Pixel buffer objects for the texture uploads. A buffer is only
+	 * reused after the fence of its upload is signaled (the driver doesn't
+	 * read from the buffer anymore). Needs GL 3.2 (or GL_ARB_sync and
+	 * GL_ARB_map_buffer_range). Must be used by the GL thread.
+	 */
+	class PixelBufferPool
+	{
+	public:
+		// size of all buffers (mapped, uploading and free)
+		static const size_t MAX_TOTAL_BYTES = 256 * 1024 * 1024;
+
+		PixelBufferPool(unsigned int maxFreeCount = 4);
+		~PixelBufferPool();
+
+		static bool isSupported();
+
+		/**
+		 * Return a mapped buffer with at least this size.
+		 * @return null if pixel buffer objects are not supported or
+		 *         MAX_TOTAL_BYTES are in use (then the client memory
+		 *         should be used for the upload).
+		 */
+		std::shared_ptr<PixelBuffer> acquire(size_t size);
+		/**
+		 * The decoder thread writes into the buffer until the job is
+		 * copied. If the buffer is dropped before then it is not reused
+		 * until the copy is done.
+		 */
+		void setCopyJob(PixelBuffer& buffer, const std::shared_ptr<TextureDecodeJob>& job);
+		/**
+		 * Unmap the buffer and bind it as GL_PIXEL_UNPACK_BUFFER. The
+		 * pixel pointers of glTex(Sub)Image2D() are offsets into the buffer.
+		 * @return False if the content is lost (then nothing is bound).
+		 */
+		bool bindForUpload(PixelBuffer& buffer);
+		// unbind and insert the fence of the upload
+		void release(const std::shared_ptr<PixelBuffer>& buffer);
+		// move the buffers with a signaled fence to the free buffers (once per frame)
+		void update();
+
+		unsigned int getBufferCount() const { return static_cast<unsigned int>(mBuffers.size()); }
+		unsigned int getFreeCount() const { return static_cast<unsigned int>(mFree.size()); }
+		size_t getTotalBytes() const { return mTotalBytes; }
+	private:
+		unsigned int mMaxFreeCount;
+		// all buffers (also the buffers which are used by a texture)
+		std::vector<std::shared_ptr<PixelBuffer> > mBuffers;
+		std::vector<std::shared_ptr<PixelBuffer> > mFree;
+		size_t mTotalBytes;
+
+		bool isFenceSignaled(PixelBuffer& buffer);
+		void deleteBuffer(const std::shared_ptr<PixelBuffer>& buffer);
+	};
+}
+
+#endif //GLSLSCENE_PIXEL_BUFFER_POOL_H
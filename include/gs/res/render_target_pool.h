@@ -0,0 +1,77 @@
+#ifndef GLSLSCENE_RENDER_TARGET_POOL_H
+#define GLSLSCENE_RENDER_TARGET_POOL_H
+
+#include <gs/rendering/gl_api.h>
+#include <gs/res/texture.h>
+#include <memory>
+#include <map>
+
+namespace gs
+{
+	/**
+	 * Pool for textures which are used as render targets (attachments of
+	 * framebuffers). The textures only exist at the GPU (no CPU buffer).
+	 * A released texture is kept and returned by a later acquire() call
+	 * with the same size, format, mipmap and filter setting. This avoids new
+	 * allocations if the window is resized back and forth. The pool of a
+	 * context is shared by the resource managers --> the textures which are
+	 * released by a replaced scene can be used after a reload.
+	 *
+	 * If more than maxUnusedCount textures are unused then the texture which
+	 * was released first is deleted.
+	 */
+	class RenderTargetPool
+	{
+	public:
+		RenderTargetPool(unsigned int maxUnusedCount = 8);
+		~RenderTargetPool();
+
+		// return null for error
+		std::shared_ptr<Texture> acquire(unsigned int width, unsigned int height,
+				GLint internalFormat = GL_RGBA8, TexMipmap mipmap = TexMipmap::NO_MIPMAP,
+				TexFilter filter = TexFilter::NEAREST);
+		void release(const std::shared_ptr<Texture>& tex);
+		// delete all unused textures
+		void clear();
+
+		unsigned int getUnusedCount() const { return static_cast<unsigned int>(mUnused.size()); }
+		unsigned int getCreatedCount() const { return mCreatedCount; }
+		unsigned int getReusedCount() const { return mReusedCount; }
+	private:
+		class Key
+		{
+		public:
+			unsigned int mWidth;
+			unsigned int mHeight;
+			GLint mInternalFormat;
+			TexMipmap mMipmap;
+			TexFilter mFilter;
+
+			Key(unsigned int width, unsigned int height, GLint internalFormat,
+					TexMipmap mipmap, TexFilter filter)
+					:mWidth(width), mHeight(height), mInternalFormat(internalFormat),
+					mMipmap(mipmap), mFilter(filter) {}
+			bool operator<(const Key& k) const;
+		};
+
+		class Entry
+		{
+		public:
+			std::shared_ptr<Texture> mTex;
+			unsigned int mReleaseNumber; // for deleting the oldest entry
+
+			Entry(const std::shared_ptr<Texture>& tex, unsigned int releaseNumber)
+					:mTex(tex), mReleaseNumber(releaseNumber) {}
+		};
+
+		typedef std::multimap<Key, Entry> TUnusedMap;
+
+		unsigned int mMaxUnusedCount;
+		TUnusedMap mUnused;
+		unsigned int mNextReleaseNumber;
+		unsigned int mCreatedCount;
+		unsigned int mReusedCount;
+	};
+}
+
+#endif //GLSLSCENE_RENDER_TARGET_POOL_H
@@ -14,6 +14,7 @@ namespace gs
 		SHADER_PROGRAM,
 		MESH,
 		FRAMEBUFFER,
+		TEXTURE_ATLAS,
 	};
 
 	class FileChangeMonitoring;
@@ -34,12 +35,30 @@ namespace gs
 		const std::string& getIdName() const { return mIdName; }
 
 	protected:
-		unsigned int addFileForHotReloading(const std::string& filename);
+		// checkContent: see FileChangeMonitoring::addFile()
+		unsigned int addFileForHotReloading(const std::string& filename, bool checkContent = false);
 		size_t getHotReloadingFileCount() const { return mHotReloadingFiles.size(); }
 		void removeAllFilesForHotReloading();
+		// is called if a file of the resource is changed. Default: load()
+		virtual void hotReloading(unsigned int callbackId, const std::string& filename);
+
+		/**
+		 * Latency of the hot reloading (see HotReloadStatistic). The
+		 * resource is attached to the file change of the current callback.
+		 * The mark functions have no effect if the resource is not
+		 * attached (e.g. the first loading).
+		 */
+		void attachToHotReload();
+		void markHotReloadLoaded();
+		// the new version is used by the next frame
+		void markHotReloadUploaded();
+		// the reload failed or is replaced by a newer reload
+		void releaseHotReload();
 	private:
 		TResourceId mIdNumber;
 		std::string mIdName;
+		// 0 if no hot reloading is in progress
+		unsigned int mHotReloadId;
 
 		struct HotReloadingFile
 		{
@@ -56,7 +75,6 @@ namespace gs
 		static void hotReloadingCb(unsigned int callbackId,
 				const std::string& filename,
 				const std::shared_ptr<void>& unused, void* thisResource);
-		void hotReloading(unsigned int callbackId, const std::string& filename);
 	};
 }
 
@@ -9,5 +9,6 @@ namespace gs
 	typedef TResourceId TTextureId;
 	typedef TResourceId TMeshId;
 	typedef TResourceId TFramebufferId;
+	typedef TResourceId TTextureAtlasId;
 }
 #endif
@@ -3,9 +3,12 @@
 
 #include <gs/res/resource_id.h>
 #include <gs/res/texture.h>
+#include <gs/res/texture_atlas.h>
 #include <string>
 #include <memory>
-#include <map>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
 
 namespace gs
 {
@@ -15,31 +18,221 @@ namespace gs
 	class ShaderProgram;
 	class ShaderProgramLoadInfo;
 	class FileChangeMonitoring;
+	class RenderTargetPool;
+	class TextureDecoder;
+	class PixelBufferPool;
+	class TextureCache;
+	class ShaderBinaryCache;
+	class ShaderIncludeCache;
+	class ShaderObjectCache;
 
 	class ResourceManager
 	{
 	public:
-		typedef std::map<std::string /* id name */, std::shared_ptr<Resource> > TResByIdNameMap;
-		typedef std::map<TResourceId /* id number */, std::shared_ptr<Resource> > TResByIdNumberMap;
+		typedef std::unordered_map<std::string /* id name */, std::shared_ptr<Resource> > TResByIdNameMap;
+		// index is the id number - FIRST_RESOURCE_ID. null for an unused id
+		// number (e.g. a resource of the previous resource manager which
+		// was not taken over).
+		typedef std::vector<std::shared_ptr<Resource> > TResVector;
 
+		static const TResourceId FIRST_RESOURCE_ID = 2;
+
+		/**
+		 * Max. count of bytes which are uploaded by updateLoading() for one
+		 * frame. At least one texture is uploaded per frame.
+		 */
+		static const size_t UPLOAD_BYTES_PER_FRAME = 64 * 1024 * 1024;
+		/**
+		 * Max. count of resources for which updateLoading() creates the GPU
+		 * objects in one frame (see setGpuObjectsDeferred()).
+		 */
+		static const unsigned int GPU_OBJECTS_PER_FRAME = 8;
+
+		/**
+		 * @param decoder Should be shared by all resource managers of a
+		 *        context --> the decoder threads are not created again for
+		 *        a reload of the scene. If null then the resource manager
+		 *        creates its own decoder.
+		 * @param renderTargetPool Same as for the decoder --> the render
+		 *        targets of a replaced scene can be reused after a reload.
+		 *        If null then the resource manager creates its own pool.
+		 * @param pixelBufferPool Same as for the decoder --> the pixel
+		 *        buffers for the texture uploads are reused after a reload.
+		 *        If null then the resource manager creates its own pool.
+		 */
 		ResourceManager(const std::weak_ptr<FileChangeMonitoring>& fcm,
-				bool useVaoVersionForMesh);
+				bool useVaoVersionForMesh,
+				const std::shared_ptr<TextureDecoder>& decoder = nullptr,
+				const std::shared_ptr<RenderTargetPool>& renderTargetPool = nullptr,
+				const std::shared_ptr<PixelBufferPool>& pixelBufferPool = nullptr);
+		~ResourceManager();
 
+		/**
+		 * The image file of the texture is decoded asynchronously.
+		 * Until the decoding is done a placeholder is used.
+		 * See updateLoading().
+		 * @param keepData See Texture::setKeepData().
+		 * @param compression See Texture::setCompression().
+		 * @param format See Texture::setFormat().
+		 */
 		TTextureId addTexture(const std::string& idName,
 				const std::string& filename, TexMipmap mipmap,
-				TexFilter minFilter, TexFilter magFilter);
+				TexFilter minFilter, TexFilter magFilter,
+				bool keepData = false,
+				TexCompression compression = TexCompression::NONE,
+				TexFormat format = TexFormat::AUTO);
+		/**
+		 * The images are packed by their sizes (the regions can be used
+		 * directly) and decoded asynchronously. Until the decoding is done
+		 * a placeholder is used. See updateLoading().
+		 * @param padding See TextureAtlas::TextureAtlas().
+		 */
+		TTextureAtlasId addTextureAtlas(const std::string& idName,
+				const std::vector<TextureAtlas::Image>& images,
+				TexMipmap mipmap, TexFilter minFilter, TexFilter magFilter,
+				unsigned int padding, unsigned int maxSize);
+		/**
+		 * Compile and link the shader program. With setShaderLoadingAsync()
+		 * the driver compiles and links in the background (see
+		 * ShaderProgram::startLoading()) and updateLoading() applies the
+		 * program.
+		 */
 		TShaderId addShaderProgram(const std::string& idName,
 				const ShaderProgramLoadInfo& shaderProgramLoadInfo);
+		/**
+		 * A resource is never removed from a resource manager --> an id
+		 * number is never used for another resource by the same resource
+		 * manager. Therefore the id numbers which are stored by the scenes
+		 * and render passes don't need a generation counter. A taken over
+		 * resource has the same id number in the next resource manager
+		 * (see takeOverResources()). Adding a resource to a used id number
+		 * fails.
+		 * @return The id number. 0 for error.
+		 */
 		TResourceId addResource(const std::string& idName,
 				const std::shared_ptr<Resource>& res);
+		// add the framebuffer and create its GPU objects (see setGpuObjectsDeferred())
+		TFramebufferId addFramebuffer(const std::string& idName,
+				const std::shared_ptr<Framebuffer>& fb);
 		std::string toString() const;
 
+		/**
+		 * Remember the resources which are created by one config entry
+		 * (e.g. a texture entry with filenames creates many textures).
+		 * Is used by takeOverResources() of the next resource manager.
+		 * @param configKey Hash of the config entry.
+		 * @param firstIndex Value of getAddedResourceCount() before the
+		 *        resources of the entry were added.
+		 */
+		void setConfigOfResources(uint64_t configKey, size_t firstIndex);
+		/**
+		 * Incremental reload of the scene: The resources of the previous
+		 * resource manager which were created by the same config entry are
+		 * added to this resource manager (GPU objects are not created
+		 * again). Textures which are still loading are finished by
+		 * updateLoading() of this or the previous resource manager.
+		 * The resources keep their id numbers (the same slots as in the
+		 * previous resource manager) --> the previous resource manager is
+		 * not changed. Should be called before the new resources are added
+		 * (a new resource can use the id number of a taken over resource).
+		 * @return False if nothing was taken over (new or changed entry).
+		 */
+		bool takeOverResources(const ResourceManager& prevRm, uint64_t configKey);
+		size_t getAddedResourceCount() const { return mIdsInAddOrder.size(); }
+
+		/**
+		 * Upload the textures and texture atlases which are decoded and
+		 * apply the shader programs which are compiled (hot reloading).
+		 * Must be called by the GL thread (e.g. once per frame).
+		 * @return Count of textures which are still loading.
+		 */
+		unsigned int updateLoading();
+		unsigned int getLoadingTextureCount() const { return static_cast<unsigned int>(mLoadingTextures.size()); }
+		// true if textures (or atlases) are not uploaded yet or shader programs are not linked yet
+		bool isLoading() const;
+		/**
+		 * If true then addShaderProgram() doesn't wait for the driver.
+		 * Compile or link errors are only detected after isLoading() is
+		 * false --> check hasFailedShaderProgram(). Is used for the staged
+		 * reload of the scene (the current scene is rendered meanwhile).
+		 */
+		void setShaderLoadingAsync(bool isAsync) { mIsShaderLoadingAsync = isAsync; }
+		/**
+		 * For the staged reload of the scene: The resources are added by a
+		 * thread without the GL context. The add functions only read the
+		 * files (shader sources, image headers) and start the decoding.
+		 * The GPU objects (placeholders, framebuffers, shader programs) are
+		 * created by updateLoading() with GPU_OBJECTS_PER_FRAME per frame.
+		 * The resource manager must not be used by the GL thread until the
+		 * adding is done and this is set to false again.
+		 */
+		void setGpuObjectsDeferred(bool isDeferred) { mIsGpuObjectsDeferred = isDeferred; }
+		/**
+		 * GL_MAX_TEXTURE_SIZE of the context. Limits the size of the
+		 * texture atlases (can't be queried by the loading thread of a
+		 * staged reload). 0 for no limit.
+		 */
+		void setMaxTextureSize(unsigned int maxTextureSize) { mMaxTextureSize = maxTextureSize; }
+		// true if a shader program has no linked program (e.g. compile error)
+		bool hasFailedShaderProgram() const;
+		const TextureDecoder& getTextureDecoder() const { return *mTextureDecoder; }
+		/**
+		 * Decoded images are stored in this directory and reused by the
+		 * next loading. Should be set before the textures are added.
+		 * An empty directory name disable the cache.
+		 */
+		bool setTextureCacheDirectory(const std::string& directory);
+		// can be null
+		const std::shared_ptr<TextureCache>& getTextureCache() const { return mTextureCache; }
+		/**
+		 * Binaries of the linked shader programs are reused if the sources
+		 * are not changed. The cache should be shared with the next resource
+		 * manager (reload of the scene). Must be set before the shader
+		 * programs are added. Can be null.
+		 */
+		void setShaderBinaryCache(const std::shared_ptr<ShaderBinaryCache>& cache) { mShaderBinaryCache = cache; }
+		const std::shared_ptr<ShaderBinaryCache>& getShaderBinaryCache() const { return mShaderBinaryCache; }
+		/**
+		 * The binaries are also stored in this directory and reused by the
+		 * next start. An empty directory name disable the disk cache
+		 * (the binaries are still cached in memory).
+		 * If setShaderCacheDirectoryDeferred() is used then the directory
+		 * is only recorded and applied by applyShaderCacheDirectory().
+		 */
+		bool setShaderCacheDirectory(const std::string& directory);
+		/**
+		 * For the staged reload of the scene: The shared binary cache is
+		 * still used by the current scene --> the directory of the scene
+		 * file is applied after the staged resource manager is used.
+		 */
+		void setShaderCacheDirectoryDeferred(bool isDeferred) { mIsShaderCacheDirectoryDeferred = isDeferred; }
+		// apply the directory which is recorded by setShaderCacheDirectory() (if any)
+		void applyShaderCacheDirectory();
+		/**
+		 * Content of the included files and compiled shader objects. Should
+		 * be shared with the next resource manager (reload of the scene)
+		 * --> unchanged includes are not read and unchanged shaders are not
+		 * compiled again. Must be set before the shader programs are added.
+		 * If not set then the resource manager uses its own caches. Must not be null.
+		 */
+		void setShaderIncludeCache(const std::shared_ptr<ShaderIncludeCache>& cache) { mShaderIncludeCache = cache; }
+		void setShaderObjectCache(const std::shared_ptr<ShaderObjectCache>& cache) { mShaderObjectCache = cache; }
+		// content of the files which are included by the shaders (#include)
+		const ShaderIncludeCache& getShaderIncludeCache() const { return *mShaderIncludeCache; }
+		// compiled shader objects which are shared by the shader programs
+		const ShaderObjectCache& getShaderObjectCache() const { return *mShaderObjectCache; }
+
 		TResourceId getResourceId(const std::string& idName) const;
 		std::shared_ptr<Resource> getResourceByIdName(const std::string& idName) const;
 		std::shared_ptr<Resource> getResourceByIdNumber(TResourceId idNumber) const;
 
-		std::shared_ptr<Texture> getTextureByIdName(const std::string& idName) const;
-		std::shared_ptr<Texture> getTextureByIdNumber(TResourceId idNumber) const;
+		// fbAttachment is only used if the resource is a framebuffer.
+		// See Framebuffer::getTexRes(). For a texture atlas the texture
+		// of the atlas is returned.
+		std::shared_ptr<Texture> getTextureByIdName(const std::string& idName,
+				unsigned int fbAttachment = 0) const;
+		std::shared_ptr<Texture> getTextureByIdNumber(TResourceId idNumber,
+				unsigned int fbAttachment = 0) const;
 
 		std::shared_ptr<ShaderProgram> getShaderProgramByIdName(const std::string& idName) const;
 		std::shared_ptr<ShaderProgram> getShaderProgramByIdNumber(TResourceId idNumber) const;
@@ -50,20 +243,85 @@ namespace gs
 		std::shared_ptr<Framebuffer> getFramebufferByIdName(const std::string& idName) const;
 		std::shared_ptr<Framebuffer> getFramebufferByIdNumber(TResourceId idNumber) const;
 
+		std::shared_ptr<TextureAtlas> getTextureAtlasByIdName(const std::string& idName) const;
+		std::shared_ptr<TextureAtlas> getTextureAtlasByIdNumber(TResourceId idNumber) const;
+
+		/**
+		 * Non-owning versions for the render path (no map lookup and no
+		 * reference counting). The pointer is valid as long as the
+		 * resource manager exist.
+		 * @return null if the id is invalid or has another type.
+		 */
+		Texture* getTexturePtrByIdNumber(TResourceId idNumber,
+				unsigned int fbAttachment = 0) const;
+		ShaderProgram* getShaderProgramPtrByIdNumber(TResourceId idNumber) const {
+			return getPtrByIdNumber(mShaderProgramPtrs, idNumber);
+		}
+		Mesh* getMeshPtrByIdNumber(TResourceId idNumber) const {
+			return getPtrByIdNumber(mMeshPtrs, idNumber);
+		}
+
 		bool useVaoVersionForMesh() const { return mUseVaoVersionForMesh; }
 
-		unsigned int getResourceCount() const { return mResByIdNumber.size(); }
+		// is shared by all framebuffers of this resource manager (and of the
+		// other resource managers which got the same pool)
+		const std::shared_ptr<RenderTargetPool>& getRenderTargetPool() const { return mRenderTargetPool; }
+
+		unsigned int getResourceCount() const { return static_cast<unsigned int>(mIdsInAddOrder.size()); }
 
 		const TResByIdNameMap& getResourceMapByIdName() const { return mResByIdName; }
-		const TResByIdNumberMap&  getResourceMapByIdNumber() const { return mResByIdNumber; }
+		// sorted by the id number. Can contain null (unused id numbers).
+		const TResVector& getResources() const { return mResources; }
 	private:
 		std::weak_ptr<FileChangeMonitoring> mFileMonitoring;
 		bool mUseVaoVersionForMesh;
+		std::shared_ptr<RenderTargetPool> mRenderTargetPool;
+		// before the decoder --> the decoder threads are stopped before the
+		// mapped buffers are deleted
+		std::shared_ptr<PixelBufferPool> mPixelBufferPool;
+		std::shared_ptr<TextureDecoder> mTextureDecoder;
+		std::shared_ptr<TextureCache> mTextureCache;
+		std::shared_ptr<ShaderBinaryCache> mShaderBinaryCache;
+		std::shared_ptr<ShaderIncludeCache> mShaderIncludeCache;
+		std::shared_ptr<ShaderObjectCache> mShaderObjectCache;
+		std::vector<std::shared_ptr<Texture> > mLoadingTextures;
+		std::vector<std::shared_ptr<ShaderProgram> > mShaderPrograms;
+		// all atlases (also the taken over atlases) --> for the hot reloading
+		std::vector<std::shared_ptr<TextureAtlas> > mTextureAtlases;
+		bool mIsShaderLoadingAsync;
+		bool mIsGpuObjectsDeferred;
+		unsigned int mMaxTextureSize;
+		// added resources without GPU objects (see setGpuObjectsDeferred())
+		std::vector<std::shared_ptr<Resource> > mPendingGpuResources;
+		bool mIsShaderCacheDirectoryDeferred;
+		bool mHasDeferredShaderCacheDirectory;
+		std::string mDeferredShaderCacheDirectory;
 
 		TResByIdNameMap mResByIdName;
-		TResByIdNumberMap mResByIdNumber;
+		TResVector mResources;
+		// same index as mResources. null if the resource has another type
+		std::vector<Texture*> mTexturePtrs;
+		std::vector<ShaderProgram*> mShaderProgramPtrs;
+		std::vector<Mesh*> mMeshPtrs;
 
+		// no id number below is unused
 		TResourceId mNextFreeResourceId;
+		std::vector<TResourceId> mIdsInAddOrder;
+		// config key --> id numbers of the created resources
+		std::unordered_map<uint64_t, std::vector<TResourceId> > mIdsByConfig;
+
+		// create the GPU objects of the pending resources (max. GPU_OBJECTS_PER_FRAME)
+		void createPendingGpuObjects();
+
+		bool setResource(TResourceId idNumber, const std::string& idName,
+				const std::shared_ptr<Resource>& res);
+
+		template<typename T>
+		static T* getPtrByIdNumber(const std::vector<T*>& ptrs, TResourceId idNumber) {
+			// an id number < FIRST_RESOURCE_ID results in a very large index
+			size_t index = size_t(idNumber - FIRST_RESOURCE_ID);
+			return (index < ptrs.size()) ? ptrs[index] : nullptr;
+		}
 	};
 }
 
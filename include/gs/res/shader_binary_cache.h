@@ -0,0 +1,89 @@
+#ifndef GLSLSCENE_SHADER_BINARY_CACHE_H
+#define GLSLSCENE_SHADER_BINARY_CACHE_H
+
+#include <gs/rendering/gl_api.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+
+namespace gs
+{
+	class ShaderLoadInfo;
+	class Attribute;
+
+	/**
+	 * Cache for linked shader programs (glGetProgramBinary()). The key is a
+	 * hash of the sources and types of all shader stages, the attribute
+	 * names and the GL vendor, renderer and version. A changed source or a
+	 * driver update gets a new key.
+	 *
+	 * The binaries are always kept in memory. The cache is owned by the
+	 * context and survive a reload of the scene --> unchanged programs are
+	 * not compiled again. If a directory is set then the binaries are also
+	 * stored on disk and reused by the next start. Old cache files are not
+	 * removed automatically.
+	 *
+	 * Must be used by the GL thread.
+	 */
+	class ShaderBinaryCache
+	{
+	public:
+		static const uint32_t FILE_VERSION = 1;
+
+		ShaderBinaryCache();
+		~ShaderBinaryCache();
+
+		/**
+		 * @param directory Is created if it doesn't exist. An empty name
+		 *        disable the disk cache (the memory cache is still used).
+		 */
+		bool setDirectory(const std::string& directory);
+		const std::string& getDirectory() const { return mDirectory; }
+
+		// GL 4.1 or GL_ARB_get_program_binary and at least one binary format
+		static bool isSupported();
+
+		/**
+		 * @param shaderSources Sources (not filenames) of all stages.
+		 */
+		static uint64_t calcKey(const std::vector<ShaderLoadInfo>& shaderSources,
+				const std::vector<Attribute>& attributes);
+
+		/**
+		 * Create a program from the cached binary.
+		 * @return 0 if no binary exist for the key or if the driver reject
+		 *         the binary. A rejected binary is removed from the cache.
+		 */
+		GLuint loadProgram(uint64_t key);
+		/**
+		 * Store the binary of the linked program. The program should be
+		 * linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT (see
+		 * prepareProgramForLinking()).
+		 */
+		bool storeProgram(uint64_t key, GLuint program);
+		// must be called before glLinkProgram()
+		static void prepareProgramForLinking(GLuint program);
+
+		unsigned int getHitCount() const { return mHitCount; }
+		unsigned int getMissCount() const { return mMissCount; }
+	private:
+		class Binary
+		{
+		public:
+			GLenum mFormat = 0;
+			std::vector<unsigned char> mData;
+		};
+
+		std::string mDirectory; // empty --> only the memory is used
+		std::map<uint64_t, Binary> mBinaries;
+		unsigned int mHitCount;
+		unsigned int mMissCount;
+
+		std::string getCacheFilename(uint64_t key) const;
+		bool readFile(uint64_t key, Binary& outBinary) const;
+		bool writeFile(uint64_t key, const Binary& binary) const;
+	};
+}
+
+#endif //GLSLSCENE_SHADER_BINARY_CACHE_H
@@ -0,0 +1,81 @@
+#ifndef GLSLSCENE_SHADER_INCLUDE_CACHE_H
+#define GLSLSCENE_SHADER_INCLUDE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+#include <set>
+
+namespace gs
+{
+	class FileChangeMonitoring;
+	class ShaderProgram;
+
+	/**
+	 * Preprocessor for #include "<filename>" inside shader sources. The
+	 * filename is relative to the directory of the including file. Each
+	 * file is only included once per shader (like #pragma once). Nested
+	 * includes are supported.
+	 *
+	 * The content of the included files is cached and shared by all
+	 * shader programs. Each included file is monitored (hot reloading).
+	 * A reverse dependency map (included file --> shader programs) is used
+	 * to reload exactly the programs which include a changed file.
+	 *
+	 * #line directives are added. The source string number of the line
+	 * directive is the index of the file (0 for the shader itself, 1 for
+	 * the first included file, ...) --> compile errors can be assigned to
+	 * the correct file and line.
+	 */
+	class ShaderIncludeCache
+	{
+	public:
+		ShaderIncludeCache(const std::weak_ptr<FileChangeMonitoring>& fcm);
+		~ShaderIncludeCache();
+
+		/**
+		 * @param filename Filename of the source. Is used for relative
+		 *        includes and error messages. Empty for an inline source
+		 *        (includes are relative to the working directory).
+		 * @param outIncludedFiles Files are added (also nested includes).
+		 * @return False if an included file can't be read or if the
+		 *         include syntax is wrong.
+		 */
+		bool preprocess(const std::string& source, const std::string& filename,
+				std::string& outSource, std::set<std::string>& outIncludedFiles);
+
+		/**
+		 * Set the included files of the program (replace the previous
+		 * files). If one of these files is changed then
+		 * ShaderProgram::requestReload() is called.
+		 */
+		void setDependencies(ShaderProgram* program, const std::set<std::string>& files);
+		void removeDependencies(ShaderProgram* program);
+
+		unsigned int getCachedFileCount() const { return static_cast<unsigned int>(mFiles.size()); }
+	private:
+		std::weak_ptr<FileChangeMonitoring> mFileMonitoring;
+		// content of the included files
+		std::map<std::string, std::string> mFiles;
+		// callback ids of the monitored files (are kept if the content is dropped)
+		std::map<std::string, unsigned int> mMonitoredFiles;
+		// included file --> programs (reverse dependencies)
+		std::map<std::string, std::set<ShaderProgram*> > mDependents;
+		// program --> included files
+		std::map<ShaderProgram*, std::set<std::string> > mDependencies;
+
+		// null if the file can't be read
+		const std::string* getFile(const std::string& filename);
+		bool preprocessFile(const std::string& source, const std::string& filename,
+				unsigned int fileIndex, std::vector<std::string>& includeStack,
+				std::vector<std::string>& fileOrder, std::string& outSource);
+
+		static void fileChangedCb(unsigned int callbackId,
+				const std::string& filename,
+				const std::shared_ptr<void>& unused, void* thisCache);
+		void fileChanged(const std::string& filename);
+	};
+}
+
+#endif //GLSLSCENE_SHADER_INCLUDE_CACHE_H
@@ -0,0 +1,69 @@
+#ifndef GLSLSCENE_SHADER_OBJECT_CACHE_H
+#define GLSLSCENE_SHADER_OBJECT_CACHE_H
+
+#include <gs/res/shader_info.h>
+#include <gs/rendering/gl_api.h>
+#include <string>
+#include <map>
+#include <stdint.h>
+
+namespace gs
+{
+	/**
+	 * Compiled shader objects which are shared by the shader programs.
+	 * The key is a hash of the shader type and the source. If many programs
+	 * use the same shader (e.g. the same vertex shader) then it is only
+	 * compiled once. A hot reloading of one shader only compiles the
+	 * changed shader. The unchanged shaders are only linked again.
+	 *
+	 * Each shader object has a use count (acquire() and release()). A shader
+	 * object which is not used anymore is deleted.
+	 *
+	 * Must be used by the GL thread.
+	 */
+	class ShaderObjectCache
+	{
+	public:
+		ShaderObjectCache();
+		~ShaderObjectCache();
+
+		static uint64_t calcKey(ShaderType shaderType, const std::string& source);
+
+		/**
+		 * Return the shader object for the source and increment the use
+		 * count. A new shader object is compiled with glCompileShader()
+		 * without waiting for the result (see isCompiled()).
+		 * @return 0 if the shader type is not supported.
+		 */
+		GLuint acquire(ShaderType shaderType, const std::string& source, uint64_t& outKey);
+		// decrement the use count and delete the shader object if it's not used anymore
+		void release(uint64_t key);
+
+		/**
+		 * Wait until the compiling is done (if it's not done yet). The
+		 * result is stored --> a compile error is only logged once.
+		 */
+		bool isCompiled(uint64_t key);
+
+		unsigned int getShaderCount() const { return static_cast<unsigned int>(mShaders.size()); }
+		unsigned int getCompileCount() const { return mCompileCount; }
+		// count of acquire() calls which didn't need compiling
+		unsigned int getReuseCount() const { return mReuseCount; }
+	private:
+		class Entry
+		{
+		public:
+			GLuint mShader = 0;
+			ShaderType mType = ShaderType::VERTEX_SHADER;
+			unsigned int mUseCount = 0;
+			// -1 unknown (compiling is not checked yet), 0 error, 1 compiled
+			int mCompileStatus = -1;
+		};
+
+		std::map<uint64_t, Entry> mShaders;
+		unsigned int mCompileCount;
+		unsigned int mReuseCount;
+	};
+}
+
+#endif //GLSLSCENE_SHADER_OBJECT_CACHE_H
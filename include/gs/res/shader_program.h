@@ -6,11 +6,15 @@
 #include <gs/rendering/gl_api.h>
 #include <glm/mat4x4.hpp>
 #include <vector>
+#include <stdint.h>
 
 namespace gs
 {
 	class Properties;
 	struct Matrices;
+	class ShaderBinaryCache;
+	class ShaderIncludeCache;
+	class ShaderObjectCache;
 
 	class ShaderProgram : public Resource
 	{
@@ -25,23 +29,97 @@ namespace gs
 
 		virtual void unload() override;
 
+		/**
+		 * Start compiling and linking without waiting for the driver
+		 * (GL_KHR_parallel_shader_compile). The current program is used
+		 * until finishLoading() apply the new program. Without the
+		 * extension load() is used (blocking).
+		 * Is used for hot reloading.
+		 */
+		bool startLoading();
+		/**
+		 * Apply the new program if the driver is done. If compiling or
+		 * linking failed then the old program is kept.
+		 * @return False if the driver is not done yet.
+		 */
+		bool finishLoading();
+		// true if startLoading() was called and finishLoading() is not done yet
+		bool isLoading() const { return mPendingProgramId != 0; }
+		// false if no program is applied yet (e.g. the first startLoading() failed)
+		bool isLinked() const { return mShaderProgramId != 0; }
+		/**
+		 * Read the source files without the GL context (e.g. by the loading
+		 * thread of a staged reload). The next load() or startLoading() uses
+		 * the read content instead of reading the files again. The includes
+		 * are resolved by load() (the include cache is shared).
+		 */
+		void readSourceFiles();
+
+		/**
+		 * If a cache is set then load() use the cached program binary if the
+		 * sources are not changed. Must be set before load(). Can be null.
+		 */
+		void setBinaryCache(const std::shared_ptr<ShaderBinaryCache>& cache) { mBinaryCache = cache; }
+		/**
+		 * If a cache is set then #include is supported by the shader
+		 * sources. Must be set before load(). Can be null.
+		 */
+		void setIncludeCache(const std::shared_ptr<ShaderIncludeCache>& cache) { mIncludeCache = cache; }
+		/**
+		 * Shader objects which are shared with other programs. Must be set
+		 * before load(). By default each program has its own cache.
+		 */
+		void setObjectCache(const std::shared_ptr<ShaderObjectCache>& cache) { mObjectCache = cache; }
+
+		/**
+		 * The program is reloaded with startLoading() by
+		 * ResourceManager::updateLoading(). Is used by the hot reloading
+		 * (no compiling inside of the callback of the file monitoring).
+		 */
+		void requestReload();
+		bool isReloadRequested() const { return mIsReloadRequested; }
+
+		/**
+		 * Resolve the name of the uniform once. The handle can be used for
+		 * the changeUniform...() functions without a name lookup. The
+		 * handle is still valid after a reload of the program.
+		 * If no uniform with this name exist then the handle is not valid
+		 * (changeUniform...() return false).
+		 */
+		UniformHandle getUniformHandle(const std::string& name) const;
+
 		bool changeUniformFloat(const std::string& name, float value);
 		bool changeUniformVec2(const std::string& name, const glm::vec2& v2);
 		bool changeUniformVec3(const std::string& name, const glm::vec3& v3);
 		bool changeUniformVec4(const std::string& name, const glm::vec4& v4);
 		bool changeUniformMat4(const std::string& name, const glm::mat4& m);
 
+		// the handle is resolved again if the program was reloaded (see getLoadCounter())
+		bool changeUniformFloat(UniformHandle& handle, float value);
+		bool changeUniformVec2(UniformHandle& handle, const glm::vec2& v2);
+		bool changeUniformVec3(UniformHandle& handle, const glm::vec3& v3);
+		bool changeUniformVec4(UniformHandle& handle, const glm::vec4& v4);
+		bool changeUniformMat4(UniformHandle& handle, const glm::mat4& m);
+
 		const ShaderProgramLoadInfo& getShaderProgramLoadInfo() const { return mShaderProgramLoadInfo; }
 		const std::vector<ShaderLoadInfo>& getShaderSources() const { return mShaderSources; }
 		//GLuint getGlShaderProgramId() const { return mShaderProgramId; }
-		void bind(const Properties& p, const Matrices& m);
+		/**
+		 * The per frame uniforms are only uploaded if p.mFrameNumber is
+		 * changed since the last bind (or is 0). The per pass uniforms are
+		 * only uploaded if passSerial is changed (or is 0). The per entity
+		 * uniforms (model matrices) are always uploaded.
+		 */
+		void bind(const Properties& p, const Matrices& m, unsigned int passSerial);
 		// Warning: Correct program must be already binded!!!!!
-		void bindMatricesOnly(const Matrices& m);
+		// Only the per entity uniforms are uploaded.
+		void bindMatricesOnly(const Properties& p, const Matrices& m);
 
 		const std::vector<ShaderLoadInfo>& getShaderLoadInfos() const { return mShaderProgramLoadInfo.mShaderInfos; }
 		std::vector<Uniform>& getUniforms() { return mShaderProgramLoadInfo.mUniforms; }
 		const std::vector<Uniform>& getUniforms() const { return mShaderProgramLoadInfo.mUniforms; }
 		const std::vector<Attribute>& getAttributes() const { return mShaderProgramLoadInfo.mAttributes; }
+		// is changed by each load (unique for all programs)
 		unsigned int getLoadCounter() const { return mLoadCounter; }
 	private:
 		enum EDefs
@@ -49,12 +127,66 @@ namespace gs
 			MAX_UNITS = 8,
 		};
 
+		// precompiled setter of one uniform (see buildUniformTables())
+		class UniformSetter
+		{
+		public:
+			typedef void (*TSetFunc)(const Uniform& u, const Properties& p, const Matrices& m);
+
+			unsigned int mIndex; // index of the uniform (mShaderProgramLoadInfo.mUniforms)
+			TSetFunc mSetFunc;
+		};
+
 		ShaderProgramLoadInfo mShaderProgramLoadInfo;
 		std::vector<ShaderLoadInfo> mShaderSources;
 		bool mAddedSourceFilesForHotReloading;
+		// content of readSourceFiles() (same index as the shader infos). Is
+		// only used once (a hot reloading reads the changed files).
+		std::vector<std::string> mReadSourceFiles;
 		unsigned int mLoadCounter = 0;
+		std::shared_ptr<ShaderBinaryCache> mBinaryCache;
+		std::shared_ptr<ShaderIncludeCache> mIncludeCache;
+		bool mIsReloadRequested = false;
+		std::shared_ptr<ShaderObjectCache> mObjectCache;
 
 		GLuint mShaderProgramId;
+		// keys of the shader objects of the program (see ShaderObjectCache)
+		std::vector<uint64_t> mShaderKeys;
+
+		// program of startLoading() which is compiled/linked by the driver
+		GLuint mPendingProgramId;
+		std::vector<uint64_t> mPendingShaderKeys;
+		std::vector<ShaderLoadInfo> mPendingSources;
+		uint64_t mPendingBinaryKey; // 0 --> not stored in the binary cache
+
+		// uniforms with a location split by how often the value can change
+		std::vector<UniformSetter> mFrameUniforms;
+		std::vector<UniformSetter> mPassUniforms;
+		std::vector<UniformSetter> mEntityUniforms;
+		unsigned int mUploadedFrameNumber = 0;
+		unsigned int mUploadedPassSerial = 0;
+
+		virtual void hotReloading(unsigned int callbackId, const std::string& filename) override;
+		bool readShaderSources(std::vector<ShaderLoadInfo>& outShaderSources);
+		// use the linked program instead of the current program
+		bool applyLinkedProgram(GLuint shaderProgramId,
+				const std::vector<ShaderLoadInfo>& shaderSources,
+				const std::vector<uint64_t>& shaderKeys);
+		void cancelLoading();
+		// acquire the shader objects and start linking (see mObjectCache)
+		GLuint startCompileAndLink(const std::vector<ShaderLoadInfo>& shaderSources,
+				bool isRetrievable, std::vector<uint64_t>& outShaderKeys);
+		// wait if the compiling/linking is not done yet
+		bool isCompiledAndLinked(GLuint shaderProgramId,
+				const std::vector<uint64_t>& shaderKeys);
+		void releaseShaders(std::vector<uint64_t>& shaderKeys);
+		void resolveUniformHandle(UniformHandle& handle) const;
+		// null if the handle is not valid or the uniform has another type
+		Uniform* getUniform(UniformHandle& handle, UniformType type, const char* typeName);
+		// is called for each new linked program
+		void buildUniformTables();
+		void applyUniformTable(const std::vector<UniformSetter>& table,
+				const Properties& p, const Matrices& m);
 	};
 }
 
@@ -21,6 +21,23 @@ namespace gs
 		LINEAR,
 	};
 
+	enum class TexCompression
+	{
+		NONE = 0,
+		BC1, // rgb, 4 bit per pixel (DXT1)
+		BC3, // rgba, 8 bit per pixel (DXT5)
+		BC7, // rgba, 8 bit per pixel, better quality than BC1 and BC3
+		AUTO, // BC7 if supported, otherwise BC1 or BC3 (dependent on alpha)
+	};
+
+	enum class TexFormat
+	{
+		// channel count of the image file (R8, RG8, RGB8 or RGBA8),
+		// 16 bit png --> 16 bit per channel, hdr --> 16 bit float per channel
+		AUTO = 0,
+		RGBA8, // always 4 channels with 8 bit (independent of the image file)
+	};
+
 	enum class TexWrap
 	{
 		DEFAULT = 0, // use the default behaviour of opengl, default of GL should be GL_REPEAT
@@ -31,6 +48,13 @@ namespace gs
 	};
 
 	class ColorU32;
+	class TextureDecoder;
+	class TextureDecodeJob;
+	class TextureCache;
+	class PixelBuffer;
+	class PixelBufferPool;
+	class DecodedImage;
+	class ImageLoadOptions;
 
 	class Texture: public Resource
 	{
@@ -48,10 +72,107 @@ namespace gs
 
 		virtual void unload() override;
 
+		/**
+		 * Asynchronous loading of the image file. The file is only checked
+		 * (header) and a 1x1 placeholder texture is created. The decoding is
+		 * done by the worker threads of the decoder. finishLoading() must be
+		 * called (by the GL thread) until it returns true to upload the
+		 * decoded image. A call of load() cancel the asynchronous loading.
+		 * @param cache Can be null.
+		 */
+		bool startLoading(TextureDecoder& decoder,
+				const std::shared_ptr<TextureCache>& cache = nullptr);
+		/**
+		 * First part of startLoading() which doesn't need the GL context
+		 * (e.g. for the loading thread of a staged reload): The file is
+		 * checked (header) and the decoding is started.
+		 */
+		bool startDecoding(TextureDecoder& decoder,
+				const std::shared_ptr<TextureCache>& cache = nullptr);
+		/**
+		 * Second part of startLoading() (by the GL thread): The placeholder
+		 * is created (if no texture exist yet) and the file is added for
+		 * hot reloading. A started decoding is not canceled.
+		 */
+		bool createPlaceholder();
+		/**
+		 * Upload the decoded image if the decoding is done.
+		 * If the decoding failed then the placeholder is kept.
+		 * If a pool is used then a worker thread of the decoder copies the
+		 * image into a mapped pixel buffer first (the next call upload
+		 * from the buffer). Without a pool (or if no buffer is available)
+		 * the image is uploaded from the client memory.
+		 * @param decoder Must be the decoder of startLoading() if the pool is used.
+		 * @return False if the decoding (or the copy) is not finished yet.
+		 */
+		bool finishLoading(TextureDecoder* decoder = nullptr, PixelBufferPool* pool = nullptr);
+		// true if startLoading() was called and finishLoading() is not done yet
+		bool isLoading() const { return mDecodeJob != nullptr; }
+		// true if isLoading() and the decoding is done (finishLoading() doesn't wait)
+		bool isDecoded() const;
+
 		void resetUpdateInfo() { mUpdateArea = RectInt(0, 0, 0, 0); }
 
+		/**
+		 * By default the pixels of an image file are freed after the upload
+		 * to the gpu --> getData() return null and update() has no effect.
+		 * Must be set before load() if the cpu side pixels are needed.
+		 * A texture without filename (see create()) always keep the data.
+		 */
+		void setKeepData(bool keepData) { mKeepData = keepData; }
+		bool getKeepData() const { return mKeepData; }
+		/**
+		 * Compression for the image file. Must be set before load().
+		 * Is ignored if the data is kept (see setKeepData()) or if the
+		 * compression is not supported by the context.
+		 */
+		void setCompression(TexCompression compression) { mCompression = compression; }
+		TexCompression getCompression() const { return mCompression; }
+		// compression which is really used for the current gl texture (never AUTO)
+		TexCompression getUsedCompression() const { return mUsedCompression; }
+		/**
+		 * Format of the gl texture for the image file. Must be set before
+		 * load(). AUTO is only used if the context supports it (GL 3.3 or
+		 * texture_rg and texture_swizzle) and if no compression is used and
+		 * the data is not kept. Otherwise RGBA8 is used.
+		 * Grayscale images are swizzled (R8 --> rrr1, RG8 --> rrrg).
+		 */
+		void setFormat(TexFormat format) { mFormat = format; }
+		TexFormat getFormat() const { return mFormat; }
+
 		void create(unsigned int width, unsigned int height, const ColorU32& color);
+		/**
+		 * Use the pixels of the image (no copy, the image doesn't own the
+		 * data anymore) and upload them to the gpu. Is used for generated
+		 * images (e.g. texture atlas). The gl texture id is reused.
+		 * The pixels are freed after the upload if the data is not kept.
+		 */
+		bool createFromImage(DecodedImage& image);
+		/**
+		 * Create the texture only at the GPU (glTexImage2D() without data).
+		 * No CPU buffer is allocated --> getData() return null. The content
+		 * of the texture is undefined. Is used for render targets (e.g. color
+		 * attachment of a framebuffer). If the gl texture already exist then
+		 * the gl texture id is reused.
+		 */
+		bool createRenderTarget(unsigned int width, unsigned int height,
+				GLint internalFormat = GL_RGBA8);
+		/**
+		 * Generate all mipmap levels from level 0 with glGenerateMipmap().
+		 * Is used for render targets with mipmap after rendering.
+		 */
+		void generateMipmap();
+		/**
+		 * Change the cpu side pixels. The changed area is collected
+		 * (see getUpdateArea()) and uploaded by uploadUpdateArea().
+		 */
 		void update(const RectInt& updateArea, const ColorU32& color);
+		/**
+		 * Upload only the changed area (see getUpdateArea()) to the existing
+		 * gl texture with glTexSubImage2D(). Must be called by the GL thread.
+		 * The update area is reset after the upload.
+		 */
+		bool uploadUpdateArea();
 		const std::string& getFilename() const { return mFilename; }
 		TexMipmap getMipmap() const;
 		TexFilter getMinFilter() const;
@@ -60,6 +181,8 @@ namespace gs
 		unsigned int getWidth() const;
 		unsigned int getHeight() const;
 		unsigned int getBytePerPixel() const;
+		GLint getInternalFormat() const { return mInternalFormat; }
+		// null if the cpu side pixels are not kept (see setKeepData())
 		const unsigned char* getData() const;
 		RectInt getData(unsigned char* dst, const RectInt& area) const;
 		const RectInt& getUpdateArea() const { return mUpdateArea; }
@@ -75,16 +198,57 @@ namespace gs
 
 		unsigned int mWidth;
 		unsigned int mHeight;
-		unsigned int mBytePerPixel; // should be 4 (4 for RGBA)
+		unsigned int mBytePerPixel; // 4 for RGBA8 (see mInternalFormat)
 		RectInt mUpdateArea;
 		/**
 		 * mData[0] start with the upper left pixel of the image
+		 * Is allocated with allocImageData() (same allocator as stb_image).
 		 */
 		unsigned char* mData; // has a size of mWidth * mHeight * mBytePerPixel
-
+		bool mKeepData;
+		TexCompression mCompression;
+		// if not NONE then mData contains the compressed blocks of all levels
+		TexCompression mUsedCompression;
+		unsigned int mLevelCount;
+		size_t mCompressedSize;
+		TexFormat mFormat;
+		std::shared_ptr<TextureCache> mCache;
+
+		GLint mInternalFormat;
 		GLuint mGlTexId;
+		// size and format of the storage of the gl texture (level 0).
+		// Is used to reuse the storage if the size is not changed.
+		unsigned int mGlTexWidth;
+		unsigned int mGlTexHeight;
+		GLint mGlTexInternalFormat;
+		unsigned int mGlTexLevelCount;
+
+		std::shared_ptr<TextureDecodeJob> mDecodeJob;
+		// filled by the decoder for the upload of mDecodeJob (can be null)
+		std::shared_ptr<PixelBuffer> mPixelBuffer;
 
 		bool loadFromFile();
+		ImageLoadOptions getLoadOptions() const;
+		// the image doesn't own the data anymore
+		void takeImage(DecodedImage& image);
+		/**
+		 * Upload mData to the gl texture (the gl texture is created if necessary).
+		 * If the size and format of the existing gl texture are the same then
+		 * the storage is reused (glTexSubImage2D() instead of glTexImage2D()).
+		 * @param pixelBuffer If not 0 then the pixels are read from this
+		 *        bound pixel buffer (same content as mData).
+		 */
+		bool uploadToGpu(GLuint pixelBuffer = 0);
+		// the loading is canceled (also the copy into the pixel buffer)
+		void cancelLoading();
+		// true if the gl texture has the size and format of mData
+		bool isGlTexStorageReusable() const;
+		// generate the mipmap levels for the currently bound texture from mData
+		void updateMipmapLevels();
+		// free mData after the upload if the data is not needed anymore
+		void releaseDataAfterUpload();
+		// set filter and wrapping for the currently bound texture
+		void applyTexParameters();
 	};
 }
 
@@ -0,0 +1,140 @@
+#ifndef GLSLSCENE_TEXTURE_ATLAS_H
+#define GLSLSCENE_TEXTURE_ATLAS_H
+
+#include <gs/res/resource.h>
+#include <gs/res/texture.h>
+#include <gs/common/rect.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace gs
+{
+	class TextureDecoder;
+	class TextureDecodeJob;
+	class TextureCache;
+
+	/**
+	 * Many small images packed into one texture. Entities which use
+	 * different images of the same atlas don't need a texture bind.
+	 * Each image is a named region of the atlas. The texture coordinates
+	 * of a mesh must be remapped to the region (see Region::mapTexCoords()).
+	 *
+	 * The packing only depends on the image sizes (read from the file
+	 * headers) --> the regions are known before the images are decoded.
+	 * At hot reloading the packing must not change because the remapped
+	 * texture coordinates of the meshes would be wrong --> a changed image
+	 * size fails the reload and the old atlas is kept.
+	 */
+	class TextureAtlas: public Resource
+	{
+	public:
+		class Image
+		{
+		public:
+			std::string mName;
+			std::string mFilename;
+
+			Image(const std::string& name, const std::string& filename)
+					:mName(name), mFilename(filename) {}
+		};
+
+		class Region
+		{
+		public:
+			std::string mName;
+			std::string mFilename;
+			// in pixels without padding. mTop is the first row at the
+			// texture (the images are flipped --> row 0 is the bottom)
+			RectInt mRect;
+			float mS0 = 0.0f;
+			float mT0 = 0.0f;
+			float mS1 = 0.0f;
+			float mT1 = 0.0f;
+
+			// s and t of the image (0.0 to 1.0) --> s and t of the atlas
+			void mapTexCoords(float& s, float& t) const {
+				s = mS0 + s * (mS1 - mS0);
+				t = mT0 + t * (mT1 - mT0);
+			}
+		};
+
+		/**
+		 * @param padding Count of pixels around each image. The border
+		 *        pixels of the image are repeated to prevent bleeding of
+		 *        the neighbours with linear filtering and mipmaps.
+		 * @param maxSize Maximum width and height of the atlas. Should not
+		 *        be larger than GL_MAX_TEXTURE_SIZE (see
+		 *        ResourceManager::setMaxTextureSize()).
+		 * @param cache Can be null.
+		 */
+		TextureAtlas(const std::weak_ptr<FileChangeMonitoring>& fcm,
+				const std::vector<Image>& images,
+				TexMipmap mipmap, TexFilter minFilter, TexFilter magFilter,
+				unsigned int padding, unsigned int maxSize,
+				const std::shared_ptr<TextureDecoder>& decoder,
+				const std::shared_ptr<TextureCache>& cache);
+		virtual ~TextureAtlas();
+
+		virtual ResType getType() const override { return ResType::TEXTURE_ATLAS; }
+		// load synchronously (wait for the decoder threads)
+		virtual bool load() override;
+		virtual void unload() override;
+
+		/**
+		 * Pack the images and start the decoding. Until finishLoading() is
+		 * done a placeholder is used (only at the first loading).
+		 * @return False if the images can't be packed or the image sizes
+		 *         are changed after the first packing.
+		 */
+		bool startLoading();
+		/**
+		 * First part of startLoading() which doesn't need the GL context
+		 * (e.g. for the loading thread of a staged reload): The images are
+		 * packed and the decoding is started --> the regions can be used.
+		 */
+		bool startDecoding();
+		// second part of startLoading() (placeholder and hot reloading) by the GL thread
+		bool createPlaceholder();
+		/**
+		 * Copy the decoded images into the atlas and upload it.
+		 * @return False if the decoding is not finished yet.
+		 */
+		bool finishLoading();
+		// true if startLoading() was called and finishLoading() is not done yet
+		bool isLoading() const { return !mDecodeJobs.empty(); }
+		// true if isLoading() and all images are decoded (finishLoading() doesn't wait)
+		bool isDecoded() const;
+
+		const std::shared_ptr<Texture>& getTexture() const { return mTexture; }
+		const std::vector<Region>& getRegions() const { return mRegions; }
+		// null if no region exist for this name
+		const Region* getRegion(const std::string& name) const;
+		unsigned int getPadding() const { return mPadding; }
+		// how often the images are packed (reloading without size changes doesn't repack)
+		unsigned int getPackCount() const { return mPackCount; }
+	private:
+		std::vector<Image> mImages;
+		unsigned int mPadding;
+		unsigned int mMaxSize;
+		std::shared_ptr<TextureDecoder> mDecoder;
+		std::shared_ptr<TextureCache> mCache;
+		std::shared_ptr<Texture> mTexture;
+
+		// same order as mImages
+		std::vector<Region> mRegions;
+		unsigned int mWidth;
+		unsigned int mHeight;
+		unsigned int mPackCount;
+		// same order as mImages. Empty if not loading.
+		std::vector<std::shared_ptr<TextureDecodeJob> > mDecodeJobs;
+
+		// image changes are uploaded asynchronously. See ResourceManager::updateLoading().
+		virtual void hotReloading(unsigned int callbackId, const std::string& filename) override;
+		// set mRegions, mWidth and mHeight for the image sizes
+		bool pack(const std::vector<Size2u>& sizes);
+		bool isPackingValid(const std::vector<Size2u>& sizes) const;
+	};
+}
+
+#endif //GLSLSCENE_TEXTURE_ATLAS_H
@@ -0,0 +1,68 @@
+#ifndef GLSLSCENE_TEXTURE_CACHE_H
+#define GLSLSCENE_TEXTURE_CACHE_H
+
+#include <string>
+#include <atomic>
+#include <stdint.h>
+
+namespace gs
+{
+	class DecodedImage;
+	class ImageLoadOptions;
+
+	/**
+	 * Cache directory for decoded images. Each cache file contains a small
+	 * header and the raw pixels or the compressed blocks (all levels) which
+	 * can be uploaded directly. The name of a cache file is the key. The key
+	 * is a hash of the content of the image file and the load options
+	 * (e.g. flipping, compression).
+	 * --> A changed image file gets a new key. Old cache files are not
+	 * removed automatically.
+	 *
+	 * All functions are thread safe and can be used by the decoder threads.
+	 */
+	class TextureCache
+	{
+	public:
+		static const uint32_t FILE_VERSION = 3;
+
+		/**
+		 * @param directory Is created if it doesn't exist.
+		 */
+		TextureCache(const std::string& directory);
+		~TextureCache();
+
+		const std::string& getDirectory() const { return mDirectory; }
+		bool isValid() const { return mIsValid; }
+
+		/**
+		 * Use the cache file if it exist. Otherwise load the image file
+		 * with loadImageFile() and write the cache file.
+		 */
+		bool load(const std::string& filename, const ImageLoadOptions& options,
+				DecodedImage& outImage);
+
+		/**
+		 * @param options Load options which change the decoded pixels.
+		 * @return False if the image file can't be read.
+		 */
+		static bool calcKey(const std::string& filename,
+				const std::string& options, uint64_t& outKey);
+		bool read(uint64_t key, DecodedImage& outImage) const;
+		bool write(uint64_t key, const DecodedImage& image) const;
+
+		unsigned int getHitCount() const { return mHitCount.load(); }
+		unsigned int getMissCount() const { return mMissCount.load(); }
+	private:
+		std::string mDirectory;
+		bool mIsValid;
+		std::atomic<unsigned int> mHitCount;
+		std::atomic<unsigned int> mMissCount;
+		// to create unique names for temporary files
+		mutable std::atomic<unsigned int> mTmpFileCounter;
+
+		std::string getCacheFilename(uint64_t key) const;
+	};
+}
+
+#endif //GLSLSCENE_TEXTURE_CACHE_H
@@ -0,0 +1,41 @@
+#ifndef GLSLSCENE_TEXTURE_COMPRESSION_H
+#define GLSLSCENE_TEXTURE_COMPRESSION_H
+
+#include <gs/res/texture.h>
+#include <stddef.h>
+
+namespace gs
+{
+	class DecodedImage;
+
+	const char* getCompressionStr(TexCompression compression);
+	// return false if the name is unknown
+	bool getCompressionFromStr(const std::string& name, TexCompression& outCompression);
+
+	/**
+	 * Return the compression which should be used for the current context.
+	 * A not supported compression (extension not available) is replaced by
+	 * NONE (with a warning). AUTO is replaced by BC7 if BPTC is supported.
+	 * If only S3TC is supported then AUTO is kept (--> BC1 or BC3 is
+	 * selected dependent on the alpha channel of the image).
+	 * Must be called by the GL thread.
+	 */
+	TexCompression getSupportedCompression(TexCompression compression);
+
+	// e.g. GL_COMPRESSED_RGB_S3TC_DXT1_EXT for BC1
+	GLenum getCompressedGlFormat(TexCompression compression);
+
+	// size in bytes of one compressed level (blocks of 4x4 pixels)
+	size_t getCompressedLevelSize(TexCompression compression,
+			unsigned int width, unsigned int height);
+
+	/**
+	 * Replace the RGBA pixels of the image by the compressed blocks.
+	 * If mipmap is true then all mipmap levels are created and compressed.
+	 * Is thread safe (is called by the decoder threads).
+	 * @param compression AUTO select BC1 or BC3 dependent on the alpha channel.
+	 */
+	bool compressImage(DecodedImage& image, TexCompression compression, bool mipmap);
+}
+
+#endif //GLSLSCENE_TEXTURE_COMPRESSION_H
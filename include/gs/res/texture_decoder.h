@@ -0,0 +1,204 @@
+#ifndef GLSLSCENE_TEXTURE_DECODER_H
+#define GLSLSCENE_TEXTURE_DECODER_H
+
+#include <gs/res/texture.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace gs
+{
+	class TextureCache;
+
+	/**
+	 * Allocate/free a pixel buffer with the same allocator as stb_image.
+	 * A buffer of a decoded image can be used without a copy.
+	 */
+	unsigned char* allocImageData(size_t size);
+	void freeImageData(unsigned char* data);
+
+	enum class ImageDataType
+	{
+		UINT8 = 0,
+		UINT16, // 16 bit png
+		FLOAT, // hdr images, 32 bit float
+	};
+
+	/**
+	 * Decoded pixels of an image file. One to four channels (see
+	 * ImageLoadOptions) or compressed blocks (see mCompression).
+	 */
+	class DecodedImage
+	{
+	public:
+		unsigned int mWidth = 0;
+		unsigned int mHeight = 0;
+		unsigned int mBytePerPixel = 0; // 0 for a compressed image
+		unsigned int mChannelCount = 0; // 1 to 4 (4 for a compressed image)
+		ImageDataType mDataType = ImageDataType::UINT8;
+		/**
+		 * mData[0] start with the upper left pixel of the image (or with
+		 * the lower left pixel if the image is flipped)
+		 * Is the buffer of stb_image --> must be freed with freeImageData().
+		 */
+		unsigned char* mData = nullptr;
+		// Never AUTO. If not NONE then mData contains the compressed blocks
+		// of all levels (mipmaps) one after the other.
+		TexCompression mCompression = TexCompression::NONE;
+		unsigned int mLevelCount = 1;
+		size_t mCompressedSize = 0; // size of all levels, only for compression
+
+		size_t getDataSize() const { return (mCompression == TexCompression::NONE) ? size_t(mWidth) * mHeight * mBytePerPixel : mCompressedSize; }
+
+		DecodedImage() {}
+		~DecodedImage() { freeImageData(mData); }
+		DecodedImage(const DecodedImage&) = delete;
+		DecodedImage& operator=(const DecodedImage&) = delete;
+
+		// return the data and the image doesn't own the data anymore
+		// (must be freed with freeImageData())
+		unsigned char* releaseData();
+	};
+
+	/**
+	 * Options which change the result of loadImageFile().
+	 */
+	class ImageLoadOptions
+	{
+	public:
+		bool mFlipVertically = true;
+		// AUTO --> BC1 or BC3 dependent on the alpha channel
+		TexCompression mCompression = TexCompression::NONE;
+		// Only used for compression. Compressed mipmaps are created at
+		// the cpu because glGenerateMipmap() can't be used for them.
+		bool mMipmap = false;
+		// If true then the channel count of the image file is used
+		// (e.g. one channel for a grayscale image). Otherwise always RGBA.
+		bool mChannelAware = false;
+		// If true then hdr images are decoded as float and 16 bit png
+		// images with 16 bit per channel. Otherwise 8 bit per channel.
+		bool mHighPrecision = false;
+
+		// e.g. used for the key of the texture cache
+		std::string toString() const;
+	};
+
+	/**
+	 * Decode an image file (png, jpg, hdr, ...) with stb_image.
+	 * Is thread safe. The global flip setting of stb_image is not used.
+	 * The flipping is done for each call separately.
+	 * The compression of the options is not used here (see loadImageFile()).
+	 */
+	bool decodeImageFile(const std::string& filename,
+			const ImageLoadOptions& options, DecodedImage& outImage);
+
+	/**
+	 * Decode the image file with decodeImageFile() and compress it if
+	 * compression is used. Is thread safe.
+	 */
+	bool loadImageFile(const std::string& filename,
+			const ImageLoadOptions& options, DecodedImage& outImage);
+
+	/**
+	 * Only read the header of the image file. Is much faster than decoding
+	 * and can be used to check if the file is a supported image.
+	 */
+	bool getImageFileInfo(const std::string& filename, unsigned int& width,
+			unsigned int& height, unsigned int& channelsInFile);
+
+	class TextureDecodeJob
+	{
+	public:
+		TextureDecodeJob(const std::string& filename,
+				const ImageLoadOptions& options,
+				const std::shared_ptr<TextureCache>& cache)
+				:mFilename(filename), mOptions(options),
+				mCache(cache), mImage(), mIsDone(false), mIsSuccess(false),
+				mCopyDst(nullptr), mIsCopied(false) {}
+
+		const std::string& getFilename() const { return mFilename; }
+		// If isDone() return true then the job is not used by a worker thread anymore.
+		bool isDone() const { return mIsDone.load(); }
+		bool isSuccess() const { return mIsSuccess; }
+		// should only be used if isDone() is true
+		DecodedImage& getImage() { return mImage; }
+		// true if the image is copied by TextureDecoder::copyToBuffer()
+		bool isCopied() const { return mIsCopied.load(); }
+	private:
+		friend class TextureDecoder;
+
+		std::string mFilename;
+		ImageLoadOptions mOptions;
+		std::shared_ptr<TextureCache> mCache; // can be null
+		DecodedImage mImage;
+		std::atomic<bool> mIsDone;
+		bool mIsSuccess;
+		// destination of copyToBuffer() (e.g. a mapped pixel buffer)
+		unsigned char* mCopyDst;
+		std::atomic<bool> mIsCopied;
+	};
+
+	/**
+	 * Worker threads for decoding (and compressing) image files.
+	 * The decoding can be done parallel. The upload to the GPU must be done by the GL thread
+	 * (see Texture::finishLoading()).
+	 *
+	 * If a job is not used anymore by the caller (shared pointer is released)
+	 * before the job is started then the job is skipped.
+	 */
+	class TextureDecoder
+	{
+	public:
+		/**
+		 * @param threadCount 0 for count of cpu cores minus one (main thread).
+		 *        At least one thread is used.
+		 */
+		TextureDecoder(unsigned int threadCount = 0);
+		~TextureDecoder();
+
+		/**
+		 * @param cache If not null then the cache is used instead of
+		 *        decoding the image file (if a cache file exist).
+		 */
+		std::shared_ptr<TextureDecodeJob> decode(const std::string& filename,
+				const ImageLoadOptions& options,
+				const std::shared_ptr<TextureCache>& cache = nullptr);
+
+		/**
+		 * Block until the job is done (no busy waiting). Should only be used
+		 * if the image is needed at once (e.g. for a texture atlas).
+		 * The job must be returned by decode() of this decoder.
+		 */
+		void wait(const TextureDecodeJob& job);
+		/**
+		 * Copy the decoded image of the job (getDataSize() bytes) by a
+		 * worker thread into dst (e.g. a mapped pixel buffer). The copy
+		 * is done before the next decoding is started.
+		 * The job must be done and successful. dst must be valid until
+		 * isCopied() of the job is true.
+		 */
+		void copyToBuffer(const std::shared_ptr<TextureDecodeJob>& job, unsigned char* dst);
+
+		unsigned int getThreadCount() const { return static_cast<unsigned int>(mThreads.size()); }
+		// count of jobs which are not started yet
+		unsigned int getQueuedCount() const;
+	private:
+		std::vector<std::thread> mThreads;
+		// the decoder only holds a weak pointer. A job which isn't needed
+		// anymore is not decoded.
+		std::deque<std::weak_ptr<TextureDecodeJob> > mJobs;
+		bool mRunning;
+		mutable std::mutex mSync;
+		std::condition_variable mJobAvailable;
+		std::condition_variable mJobDone;
+
+		void workerThread();
+	};
+}
+
+#endif //GLSLSCENE_TEXTURE_DECODER_H
@@ -115,6 +115,26 @@ namespace gs
 				mSource(UniformSource::CUSTOM_VALUE),
 				mLocation(-1) { mValue.mVec4 = { v.x, v.y, v.z, v.w }; }
 	};
+
+	/**
+	 * Index of a uniform of a shader program (see
+	 * ShaderProgram::getUniformHandle()). The load counter of the program
+	 * is stored to detect a reload of the program.
+	 */
+	class UniformHandle
+	{
+	public:
+		UniformHandle() :mName(), mIndex(-1), mLoadCounter(0) {}
+
+		bool isValid() const { return mIndex >= 0; }
+		const std::string& getName() const { return mName; }
+	private:
+		friend class ShaderProgram;
+
+		std::string mName;
+		int mIndex;
+		unsigned int mLoadCounter;
+	};
 }
 
 #endif //GLSLSCENE_UNIFORM_H
@@ -1,12 +1,15 @@
 #ifndef GLSLSCENE_FILE_CHANGE_MONITORING_H
 #define GLSLSCENE_FILE_CHANGE_MONITORING_H
 
+#include <gs/common/spsc_queue.h>
 #include <string>
 #include <memory>
 #include <map>
+#include <unordered_map>
 #include <set>
 #include <thread>
 #include <mutex>
+#include <stdint.h>
 #if defined(_MSC_VER)
 //#define _WIN32_WINNT 0x0550
 #include <windows.h>
@@ -15,9 +18,23 @@
 namespace gs
 {
 	/**
-	 * Supports linux and windows. On windows the callback function for changes is delayed by 300ms.
-	 * The delay is necessary to prevent multiple calls for one file modification.
+	 * Supports linux and windows. The callback function for changes is delayed
+	 * by a settle time (default 300ms on windows and 50ms on linux). Each new
+	 * event for the file restarts the settle time. The delay is necessary to
+	 * prevent multiple calls for one file modification (e.g. an editor writes
+	 * the file more than once or writes a temporary file and renames it).
 	 * See: https://stackoverflow.com/questions/14036449/c-winapi-readdirectorychangesw-receiving-double-notifications
+	 *
+	 * Optionally a hash of the file content is checked before the callback
+	 * is called. No callback if the file is saved with the same content.
+	 *
+	 * The callbacks are always called by checkChanges() (e.g. by the main
+	 * thread) and without holding the lock --> a callback can add and remove
+	 * files. A separate monitoring thread only reads the inotify events and
+	 * passes them with a lock-free queue to checkChanges().
+	 *
+	 * Only one inotify watch is used for all files of a directory. The
+	 * events are dispatched by a hash map lookup of the basename.
 	 */
 	class FileChangeMonitoring
 	{
@@ -35,6 +52,12 @@ namespace gs
 				const std::string& filename,
 				const std::shared_ptr<void>& param1, void* param2);
 
+#if defined(_MSC_VER)
+		static const uint32_t DEFAULT_SETTLE_MSEC = 300;
+#else
+		static const uint32_t DEFAULT_SETTLE_MSEC = 50;
+#endif
+
 		FileChangeMonitoring(bool useSeparateMonitoringThread);
 		~FileChangeMonitoring();
 		/**
@@ -47,10 +70,17 @@ namespace gs
 		 * renamed to the added filename then the callback function will
 		 * be called.
 		 *
+		 * @param settleMsec The callback is called if no other event for this
+		 *        file happened in this time.
+		 * @param checkContent If true then the callback is only called if
+		 *        the content of the file is changed (hash of the content).
+		 *        The file is read for each change --> only for small files
+		 *        (e.g. shader sources or scene files).
 		 * return Return the callback id. 0 for error or greater zero for success (= callback id).
 		 */
 		unsigned int addFile(const std::string& filename, TCallback callback,
-				const std::shared_ptr<void>& param1, void* param2);
+				const std::shared_ptr<void>& param1, void* param2,
+				uint32_t settleMsec = DEFAULT_SETTLE_MSEC, bool checkContent = false);
 		/**
 		 * @param callbackId To remove a file the callback id which was returned
 		 *                   by addFile() is necessary.
@@ -60,6 +90,7 @@ namespace gs
 		void removeAllFiles();
 		std::string toString() const;
 
+		// read the changes (if no separate thread is used) and call the callbacks
 		void checkChanges();
 //	private:
 		class Callback
@@ -76,6 +107,10 @@ namespace gs
 			// call addFile().
 			std::string mOrigFilename;
 			unsigned int mCallCount;
+			uint32_t mSettleMsec = DEFAULT_SETTLE_MSEC;
+			bool mCheckContent = false;
+			// hash of the content at the last call (or at addFile())
+			uint64_t mContentHash = 0;
 
 			Callback(unsigned int fileCallbackId,
 					TCallback callbackFunc, const std::shared_ptr<void>& param1,
@@ -109,7 +144,7 @@ namespace gs
 						Callback(fileCallbackId, callbackFunc, param1, param2, filename, origFilename)));
 			}
 		};
-		typedef std::map<std::string /* basename */, Filename> TFilenameMap;
+		typedef std::unordered_map<std::string /* basename */, Filename> TFilenameMap;
 
 		// FileEntry is used for a directory and stores all names from
 		// regular files which should be watched.
@@ -202,18 +237,40 @@ namespace gs
 		};
 
 #if defined(_MSC_VER)
-		typedef std::map<HANDLE /* watch id */, std::shared_ptr<FileEntry> > TFileMapByWatchId;
+		typedef std::unordered_map<HANDLE /* watch id */, std::shared_ptr<FileEntry> > TFileMapByWatchId;
 #else
-		typedef std::map<int /* watch id */, std::shared_ptr<FileEntry> > TFileMapByWatchId;
+		typedef std::unordered_map<int /* watch id */, std::shared_ptr<FileEntry> > TFileMapByWatchId;
 #endif
-		typedef std::map<std::string /* watchdir */, std::shared_ptr<FileEntry> > TFileMapByWatchDir;
-		typedef std::map<std::string /* filename */, FileEntryCountPair> TFileMapByName;
-		typedef std::map<unsigned int /* callback id */, FileEntryNamePair> TFileMapByCallbackId;
+		typedef std::unordered_map<std::string /* watchdir */, std::shared_ptr<FileEntry> > TFileMapByWatchDir;
+		typedef std::unordered_map<std::string /* filename */, FileEntryCountPair> TFileMapByName;
+		typedef std::unordered_map<unsigned int /* callback id */, FileEntryNamePair> TFileMapByCallbackId;
+
+		// change which waits for the settle time
+		class PendingChange
+		{
+		public:
+			uint32_t mFirstTs; // is used for the latency (see HotReloadStatistic)
+			uint32_t mLastTs;
+			PendingChange() :mFirstTs(0), mLastTs(0) {}
+			PendingChange(uint32_t ts) :mFirstTs(ts), mLastTs(ts) {}
+		};
+		typedef std::unordered_map<unsigned int /* callback id */, PendingChange> TChangeMapByCallbackId;
 
-		typedef std::map<unsigned int /* callback id */, uint32_t /* last change ts */> TChangeMapByCallbackId;
+		// is passed from the monitoring thread to checkChanges()
+		class ChangeEvent
+		{
+		public:
+			unsigned int mCallbackId;
+			uint32_t mTs; // SDL_GetTicks() of the event
+			ChangeEvent() :mCallbackId(0), mTs(0) {}
+			ChangeEvent(unsigned int callbackId, uint32_t ts) :mCallbackId(callbackId), mTs(ts) {}
+		};
+		static const size_t EVENT_QUEUE_SIZE = 4096;
 
 		void lock() const { mSync.lock(); }
 		unsigned int getCallCount() const { return mFileChangeMonitoringCallCount; }
+		// count of callback calls which are dropped because the content was not changed
+		unsigned int getUnchangedContentCount() const { return mUnchangedContentCount; }
 		const TFileMapByWatchId& getFilesByWatchId() const { return mFilesByWatchId; }
 		const TFileMapByWatchDir& getFilesByWatchDir() const { return mFilesByWatchDir; }
 		const TFileMapByName& getFilesByName() const { return mFilesByName; }
@@ -225,12 +282,14 @@ namespace gs
 		int mInotifyFd;
 		std::thread mMonitoringThread;
 
+		SpscQueue<ChangeEvent, EVENT_QUEUE_SIZE> mEvents;
 		TChangeMapByCallbackId mChangeMap;
 		// Files which are changed at some directories which are monitored.
 		// The changed file itself don't need to be a monitoring file.
 		unsigned int mFileChangeCount;
 		// Files which are changed and monitored!!!!
 		unsigned int mFileChangeMonitoringCallCount;
+		unsigned int mUnchangedContentCount;
 		TFileMapByWatchId mFilesByWatchId;
 		TFileMapByWatchDir mFilesByWatchDir;
 		TFileMapByName mFilesByName;
@@ -241,6 +300,13 @@ namespace gs
 		static void *posixMonitoringThread(void *thisFileChangeMonitoring);
 		void monitoringThread();
 		int monitoringFileChanges();
+		// is called by the producer of the event queue
+		void pushEvent(const ChangeEvent& e);
+		// move the events of the queue to the change map
+		void takeEvents();
+		// Call the callbacks which have no new event since the settle time.
+		// Return the count of the handled changes.
+		int callSettledCallbacks();
 
 #if defined(_MSC_VER)
 		static void CALLBACK FileChangedCallback(DWORD dwErrorCode, DWORD dwNumberOfBytesTransfered, LPOVERLAPPED lpOverlapped);
@@ -0,0 +1,103 @@
+#ifndef GLSLSCENE_HOT_RELOAD_STATISTIC_H
+#define GLSLSCENE_HOT_RELOAD_STATISTIC_H
+
+#include <string>
+#include <deque>
+#include <map>
+#include <stdint.h>
+
+namespace gs
+{
+	enum class HotReloadPhase
+	{
+		DETECT = 0, // file event --> callback (includes the settle time)
+		LOAD, // callback --> loaded or compiled
+		UPLOAD, // loaded --> uploaded to the GPU (or linked program is applied)
+		PRESENT, // uploaded --> end of the first frame with the new version
+		TOTAL, // file event --> end of the first frame with the new version
+	};
+
+	/**
+	 * Latency of the hot reloading from the file change (inotify event) to
+	 * the first frame which shows the new version. All timestamps are
+	 * SDL_GetTicks() values (ms).
+	 *
+	 * FileChangeMonitoring starts a record for each callback call. The
+	 * resources which are reloaded by the callback attach to the current
+	 * record and mark when they are loaded and uploaded. A record is
+	 * finished by endFrame() after all attached resources are uploaded.
+	 *
+	 * Must be used by the main thread (the thread which calls
+	 * FileChangeMonitoring::checkChanges()).
+	 */
+	class HotReloadStatistic
+	{
+	public:
+		class Record
+		{
+		public:
+			std::string mFilename;
+			uint32_t mEventTs = 0;
+			uint32_t mCallbackTs = 0;
+			uint32_t mLoadedTs = 0;
+			uint32_t mUploadedTs = 0;
+			uint32_t mPresentedTs = 0;
+			// count of attached resources which are not uploaded yet
+			unsigned int mPendingCount = 0;
+			bool mIsCallbackDone = false;
+
+			uint32_t getMsec(HotReloadPhase phase) const;
+		};
+
+		// count of finished records which are kept
+		static const size_t HISTORY_SIZE = 100;
+
+		HotReloadStatistic();
+		~HotReloadStatistic();
+
+		/**
+		 * Is called by FileChangeMonitoring before the callback is called.
+		 * The record is the current record until endCallback().
+		 * @param eventTs Timestamp of the first file event.
+		 * @return Id of the record (greater zero).
+		 */
+		unsigned int beginCallback(const std::string& filename, uint32_t eventTs);
+		void endCallback(unsigned int reloadId);
+		// 0 if no callback is called at the moment
+		unsigned int getCurrentReloadId() const { return mCurrentReloadId; }
+
+		/**
+		 * A resource which is reloaded by the current callback should
+		 * attach to the record. The record is not finished until the
+		 * resource calls markUploaded() or release().
+		 * @return The current reload id (0 if no callback is called).
+		 */
+		unsigned int attachCurrent();
+		// all functions ignore a reload id of 0 or of an unknown record
+		void markLoaded(unsigned int reloadId);
+		void markUploaded(unsigned int reloadId);
+		// the resource doesn't finish the reload (e.g. destroyed or reloaded again)
+		void release(unsigned int reloadId);
+
+		// is called after the frame is presented (buffer swap)
+		void endFrame();
+
+		// oldest record first
+		const std::deque<Record>& getHistory() const { return mHistory; }
+		unsigned int getActiveCount() const { return static_cast<unsigned int>(mActive.size()); }
+		// e.g. percent 50 for the median. 0 if the history is empty.
+		uint32_t getPercentile(HotReloadPhase phase, unsigned int percent) const;
+	private:
+		std::map<unsigned int /* reload id */, Record> mActive;
+		std::deque<Record> mHistory;
+		unsigned int mNextReloadId;
+		unsigned int mCurrentReloadId;
+
+		Record* getActive(unsigned int reloadId);
+	};
+
+	// always return a valid hot reload statistic (never null)
+	HotReloadStatistic& getHotReloadStatistic();
+}
+
+#endif //GLSLSCENE_HOT_RELOAD_STATISTIC_H
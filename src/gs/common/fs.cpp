@@ -13,11 +13,13 @@
 #include <unistd.h> // for getcwd
 #endif
 #include <string.h> // for strlen
+#include <errno.h>
 
 #if defined(_MSC_VER)
 #define strcasecmp _stricmp
 #define getcwd _getcwd
 #define chdir _chdir
+#define mkdir(dirname, mode) _mkdir(dirname)
 
 namespace std
 {
@@ -225,6 +227,14 @@ bool gs::fs::changeCwd(const std::string& dirname)
 	return chdir(dirname.c_str()) != -1;
 }
 
+bool gs::fs::createDirectory(const std::string& dirname)
+{
+	if (mkdir(dirname.c_str(), 0755) == 0) {
+		return true;
+	}
+	return errno == EEXIST;
+}
+
 std::string gs::fs::readFileAsString(const std::string& filename)
 {
 	std::ifstream f(filename);
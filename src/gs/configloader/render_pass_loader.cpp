@@ -267,6 +267,23 @@ namespace gs
 			return true;
 		}
 
+		bool getLoadAction(const std::string& str, LoadAction& loadAction)
+		{
+			if (str == "clear") {
+				loadAction = LoadAction::CLEAR;
+			}
+			else if (str == "keep") {
+				loadAction = LoadAction::KEEP;
+			}
+			else if (str == "dont-care") {
+				loadAction = LoadAction::DONT_CARE;
+			}
+			else {
+				return false;
+			}
+			return true;
+		}
+
 		bool addRenderPass(RenderPassManager &pm,
 				const SceneManager &sm, const ResourceManager &rm,
 				const cfg::NameValuePair &cfgValue)
@@ -281,6 +298,10 @@ namespace gs
 			const cfg::NameValuePair* projectionCfg = nullptr;
 			const cfg::NameValuePair* viewCfg = nullptr;
 			bool depthTest = false;
+			std::string colorLoad = "clear";
+			std::string depthLoad = "clear";
+			const cfg::Value* progressive = nullptr;
+			std::string progressivePreview = "complete";
 			cfg::SelectRule cfgRules[] = {
 					cfg::SelectRule("framebuffer-id", &fbIdName, cfg::SelectRule::RULE_MUST_EXIST),
 					cfg::SelectRule("clear-color", &clearColor, cfg::SelectRule::RULE_MUST_EXIST, cfg::SelectRule::ALLOW_ARRAY),
@@ -288,6 +309,10 @@ namespace gs
 					cfg::SelectRule("view-matrix", &viewCfg, cfg::SelectRule::RULE_OPTIONAL),
 					cfg::SelectRule("scene-id", &sceneIdName, cfg::SelectRule::RULE_MUST_EXIST),
 					cfg::SelectRule("depth-test", &depthTest, cfg::SelectRule::RULE_OPTIONAL),
+					cfg::SelectRule("color-load", &colorLoad, cfg::SelectRule::RULE_OPTIONAL),
+					cfg::SelectRule("depth-load", &depthLoad, cfg::SelectRule::RULE_OPTIONAL),
+					cfg::SelectRule("progressive", &progressive, cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_ARRAY),
+					cfg::SelectRule("progressive-preview", &progressivePreview, cfg::SelectRule::RULE_OPTIONAL),
 					cfg::SelectRule("")
 			};
 
@@ -349,6 +374,41 @@ namespace gs
 				}
 			}
 			pass.mDepthTest = depthTest;
+			if (!getLoadAction(colorLoad, pass.mColorLoad)) {
+				LOGE("color-load value '%s' is not allowed.\n", colorLoad.c_str());
+				return false;
+			}
+			if (!getLoadAction(depthLoad, pass.mDepthLoad)) {
+				LOGE("depth-load value '%s' is not allowed.\n", depthLoad.c_str());
+				return false;
+			}
+			if (progressive) {
+				// <tile-cols> <tile-rows> [<tiles-per-frame>]
+				const std::vector<cfg::Value>& v = progressive->mArray;
+				if (v.size() < 2 || v.size() > 3 || v[0].mInteger <= 0 ||
+						v[1].mInteger <= 0 || (v.size() == 3 && v[2].mInteger <= 0)) {
+					LOGE("%s: wrong value for progressive\n",
+							progressive->getFilenameAndPosition().c_str());
+					return false;
+				}
+				if (!fbId) {
+					LOGE("progressive is not possible for the default framebuffer\n");
+					return false;
+				}
+				pass.mTileCols = static_cast<unsigned int>(v[0].mInteger);
+				pass.mTileRows = static_cast<unsigned int>(v[1].mInteger);
+				pass.mTilesPerFrame = (v.size() == 3) ? static_cast<unsigned int>(v[2].mInteger) : 1;
+			}
+			if (progressivePreview == "complete") {
+				pass.mProgressivePreview = false;
+			}
+			else if (progressivePreview == "partial") {
+				pass.mProgressivePreview = true;
+			}
+			else {
+				LOGE("progressive-preview value '%s' is not allowed.\n", progressivePreview.c_str());
+				return false;
+			}
 			pm.addPass(pass);
 			return true;
 		}
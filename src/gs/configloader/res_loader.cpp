@@ -3,16 +3,79 @@
 #include <gs/configloader/uniform_attr_loader.h>
 #include <gs/common/str.h>
 #include <gs/common/ssize.h>
+#include <gs/common/hash.h>
 #include <gs/system/log.h>
 #include <gs/res/texture.h>
+#include <gs/res/texture_compression.h>
+#include <gs/res/texture_atlas.h>
 #include <gs/res/resource_manager.h>
 #include <gs/res/mesh.h>
 #include <gs/res/framebuffer.h>
 #include <gs/res/creation.h>
 #include <gs/res/shader_info.h>
 #include <cfg/cfg.h>
+#include <tml/tml_string.h>
 
-bool gs::resloader::addResources(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValue)
+namespace gs
+{
+	namespace
+	{
+		bool getColorFormat(const cfg::Value& cfgValue, GLint& internalFormat)
+		{
+			static const struct {
+				const char* mName;
+				GLint mFormat;
+			} formats[] = {
+					{"r8", GL_R8},
+					{"rg8", GL_RG8},
+					{"rgb8", GL_RGB8},
+					{"rgba8", GL_RGBA8},
+					{"r16f", GL_R16F},
+					{"rg16f", GL_RG16F},
+					{"rgb16f", GL_RGB16F},
+					{"rgba16f", GL_RGBA16F},
+					{"r32f", GL_R32F},
+					{"rg32f", GL_RG32F},
+					{"rgb32f", GL_RGB32F},
+					{"rgba32f", GL_RGBA32F},
+			};
+			if (!cfgValue.isText()) {
+				return false;
+			}
+			for (const auto& f : formats) {
+				if (cfgValue.mText == f.mName) {
+					internalFormat = f.mFormat;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// the position inside of the file is not used --> a moved entry is unchanged
+		uint64_t getConfigKey(const cfg::NameValuePair& cfgValuePair)
+		{
+			uint64_t key = hash::FNV_OFFSET_BASIS;
+			key = hash::hashString(key, cfgValuePair.mName.mText);
+			return hash::hashString(key, cfg::tmlstring::valueToString(0, cfgValuePair.mValue));
+		}
+
+		bool getTexFilter(const std::string& name, TexFilter& outFilter)
+		{
+			if (name == "linear") {
+				outFilter = TexFilter::LINEAR;
+				return true;
+			}
+			else if (name == "nearest") {
+				outFilter = TexFilter::NEAREST;
+				return true;
+			}
+			return false;
+		}
+	}
+}
+
+bool gs::resloader::addResources(gs::ResourceManager& rm, const cfg::NameValuePair& cfgValue,
+		const ResourceManager* prevRm)
 {
 	if (!cfgValue.mValue.isObject()) {
 		LOGE("%s: No object for resources.\n",
@@ -21,13 +84,82 @@ bool gs::resloader::addResources(gs::ResourceManager& rm, const cfg::NameValuePa
 	}
 	bool rv = true;
 	if (cfgValue.mName.mText == "resources") {
+		// the caches must be set before the first texture/shader is added
+		bool hasShaderCache = false;
 		for (const cfg::NameValuePair& vpRes : cfgValue.mValue.mObject) {
+			if (vpRes.mName.mText == "texture-cache") {
+				if (!setTextureCache(rm, vpRes)) {
+					LOGE("%s: Can't use texture cache.\n",
+							vpRes.mName.getFilenameAndPosition().c_str());
+					rv = false;
+				}
+			}
+			else if (vpRes.mName.mText == "shader-cache") {
+				hasShaderCache = true;
+				if (!setShaderCache(rm, vpRes)) {
+					LOGE("%s: Can't use shader cache.\n",
+							vpRes.mName.getFilenameAndPosition().c_str());
+					rv = false;
+				}
+			}
+		}
+		if (!hasShaderCache) {
+			// the shader binary cache survive a reload of the scene
+			// --> a removed shader-cache must disable the disk cache
+			// (applied after the reloaded scene is used, see
+			// ResourceManager::setShaderCacheDirectoryDeferred())
+			rm.setShaderCacheDirectory("");
+		}
+		const std::vector<cfg::NameValuePair>& entries = cfgValue.mValue.mObject;
+		std::vector<bool> isTakenOver(entries.size(), false);
+		unsigned int takenOverCount = 0;
+		unsigned int addedCount = 0;
+		if (prevRm) {
+			// first the unchanged resources --> they keep their id numbers
+			// and the new resources can't use these id numbers
+			bool isAtlasChanged = false;
+			for (size_t i = 0; i < entries.size(); ++i) {
+				const cfg::NameValuePair& vpRes = entries[i];
+				if (vpRes.mName.mText == "texture-cache" ||
+						vpRes.mName.mText == "shader-cache") {
+					continue;
+				}
+				// a mesh can use the regions of a texture atlas (texture-region)
+				if (isAtlasChanged && vpRes.mName.mText == "mesh") {
+					continue;
+				}
+				if (rm.takeOverResources(*prevRm, getConfigKey(vpRes))) {
+					isTakenOver[i] = true;
+					++takenOverCount;
+				}
+				else if (vpRes.mName.mText == "texture-atlas") {
+					isAtlasChanged = true;
+				}
+			}
+		}
+		for (size_t i = 0; i < entries.size(); ++i) {
+			const cfg::NameValuePair& vpRes = entries[i];
+			if (vpRes.mName.mText == "texture-cache" ||
+					vpRes.mName.mText == "shader-cache") {
+				continue; // already used
+			}
+			if (isTakenOver[i]) {
+				continue;
+			}
+			uint64_t configKey = getConfigKey(vpRes);
+			size_t firstIndex = rm.getAddedResourceCount();
 			if (!addResource(rm, vpRes)) {
 				LOGE("%s: Can't add resource '%s' to resource manager.\n",
 						vpRes.mName.getFilenameAndPosition().c_str(),
 						vpRes.mName.mText.c_str());
 				rv = false;
 			}
+			rm.setConfigOfResources(configKey, firstIndex);
+			++addedCount;
+		}
+		if (prevRm) {
+			LOGI("resources: %u unchanged (taken over), %u new or changed\n",
+					takenOverCount, addedCount);
 		}
 	}
 	return rv;
@@ -38,6 +170,9 @@ gs::TResourceId gs::resloader::addResource(ResourceManager& rm, const cfg::NameV
 	if (cfgValue.mName.mText == "texture") {
 		return addTexture(rm, cfgValue);
 	}
+	else if (cfgValue.mName.mText == "texture-atlas") {
+		return addTextureAtlas(rm, cfgValue);
+	}
 	else if (cfgValue.mName.mText == "shader") {
 		return addShaderProgram(rm, cfgValue);
 	}
@@ -50,6 +185,32 @@ gs::TResourceId gs::resloader::addResource(ResourceManager& rm, const cfg::NameV
 	return 0;
 }
 
+bool gs::resloader::setTextureCache(ResourceManager& rm, const cfg::NameValuePair& cfgValuePair)
+{
+	if (cfgValuePair.mName.mText != "texture-cache") {
+		return false;
+	}
+	if (!cfgValuePair.mValue.isText()) {
+		LOGE("%s: texture-cache must be a directory name\n",
+				cfgValuePair.mValue.getFilenameAndPosition().c_str());
+		return false;
+	}
+	return rm.setTextureCacheDirectory(cfgValuePair.mValue.mText);
+}
+
+bool gs::resloader::setShaderCache(ResourceManager& rm, const cfg::NameValuePair& cfgValuePair)
+{
+	if (cfgValuePair.mName.mText != "shader-cache") {
+		return false;
+	}
+	if (!cfgValuePair.mValue.isText()) {
+		LOGE("%s: shader-cache must be a directory name\n",
+				cfgValuePair.mValue.getFilenameAndPosition().c_str());
+		return false;
+	}
+	return rm.setShaderCacheDirectory(cfgValuePair.mValue.mText);
+}
+
 gs::TTextureId gs::resloader::addTexture(ResourceManager& rm, const cfg::NameValuePair& cfgValuePair)
 {
 	if (cfgValuePair.mName.mText != "texture") {
@@ -63,6 +224,12 @@ gs::TTextureId gs::resloader::addTexture(ResourceManager& rm, const cfg::NameVal
 	bool useMipmap = false;
 	std::string minFilter;
 	std::string magFilter;
+	bool keepData = false;
+	std::string compression = "none";
+	std::string format = "auto";
+	unsigned int keepDataCount = 0;
+	unsigned int compressionCount = 0;
+	unsigned int formatCount = 0;
 
 	cfg::SelectRule cfgRules[] = {
 			cfg::SelectRule("id", &idName, cfg::SelectRule::RULE_MUST_EXIST),
@@ -71,37 +238,44 @@ gs::TTextureId gs::resloader::addTexture(ResourceManager& rm, const cfg::NameVal
 			cfg::SelectRule("mipmap", &useMipmap, cfg::SelectRule::RULE_MUST_EXIST),
 			cfg::SelectRule("min-filter", &minFilter, cfg::SelectRule::RULE_MUST_EXIST),
 			cfg::SelectRule("mag-filter", &magFilter, cfg::SelectRule::RULE_MUST_EXIST),
+			cfg::SelectRule("keep-data", &keepData, cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_ALL, &keepDataCount),
+			cfg::SelectRule("compression", &compression, cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_TEXT, &compressionCount),
+			cfg::SelectRule("format", &format, cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_TEXT, &formatCount),
 			cfg::SelectRule("")
 	};
 
 	size_t nextPos = 0;
 	ssize_t storeCnt = cfgValuePair.mValue.objectGet(
 			cfgRules, false, false, false, false, false, 0, &nextPos);
-	if (storeCnt != 5) {
+	if (storeCnt != 5 + keepDataCount + compressionCount + formatCount) {
 		LOGE("texture config is wrong\n");
 		return 0;
 	}
 	TexMipmap texMipmap = useMipmap ? TexMipmap::MIPMAP : TexMipmap::NO_MIPMAP;
 	TexFilter texMinFilter = TexFilter::NEAREST;
 	TexFilter texMagFilter = TexFilter::NEAREST;
-	if (minFilter == "linear") {
-		texMinFilter = TexFilter::LINEAR;
+	if (!getTexFilter(minFilter, texMinFilter)) {
+		LOGE("min-filter value is not allowed\n");
+		return 0;
 	}
-	else if (minFilter == "nearest") {
-		texMinFilter = TexFilter::NEAREST;
+	if (!getTexFilter(magFilter, texMagFilter)) {
+		LOGE("mag-filter value is not allowed\n");
+		return 0;
 	}
-	else {
-		LOGE("min-filter value is not allowed\n");
+	TexCompression texCompression = TexCompression::NONE;
+	if (!getCompressionFromStr(compression, texCompression)) {
+		LOGE("compression value '%s' is not allowed\n", compression.c_str());
 		return 0;
 	}
-	if (magFilter == "linear") {
-		texMagFilter = TexFilter::LINEAR;
+	TexFormat texFormat = TexFormat::AUTO;
+	if (format == "auto") {
+		texFormat = TexFormat::AUTO;
 	}
-	else if (magFilter == "nearest") {
-		texMagFilter = TexFilter::NEAREST;
+	else if (format == "rgba8") {
+		texFormat = TexFormat::RGBA8;
 	}
 	else {
-		LOGE("mag-filter value is not allowed\n");
+		LOGE("format value '%s' is not allowed\n", format.c_str());
 		return 0;
 	}
 	if (resFilenameCount + resPairArrayCount != 1) {
@@ -109,7 +283,7 @@ gs::TTextureId gs::resloader::addTexture(ResourceManager& rm, const cfg::NameVal
 		return 0;
 	}
 	if (resFilenameCount) {
-		TTextureId texId = rm.addTexture(idName, resFilename, texMipmap, texMinFilter, texMagFilter);
+		TTextureId texId = rm.addTexture(idName, resFilename, texMipmap, texMinFilter, texMagFilter, keepData, texCompression, texFormat);
 		if (!texId) {
 			LOGE("Add texture failed\n");
 			return 0;
@@ -135,7 +309,7 @@ gs::TTextureId gs::resloader::addTexture(ResourceManager& rm, const cfg::NameVal
 		for (unsigned int i = 0; i < arr.size(); ++i) {
 			snprintf(idNameWithIndex, 64, "%s%0*u", idSubName.c_str(), removeCount, i);
 			//LOGI("Name: %s\n", idNameWithIndex);
-			if (!rm.addTexture(idNameWithIndex, arr[i].mName.mText, texMipmap, texMinFilter, texMagFilter)) {
+			if (!rm.addTexture(idNameWithIndex, arr[i].mName.mText, texMipmap, texMinFilter, texMagFilter, keepData, texCompression, texFormat)) {
 				LOGE("Add texture failed\n");
 				return 0;
 			}
@@ -148,6 +322,87 @@ gs::TTextureId gs::resloader::addTexture(ResourceManager& rm, const cfg::NameVal
 	return 1;
 }
 
+gs::TTextureAtlasId gs::resloader::addTextureAtlas(ResourceManager& rm, const cfg::NameValuePair& cfgValuePair)
+{
+	if (cfgValuePair.mName.mText != "texture-atlas") {
+		return 0;
+	}
+	std::string idName;
+	bool useMipmap = false;
+	std::string minFilter;
+	std::string magFilter;
+	const cfg::Value* paddingValue = nullptr;
+	const cfg::Value* maxSizeValue = nullptr;
+	const std::vector<cfg::NameValuePair>* imageArray = nullptr;
+	unsigned int paddingCount = 0;
+	unsigned int maxSizeCount = 0;
+
+	cfg::SelectRule cfgRules[] = {
+			cfg::SelectRule("id", &idName, cfg::SelectRule::RULE_MUST_EXIST),
+			cfg::SelectRule("mipmap", &useMipmap, cfg::SelectRule::RULE_MUST_EXIST),
+			cfg::SelectRule("min-filter", &minFilter, cfg::SelectRule::RULE_MUST_EXIST),
+			cfg::SelectRule("mag-filter", &magFilter, cfg::SelectRule::RULE_MUST_EXIST),
+			cfg::SelectRule("padding", &paddingValue, cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_INT, &paddingCount),
+			cfg::SelectRule("max-size", &maxSizeValue, cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_INT, &maxSizeCount),
+			cfg::SelectRule("images", &imageArray, cfg::SelectRule::RULE_MUST_EXIST, cfg::SelectRule::ALLOW_OBJECT),
+			cfg::SelectRule("")
+	};
+
+	size_t nextPos = 0;
+	ssize_t storeCnt = cfgValuePair.mValue.objectGet(
+			cfgRules, false, false, false, false, false, 0, &nextPos);
+	if (storeCnt != 5 + paddingCount + maxSizeCount) {
+		LOGE("texture-atlas config is wrong\n");
+		return 0;
+	}
+	TexMipmap texMipmap = useMipmap ? TexMipmap::MIPMAP : TexMipmap::NO_MIPMAP;
+	TexFilter texMinFilter = TexFilter::NEAREST;
+	TexFilter texMagFilter = TexFilter::NEAREST;
+	if (!getTexFilter(minFilter, texMinFilter)) {
+		LOGE("min-filter value is not allowed\n");
+		return 0;
+	}
+	if (!getTexFilter(magFilter, texMagFilter)) {
+		LOGE("mag-filter value is not allowed\n");
+		return 0;
+	}
+	int padding = paddingValue ? paddingValue->mInteger : 2;
+	int maxSize = maxSizeValue ? maxSizeValue->mInteger : 4096;
+	if (padding < 0 || padding > 64 || maxSize <= 0) {
+		LOGE("padding or max-size of texture-atlas is not allowed\n");
+		return 0;
+	}
+	if (!imageArray || imageArray->empty()) {
+		LOGE("texture-atlas has no images\n");
+		return 0;
+	}
+	std::vector<TextureAtlas::Image> images;
+	for (const cfg::NameValuePair& vp : *imageArray) {
+		if (!vp.mValue.isText()) {
+			LOGE("%s: image '%s' must be <region-name> = <filename>\n",
+					vp.mName.getFilenameAndPosition().c_str(),
+					vp.mName.mText.c_str());
+			return 0;
+		}
+		for (const TextureAtlas::Image& image : images) {
+			if (image.mName == vp.mName.mText) {
+				LOGE("%s: region name '%s' is used twice\n",
+						vp.mName.getFilenameAndPosition().c_str(),
+						vp.mName.mText.c_str());
+				return 0;
+			}
+		}
+		images.emplace_back(vp.mName.mText, vp.mValue.mText);
+	}
+	TTextureAtlasId atlasId = rm.addTextureAtlas(idName, images, texMipmap,
+			texMinFilter, texMagFilter, padding, maxSize);
+	if (!atlasId) {
+		LOGE("Add texture atlas failed\n");
+		return 0;
+	}
+	return atlasId;
+}
+
 gs::TShaderId gs::resloader::addShaderProgram(ResourceManager& rm, const cfg::NameValuePair& cfgValuePair)
 {
 	if (cfgValuePair.mName.mText != "shader") {
@@ -244,12 +499,36 @@ gs::TMeshId gs::resloader::addMesh(ResourceManager& rm, const cfg::NameValuePair
 		scaleForShowNormals = cfgValue.mObject[startIndex].mValue.mFloatingPoint;
 		++startIndex;
 	}
-	if ((startIndex == 1 || startIndex == 2) && cfgValue.mObject.size() == startIndex) {
+	// texture-region = <atlas-id-name> <region-name> [<tex-coord-index>]
+	// texture coordinates are remapped to the region of the atlas
+	std::vector<std::pair<unsigned int, TextureAtlas::Region> > texRegions;
+	while (cfgValue.mObject.size() > startIndex &&
+			cfgValue.mObject[startIndex].mName.mText == "texture-region") {
+		const cfg::Value& regionValue = cfgValue.mObject[startIndex].mValue;
+		const std::vector<cfg::Value>& arr = regionValue.mArray;
+		if ((arr.size() != 2 && arr.size() != 3) || !arr[0].isText() || !arr[1].isText()) {
+			LOGE("%s: texture-region must be <atlas-id-name> <region-name> [<tex-coord-index>]\n",
+					regionValue.getFilenameAndPosition().c_str());
+			return 0;
+		}
+		std::shared_ptr<TextureAtlas> atlas = rm.getTextureAtlasByIdName(arr[0].mText);
+		const TextureAtlas::Region* region = atlas ? atlas->getRegion(arr[1].mText) : nullptr;
+		if (!region) {
+			LOGE("%s: Can't find region '%s' of texture atlas '%s'\n",
+					regionValue.getFilenameAndPosition().c_str(),
+					arr[1].mText.c_str(), arr[0].mText.c_str());
+			return 0;
+		}
+		unsigned int texIndex = (arr.size() == 3) ? arr[2].mInteger : 0;
+		texRegions.emplace_back(texIndex, *region);
+		++startIndex;
+	}
+	if (startIndex >= 1 && cfgValue.mObject.size() == startIndex) {
 		std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(rm.useVaoVersionForMesh(), scaleForShowNormals);
 		LOGW("Create a empty mesh!\n");
 		return rm.addResource(idName, mesh);
 	}
-	if ((startIndex == 1 || startIndex == 2) && cfgValue.mObject.size() < startIndex + 2) {
+	if (startIndex >= 1 && cfgValue.mObject.size() < startIndex + 2) {
 		LOGE("Wrong size. Must be at least %u if id is used.\n", startIndex + 2);
 		return 0;
 	}
@@ -636,6 +915,14 @@ gs::TMeshId gs::resloader::addMesh(ResourceManager& rm, const cfg::NameValuePair
 	if (!mesh->getVertexCount()) {
 		LOGW("Create a empty mesh!\n");
 	}
+	for (const auto& texRegion : texRegions) {
+		const TextureAtlas::Region& r = texRegion.second;
+		if (!mesh->remapTexCoords(texRegion.first, r.mS0, r.mT0, r.mS1, r.mT1)) {
+			LOGE("Mesh has no texture coordinates s%u, t%u for region '%s'\n",
+					texRegion.first, texRegion.first, r.mName.c_str());
+			return 0;
+		}
+	}
 	return rm.addResource(idName, mesh);
 }
 
@@ -646,10 +933,20 @@ gs::TFramebufferId gs::resloader::addFramebuffer(ResourceManager& rm, const cfg:
 	}
 	std::string idName;
 	const cfg::Value* sizeValue = nullptr;
+	const cfg::Value* colorValue = nullptr;
+	std::string depth = "renderbuffer";
+	bool mipmap = false;
+	const cfg::Value* scaleValue = nullptr;
 	cfg::SelectRule cfgRules[] = {
 			cfg::SelectRule("id", &idName, cfg::SelectRule::RULE_MUST_EXIST),
 			cfg::SelectRule("size", &sizeValue, cfg::SelectRule::RULE_MUST_EXIST,
 					cfg::SelectRule::ALLOW_ARRAY | cfg::SelectRule::ALLOW_TEXT),
+			cfg::SelectRule("color", &colorValue, cfg::SelectRule::RULE_OPTIONAL,
+					cfg::SelectRule::ALLOW_ARRAY | cfg::SelectRule::ALLOW_TEXT),
+			cfg::SelectRule("depth", &depth, cfg::SelectRule::RULE_OPTIONAL),
+			cfg::SelectRule("mipmap", &mipmap, cfg::SelectRule::RULE_OPTIONAL),
+			cfg::SelectRule("resolution-scale", &scaleValue, cfg::SelectRule::RULE_OPTIONAL,
+					cfg::SelectRule::ALLOW_ARRAY | cfg::SelectRule::ALLOW_FLOAT | cfg::SelectRule::ALLOW_INT),
 			cfg::SelectRule("")
 	};
 
@@ -685,7 +982,91 @@ gs::TFramebufferId gs::resloader::addFramebuffer(ResourceManager& rm, const cfg:
 				sizeValue->getFilenameAndPosition().c_str());
 		return 0;
 	}
-	std::shared_ptr<Framebuffer> fb = std::make_shared<Framebuffer>(width, height);
-	return rm.addResource(idName, fb);
+
+	FramebufferFormat format;
+	if (colorValue) {
+		format.mColorFormats.clear();
+		if (colorValue->isText()) {
+			if (colorValue->mText != "none") {
+				format.mColorFormats.push_back(GL_RGBA8);
+				if (!getColorFormat(*colorValue, format.mColorFormats.back())) {
+					LOGE("%s: Wrong color format '%s'\n",
+							colorValue->getFilenameAndPosition().c_str(),
+							colorValue->mText.c_str());
+					return 0;
+				}
+			}
+		}
+		else {
+			for (const cfg::Value& v : colorValue->mArray) {
+				format.mColorFormats.push_back(GL_RGBA8);
+				if (!getColorFormat(v, format.mColorFormats.back())) {
+					LOGE("%s: Wrong color format '%s'\n",
+							v.getFilenameAndPosition().c_str(), v.mText.c_str());
+					return 0;
+				}
+			}
+		}
+		if (format.mColorFormats.size() > FramebufferFormat::MAX_COLOR_ATTACHMENTS) {
+			LOGE("%s: Only %d color attachments are supported\n",
+					colorValue->getFilenameAndPosition().c_str(),
+					FramebufferFormat::MAX_COLOR_ATTACHMENTS);
+			return 0;
+		}
+	}
+	if (depth == "none") {
+		format.mDepth = FbDepth::NONE;
+	}
+	else if (depth == "renderbuffer") {
+		format.mDepth = FbDepth::RENDERBUFFER;
+	}
+	else if (depth == "texture") {
+		format.mDepth = FbDepth::TEXTURE;
+	}
+	else {
+		LOGE("depth value '%s' is not allowed\n", depth.c_str());
+		return 0;
+	}
+	if (format.mColorFormats.empty() && format.mDepth == FbDepth::NONE) {
+		LOGE("A framebuffer needs at least one color attachment or a depth attachment\n");
+		return 0;
+	}
+	format.mMipmap = mipmap;
+
+	ResolutionScale resolutionScale;
+	if (scaleValue) {
+		if (scaleValue->isNumber()) {
+			float scale = scaleValue->mFloatingPoint;
+			if (scale <= 0.0f || scale > 4.0f) {
+				LOGE("%s: resolution-scale must be greater 0.0 and not greater 4.0\n",
+						scaleValue->getFilenameAndPosition().c_str());
+				return 0;
+			}
+			resolutionScale.setFixed(scale);
+		}
+		else {
+			// dynamic <target-frame-time-msec> [<min-scale> [<max-scale>]]
+			const std::vector<cfg::Value>& arr = scaleValue->mArray;
+			if (arr.size() < 2 || arr.size() > 4 || arr[0].mText != "dynamic" ||
+					!arr[1].isNumber() ||
+					(arr.size() >= 3 && !arr[2].isNumber()) ||
+					(arr.size() >= 4 && !arr[3].isNumber())) {
+				LOGE("%s: Wrong value for resolution-scale\n",
+						scaleValue->getFilenameAndPosition().c_str());
+				return 0;
+			}
+			float minScale = (arr.size() >= 3) ? float(arr[2].mFloatingPoint) : 0.5f;
+			float maxScale = (arr.size() >= 4) ? float(arr[3].mFloatingPoint) : 1.0f;
+			if (arr[1].mFloatingPoint <= 0.0 || minScale <= 0.0f || minScale > maxScale) {
+				LOGE("%s: Wrong values for dynamic resolution-scale\n",
+						scaleValue->getFilenameAndPosition().c_str());
+				return 0;
+			}
+			resolutionScale.setDynamic(float(arr[1].mFloatingPoint), minScale, maxScale);
+		}
+	}
+	std::shared_ptr<Framebuffer> fb = std::make_shared<Framebuffer>(width, height,
+			format, resolutionScale, rm.getRenderTargetPool());
+	return rm.addFramebuffer(idName, fb);
 }
 
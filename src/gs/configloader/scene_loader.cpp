@@ -17,6 +17,9 @@
 #include <gs/configloader/res_loader.h>
 #include <gs/configloader/render_pass_loader.h>
 #include <gs/res/resource_manager.h>
+#include <gs/res/framebuffer.h>
+#include <gs/res/mesh.h>
+#include <gs/res/texture_atlas.h>
 #include <gs/rendering/render_pass_manager.h>
 #include <gs/scene/scene_manager.h>
 #include <gs/common/ssize.h>
@@ -81,31 +84,69 @@ namespace gs
 			return true;
 		}
 
+		// color-0 ... color-7 or depth
+		bool getFramebufferAttachment(const cfg::Value& cfgValue, unsigned int& attachment)
+		{
+			if (!cfgValue.isText()) {
+				return false;
+			}
+			const std::string& name = cfgValue.mText;
+			if (name == "depth") {
+				attachment = Framebuffer::DEPTH_ATTACHMENT;
+				return true;
+			}
+			if (name.size() == 7 && name.compare(0, 6, "color-") == 0 &&
+					name[6] >= '0' && name[6] < '0' + FramebufferFormat::MAX_COLOR_ATTACHMENTS) {
+				attachment = name[6] - '0';
+				return true;
+			}
+			return false;
+		}
+
+		// texture unit and the used region of a texture atlas
+		typedef std::vector<std::pair<unsigned int, TextureAtlas::Region> > TTexRegions;
+
+		/**
+		 * @param outTexRegions Regions of texture atlases which are used
+		 *        with <atlas-id-name> <region-name>.
+		 */
 		bool addTexture(const cfg::Value& cfgValue,
 				TextureComponent& texture,
-				const ResourceManager& rm)
+				const ResourceManager& rm,
+				TTexRegions& outTexRegions)
 		{
 			std::string texIdName[8];
 			unsigned int texIdNameCount[8] = {};
 			bool texNull[8];
 			unsigned int texNullCount[8] = {};
+			// <fb-id-name> <attachment> for a specific attachment of a framebuffer
+			const cfg::Value* texAttachment[8] = {};
+			unsigned int texAttachmentCount[8] = {};
 			cfg::SelectRule cfgRules[] = {
 					cfg::SelectRule("tex-id-unit-0", &texIdName[0], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_TEXT, &texIdNameCount[0]),
 					cfg::SelectRule("tex-id-unit-0", &texNull[0], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_NULL, &texNullCount[0]),
+					cfg::SelectRule("tex-id-unit-0", &texAttachment[0], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_ARRAY, &texAttachmentCount[0]),
 					cfg::SelectRule("tex-id-unit-1", &texIdName[1], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_TEXT, &texIdNameCount[1]),
 					cfg::SelectRule("tex-id-unit-1", &texNull[1], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_NULL, &texNullCount[1]),
+					cfg::SelectRule("tex-id-unit-1", &texAttachment[1], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_ARRAY, &texAttachmentCount[1]),
 					cfg::SelectRule("tex-id-unit-2", &texIdName[2], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_TEXT, &texIdNameCount[2]),
 					cfg::SelectRule("tex-id-unit-2", &texNull[2], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_NULL, &texNullCount[2]),
+					cfg::SelectRule("tex-id-unit-2", &texAttachment[2], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_ARRAY, &texAttachmentCount[2]),
 					cfg::SelectRule("tex-id-unit-3", &texIdName[3], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_TEXT, &texIdNameCount[3]),
 					cfg::SelectRule("tex-id-unit-3", &texNull[3], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_NULL, &texNullCount[3]),
+					cfg::SelectRule("tex-id-unit-3", &texAttachment[3], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_ARRAY, &texAttachmentCount[3]),
 					cfg::SelectRule("tex-id-unit-4", &texIdName[4], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_TEXT, &texIdNameCount[4]),
 					cfg::SelectRule("tex-id-unit-4", &texNull[4], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_NULL, &texNullCount[4]),
+					cfg::SelectRule("tex-id-unit-4", &texAttachment[4], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_ARRAY, &texAttachmentCount[4]),
 					cfg::SelectRule("tex-id-unit-5", &texIdName[5], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_TEXT, &texIdNameCount[5]),
 					cfg::SelectRule("tex-id-unit-5", &texNull[5], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_NULL, &texNullCount[5]),
+					cfg::SelectRule("tex-id-unit-5", &texAttachment[5], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_ARRAY, &texAttachmentCount[5]),
 					cfg::SelectRule("tex-id-unit-6", &texIdName[6], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_TEXT, &texIdNameCount[6]),
 					cfg::SelectRule("tex-id-unit-6", &texNull[6], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_NULL, &texNullCount[6]),
+					cfg::SelectRule("tex-id-unit-6", &texAttachment[6], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_ARRAY, &texAttachmentCount[6]),
 					cfg::SelectRule("tex-id-unit-7", &texIdName[7], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_TEXT, &texIdNameCount[7]),
 					cfg::SelectRule("tex-id-unit-7", &texNull[7], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_NULL, &texNullCount[7]),
+					cfg::SelectRule("tex-id-unit-7", &texAttachment[7], cfg::SelectRule::RULE_OPTIONAL, cfg::SelectRule::ALLOW_ARRAY, &texAttachmentCount[7]),
 					cfg::SelectRule("")
 			};
 			size_t nextPos = 0;
@@ -116,7 +157,7 @@ namespace gs
 				return false;
 			}
 			for (int i = 0; i < 8; ++i) {
-				if (texIdNameCount[i] + texNullCount[i] > 1) {
+				if (texIdNameCount[i] + texNullCount[i] + texAttachmentCount[i] > 1) {
 					LOGE("tex-id-unit-%d is used twice or more which is not allowed.\n", i);
 					return false;
 				}
@@ -128,6 +169,39 @@ namespace gs
 					}
 					texture.setTextureId(id, i);
 				}
+				else if (texAttachmentCount[i] &&
+						texAttachment[i]->mArray.size() == 2 && texAttachment[i]->mArray[0].isText() &&
+						rm.getTextureAtlasByIdName(texAttachment[i]->mArray[0].mText)) {
+					// <atlas-id-name> <region-name> --> the atlas is bound and the
+					// texture coordinates of the mesh are remapped to the region
+					const std::vector<cfg::Value>& arr = texAttachment[i]->mArray;
+					std::shared_ptr<TextureAtlas> atlas = rm.getTextureAtlasByIdName(arr[0].mText);
+					const TextureAtlas::Region* region = atlas->getRegion(arr[1].mText);
+					if (!region) {
+						LOGE("%s: Can't find region '%s' of texture atlas %s for tex-id-unit-%d.\n",
+								texAttachment[i]->getFilenameAndPosition().c_str(),
+								arr[1].mText.c_str(), arr[0].mText.c_str(), i);
+						return false;
+					}
+					texture.setTextureId(atlas->getIdNumber(), i);
+					outTexRegions.emplace_back(i, *region);
+				}
+				else if (texAttachmentCount[i]) {
+					const std::vector<cfg::Value>& arr = texAttachment[i]->mArray;
+					unsigned int attachment = 0;
+					if (arr.size() != 2 || !arr[0].isText() ||
+							!getFramebufferAttachment(arr[1], attachment)) {
+						LOGE("%s: tex-id-unit-%d must be <framebuffer-id-name> color-<N> or depth\n",
+								texAttachment[i]->getFilenameAndPosition().c_str(), i);
+						return false;
+					}
+					TResourceId id = rm.getResourceId(arr[0].mText);
+					if (!id || !rm.getFramebufferByIdNumber(id)) {
+						LOGE("Can't find framebuffer id name %s for tex-id-unit-%d.\n", arr[0].mText.c_str(), i);
+						return false;
+					}
+					texture.setTextureId(id, i, attachment);
+				}
 				else if (texNullCount[i]) {
 					if (!texNull[i]) {
 						LOGE("Texture id for tex-id-unit-%d should be null but isn't.\n", i);
@@ -202,9 +276,14 @@ namespace gs
 			return true;
 		}
 
+		/**
+		 * @param texRegions Regions of the texture component. Only a mesh
+		 *        which is created here (not a mesh-id) is remapped.
+		 */
 		bool addMesh(const cfg::Value& cfgValue,
 				MeshComponent& mesh,
-				ResourceManager& rm)
+				ResourceManager& rm,
+				const TTexRegions& texRegions)
 		{
 			std::string meshIdName;
 			unsigned int meshIdNameCount = 0;
@@ -239,6 +318,12 @@ namespace gs
 					return false;
 				}
 				mesh.setGraphicId(id);
+				if (!texRegions.empty()) {
+					// the mesh can be shared by other entities
+					LOGW("%s: texture region is not applied to mesh-id %s (use texture-region at the mesh).\n",
+							cfgValue.getFilenameAndPosition().c_str(),
+							meshIdName.c_str());
+				}
 			}
 			if (vgArray) {
 				TResourceId id = resloader::addMesh(rm, *vgArray);
@@ -248,6 +333,16 @@ namespace gs
 							meshIdName.c_str());
 					return false;
 				}
+				std::shared_ptr<Mesh> m = rm.getMeshByIdNumber(id);
+				for (const auto& texRegion : texRegions) {
+					const TextureAtlas::Region& r = texRegion.second;
+					if (!m || !m->remapTexCoords(texRegion.first, r.mS0, r.mT0, r.mS1, r.mT1)) {
+						LOGE("%s: Mesh has no texture coordinates s%u, t%u for region '%s'.\n",
+								cfgValue.getFilenameAndPosition().c_str(),
+								texRegion.first, texRegion.first, r.mName.c_str());
+						return false;
+					}
+				}
 				mesh.setGraphicId(id);
 			}
 			if (colorCount) {
@@ -365,8 +460,9 @@ namespace gs
 						return false;
 					}
 				}
+				TTexRegions texRegions;
 				if (compTextureCount) {
-					if (!addTexture(*compTexture, child->texture(), rm)) {
+					if (!addTexture(*compTexture, child->texture(), rm, texRegions)) {
 						LOGE("Add texture component failed\n");
 						return false;
 					}
@@ -378,7 +474,7 @@ namespace gs
 					}
 				}
 				if (compMeshCount) {
-					if (!addMesh(*compMesh, child->mesh(), rm)) {
+					if (!addMesh(*compMesh, child->mesh(), rm, texRegions)) {
 						LOGE("Add mesh component failed\n");
 						return false;
 					}
@@ -398,7 +494,8 @@ namespace gs
 bool gs::sceneloader::reload(const cfg::NameValuePair& cfg,
 		const std::weak_ptr<FileChangeMonitoring>& fcm,
 		ResourceManager& rm, SceneManager& sm, RenderPassManager& pm,
-		bool reloadResourceManager, bool reloadSceneManager, bool reloadRenderPassManager)
+		bool reloadResourceManager, bool reloadSceneManager, bool reloadRenderPassManager,
+		const ResourceManager* prevRm)
 {
 	const cfg::NameValuePair* contextCfg = nullptr;
 	const cfg::NameValuePair* resourcesCfg = nullptr;
@@ -421,7 +518,7 @@ bool gs::sceneloader::reload(const cfg::NameValuePair& cfg,
 
 	if (reloadResourceManager) {
 		LOGI("Start loading resources.\n");
-		resloader::addResources(rm, *resourcesCfg);
+		resloader::addResources(rm, *resourcesCfg, prevRm);
 		LOGI("res list:\n%s\n", rm.toString().c_str());
 	}
 
@@ -3,11 +3,19 @@
 #include <gs/rendering/gl_api.h>
 #include <gs/rendering/renderer.h>
 #include <gs/rendering/render_pass_manager.h>
+#include <gs/rendering/render_statistic.h>
 #include <gs/system/file_change_monitoring.h>
+#include <gs/system/hot_reload_statistic.h>
 #include <gs/system/log.h>
 #include <gs/ecs/entity.h>
 #include <gs/res/mesh.h>
 #include <gs/res/resource_manager.h>
+#include <gs/res/shader_binary_cache.h>
+#include <gs/res/shader_include_cache.h>
+#include <gs/res/shader_object_cache.h>
+#include <gs/res/texture_decoder.h>
+#include <gs/res/pixel_buffer_pool.h>
+#include <gs/res/render_target_pool.h>
 #include <gs/scene/scene_manager.h>
 #include <gs/gui/gui_manager.h>
 #include <gs/common/vertex.h>
@@ -34,6 +42,40 @@
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 600
 
+namespace gs
+{
+	namespace
+	{
+		// empty if the section doesn't exist
+		std::string getSectionAsString(const cfg::NameValuePair& cfg, const std::string& name)
+		{
+			for (const cfg::NameValuePair& section : cfg.mValue.mObject) {
+				if (section.mName.mText == name) {
+					// without the positions inside of the file
+					return cfg::tmlstring::valueToString(0, section.mValue);
+				}
+			}
+			return "";
+		}
+
+		bool isSectionChanged(const cfg::NameValuePair& prevCfg,
+				const cfg::NameValuePair& cfg, const std::string& name)
+		{
+			return getSectionAsString(prevCfg, name) != getSectionAsString(cfg, name);
+		}
+
+		// is called by another thread --> no access to the context
+		std::unique_ptr<cfg::NameValuePair> loadSceneConfig(std::string filename)
+		{
+			std::unique_ptr<cfg::NameValuePair> sceneConfig(new cfg::NameValuePair());
+			if (!configloader::getConfigAsTree(filename, *sceneConfig)) {
+				return std::unique_ptr<cfg::NameValuePair>();
+			}
+			return sceneConfig;
+		}
+	}
+}
+
 gs::Context::Context(const std::string& progname)
 		:mIsError(true), mIsSdlInit(false), //mIsSdlImageInit(false),
 		mWindow(nullptr), mContext(nullptr),
@@ -58,6 +100,10 @@ gs::Context::Context(const std::string& progname)
 
 gs::Context::~Context()
 {
+	if (mStagedReloadFuture.valid()) {
+		// the loading thread uses the members of the context
+		mStagedReloadFuture.wait();
+	}
 	destroyContext();
 }
 
@@ -82,7 +128,19 @@ bool gs::Context::run()
 
 	const cfg::NameValuePair& cfg = *mSceneConfig;
 
-	mResourceManager.reset(new ResourceManager(mFileMonitoring, mContextProperties.useVaoVersionForMesh()));
+	mShaderBinaryCache = std::make_shared<ShaderBinaryCache>();
+	mShaderIncludeCache = std::make_shared<ShaderIncludeCache>(mFileMonitoring);
+	mShaderObjectCache = std::make_shared<ShaderObjectCache>();
+	mPixelBufferPool = std::make_shared<PixelBufferPool>();
+	mTextureDecoder = std::make_shared<TextureDecoder>();
+	mRenderTargetPool = std::make_shared<RenderTargetPool>();
+	mResourceManager.reset(new ResourceManager(mFileMonitoring, mContextProperties.useVaoVersionForMesh(),
+			mTextureDecoder, mRenderTargetPool, mPixelBufferPool));
+	mResourceManager->setShaderBinaryCache(mShaderBinaryCache);
+	mResourceManager->setShaderIncludeCache(mShaderIncludeCache);
+	mResourceManager->setShaderObjectCache(mShaderObjectCache);
+	// the texture atlases are packed without the GL context at a reload
+	mResourceManager->setMaxTextureSize(mContextProperties.mCreatedMaxTextureSize);
 	mSceneManager.reset(new SceneManager());
 	mPassManager.reset(new RenderPassManager());
 	if (!sceneloader::reload(cfg, mFileMonitoring, *mResourceManager, *mSceneManager, *mPassManager, true, true, true)) {
@@ -90,7 +148,8 @@ bool gs::Context::run()
 		return false;
 	}
 
-	mHotReloadingId = mFileMonitoring->addFile(mSceneFilename, hotReloading, std::shared_ptr<void>(), this);
+	mHotReloadingId = mFileMonitoring->addFile(mSceneFilename, hotReloading, std::shared_ptr<void>(), this,
+			FileChangeMonitoring::DEFAULT_SETTLE_MSEC, true);
 
 	bool newLoaded = true;
 
@@ -101,9 +160,12 @@ bool gs::Context::run()
 		mFileMonitoring->checkChanges();
 
 		if (mReloadSceneNow) {
-			reload();
+			startReload();
+		}
+		if (updateReload()) {
 			newLoaded = true;
 		}
+		mResourceManager->updateLoading();
 
 		SDL_Event e;
 		uint32_t tick = SDL_GetTicks();
@@ -112,6 +174,7 @@ bool gs::Context::run()
 		float tsSec = float(tick) * 0.001f;
 		float dtSec = float(dtMsec) * 0.001f;
 
+		++mProperties.mFrameNumber;
 		mProperties.mTsMsec = tick;
 		mProperties.mTsSec = tsSec;
 		mProperties.mDeltaTimeSec = dtSec;
@@ -165,6 +228,9 @@ bool gs::Context::run()
 					else if (e.key.keysym.sym == '2') {
 						mProperties.mDrawNormals = !mProperties.mDrawNormals;
 					}
+					else if (e.key.keysym.sym == '3') {
+						dumpRenderStatistic();
+					}
 					break;
 				case SDL_MOUSEMOTION:
 					mProperties.mMousePosPixel = Vector2f(static_cast<float>(e.motion.x),
@@ -199,12 +265,20 @@ bool gs::Context::run()
 
 		SDL_GL_SwapWindow(mWindow);
 
+		getRenderStatistic().endFrame();
+		// first frame with a new version of a hot reloaded file
+		getHotReloadStatistic().endFrame();
+
 		// tick < prevFpsTick is only possible after ~49 days ;-P
 		if (tick > prevFpsTick + 1000 || tick < prevFpsTick) {
 			//LOGI("FPS %u\n", frameCnt);
+			const RenderCounters& rc = getRenderStatistic().getFrameCounters();
 			SDL_SetWindowTitle(mWindow,
 					("glslScene: " + mContextProperties.mSceneDirName +
 					", FPS: " + std::to_string(frameCnt) +
+					", draw calls: " + std::to_string(rc.mDrawCalls) +
+					", binds: " + std::to_string(rc.mProgramBinds) +
+					"/" + std::to_string(rc.mTextureBinds) +
 					"   -   ESC for enable/disable menu").c_str());
 			prevFpsTick += 1000;
 			frameCnt = 0;
@@ -212,6 +286,11 @@ bool gs::Context::run()
 
 		prevTick = tick;
 	}
+	if (mStagedReloadFuture.valid()) {
+		// the managers of the loading thread are destroyed by the GL thread
+		mStagedReloadFuture.get();
+	}
+	discardStagedReload();
 	mFileMonitoring->removeFile(mHotReloadingId);
 	return true;
 }
@@ -379,6 +458,14 @@ void gs::Context::initContext()
 		printf( "Error initializing GLEW! %s\n", glewGetErrorString(glewError));
 		return;
 	}
+	// let the driver use as many threads as it wants for compiling shaders
+	// (see ShaderProgram::startLoading())
+	if (GLEW_KHR_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsKHR(0xffffffff);
+	}
+	else if (GLEW_ARB_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsARB(0xffffffff);
+	}
 #else
 	#ifdef GLSLSCENE_USE_GLAD
 	// INITIALIZE GLAD:
@@ -443,6 +530,7 @@ void gs::Context::initContext()
 	mContextProperties.mCreatedRenderer = (char *)glGetString(GL_RENDERER);
 	glGetIntegerv(GL_MAJOR_VERSION, &mContextProperties.mCreatedMajorVersion);
 	glGetIntegerv(GL_MINOR_VERSION, &mContextProperties.mCreatedMinorVersion);
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &mContextProperties.mCreatedMaxTextureSize);
 
 	LOGI("OpenGL Shading Language Version: %s\n",
 			mContextProperties.mCreatedGlslVersion.c_str());
@@ -471,6 +559,16 @@ void gs::Context::destroyContext()
 	}
 }
 
+void gs::Context::dumpRenderStatistic()
+{
+	const RenderStatistic& rs = getRenderStatistic();
+	LOGI("render statistic of frame %u:\n%s\n", rs.getFrameNumber(),
+			rs.getFrameCounters().toString().c_str());
+	if (rs.writeToFile("render-statistic.tml")) {
+		LOGI("render statistic is written to render-statistic.tml\n");
+	}
+}
+
 void gs::Context::hotReloading(unsigned int callbackId,
 		const std::string& filename,
 		const std::shared_ptr<void>& fileMonitoring, void* thisContext)
@@ -482,68 +580,193 @@ void gs::Context::hotReloadingSceneFile(unsigned int callbackId,
 		const std::string& filename)
 {
 	mReloadSceneNow = true;
+	HotReloadStatistic& hrs = getHotReloadStatistic();
+	unsigned int reloadId = hrs.attachCurrent();
+	if (reloadId) {
+		// the previous change is not shown anymore
+		hrs.release(mSceneReloadId);
+		mSceneReloadId = reloadId;
+	}
 }
 
-void gs::Context::reload()
+void gs::Context::startReload()
 {
+	if (mStagedReloadFuture.valid()) {
+		// the file is loaded again after the current loading is done
+		return;
+	}
 	mReloadSceneNow = false;
+	// a newer version of the scene file is loaded
+	discardStagedReload();
+	LOGI("Start loading scene file.\n");
+	// the current managers are not changed until the loading is done
+	mStagedReloadFuture = std::async(std::launch::async, &Context::loadStagedReload, this);
+}
 
-	std::unique_ptr<cfg::NameValuePair> sceneConfig(new cfg::NameValuePair());
-	if (!configloader::getConfigAsTree(mSceneFilename, *sceneConfig)) {
-		LOGE("Can't load scene file. %s\n", mSceneFilename.c_str());
-		LOGD("%s", cfg::tmlstring::valueToString(0, mSceneConfig->mValue).c_str());
-		return;
+bool gs::Context::updateReload()
+{
+	if (mStagedReloadFuture.valid()) {
+		if (mStagedReloadFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			return false;
+		}
+		// a failed reload is also destroyed by the GL thread
+		std::unique_ptr<StagedReload> staged = mStagedReloadFuture.get();
+		if (!staged->mSceneConfig) {
+			LOGE("Can't load scene file. %s\n", mSceneFilename.c_str());
+			LOGD("%s", cfg::tmlstring::valueToString(0, mSceneConfig->mValue).c_str());
+			releaseSceneReload();
+			return false;
+		}
+		if (!staged->mIsChanged) {
+			LOGI("Scene file has no changed resources, scenes or rendering --> no reload\n");
+			mSceneConfig = std::move(staged->mSceneConfig);
+			releaseSceneReload();
+			return false;
+		}
+		if (!staged->mIsLoaded) {
+			LOGE("Can't load scene file.\n");
+			releaseSceneReload();
+			return false;
+		}
+		LOGI("loaded successful. Waiting for the loading textures and shaders.\n");
+		if (staged->mResourceManager) {
+			// the GPU objects are created by updateLoading()
+			staged->mResourceManager->setGpuObjectsDeferred(false);
+		}
+		mStagedReload = std::move(staged);
+		getHotReloadStatistic().markLoaded(mSceneReloadId);
 	}
-	bool reloadResourceManager = true;
-	bool reloadSceneManager = true;
+	if (!mStagedReload) {
+		return false;
+	}
+	if (mStagedReload->mResourceManager) {
+		// the GPU objects are created and the textures are uploaded with
+		// the budget per frame (time sliced) and the linked shader programs
+		// are applied
+		mStagedReload->mResourceManager->updateLoading();
+		if (mStagedReload->mResourceManager->isLoading()) {
+			return false; // the current scene is still used
+		}
+		if (mStagedReload->mResourceManager->hasFailedShaderProgram()) {
+			LOGE("Can't load scene file (shader program). %s\n", mSceneFilename.c_str());
+			discardStagedReload();
+			releaseSceneReload();
+			return false;
+		}
+	}
+	applyStagedReload();
+	return true;
+}
+
+std::unique_ptr<gs::Context::StagedReload> gs::Context::loadStagedReload()
+{
+	std::unique_ptr<StagedReload> staged(new StagedReload());
+	staged->mSceneConfig = loadSceneConfig(mSceneFilename);
+	if (!staged->mSceneConfig) {
+		return staged;
+	}
+	const cfg::NameValuePair& sceneConfig = *staged->mSceneConfig;
+	// Only the changed sections are loaded again. The resources and the
+	// scenes are loaded together because the scenes use the id numbers of
+	// the resources (and add meshes to the resource manager).
+	bool isResourcesChanged = isSectionChanged(*mSceneConfig, sceneConfig, "resources");
+	bool isScenesChanged = isSectionChanged(*mSceneConfig, sceneConfig, "scenes");
+	bool isRenderingChanged = isSectionChanged(*mSceneConfig, sceneConfig, "rendering");
+	if (!isResourcesChanged && !isScenesChanged && !isRenderingChanged) {
+		return staged;
+	}
+	staged->mIsChanged = true;
+	bool reloadResourceManager = isResourcesChanged || isScenesChanged;
+	bool reloadSceneManager = reloadResourceManager;
+	// the render passes use the id numbers of the scenes and framebuffers
 	bool reloadRenderPassManager = true;
-	std::unique_ptr<ResourceManager> resourceManager;
-	std::unique_ptr<SceneManager> sceneManager;
-	std::unique_ptr<RenderPassManager> passManager;
+
 	ResourceManager* rm = mResourceManager.get();
 	SceneManager* sm = mSceneManager.get();
 	RenderPassManager* pm = mPassManager.get();
 #ifdef USE_NEW_FILE_MONITORING_AT_SCENE_RELOAD
-	std::shared_ptr<FileChangeMonitoring> fileMonitoring = std::make_shared<FileChangeMonitoring>(false);
+	staged->mFileMonitoring = std::make_shared<FileChangeMonitoring>(false);
+	// the resources are monitored by the old file monitoring
+	const ResourceManager* prevRm = nullptr;
 #else
 	// works also without recreate the file monitoring
-	std::shared_ptr<FileChangeMonitoring> fileMonitoring = mFileMonitoring;
+	staged->mFileMonitoring = mFileMonitoring;
+	// unchanged resources are taken over (no new GPU objects). The current
+	// resource manager is only read (the GL thread doesn't add resources).
+	const ResourceManager* prevRm = mResourceManager.get();
 #endif
 	if (reloadResourceManager) {
-		resourceManager.reset(new ResourceManager(fileMonitoring,
-				mContextProperties.useVaoVersionForMesh()));
-		rm = resourceManager.get();
+		staged->mResourceManager.reset(new ResourceManager(staged->mFileMonitoring,
+				mContextProperties.useVaoVersionForMesh(), mTextureDecoder, mRenderTargetPool,
+				mPixelBufferPool));
+		// no GL context at this thread --> the GPU objects are created by
+		// updateReload() in batches per frame
+		staged->mResourceManager->setGpuObjectsDeferred(true);
+		staged->mResourceManager->setMaxTextureSize(mContextProperties.mCreatedMaxTextureSize);
+		// unchanged shader programs are not compiled again
+		staged->mResourceManager->setShaderBinaryCache(mShaderBinaryCache);
+		staged->mResourceManager->setShaderObjectCache(mShaderObjectCache);
+#ifndef USE_NEW_FILE_MONITORING_AT_SCENE_RELOAD
+		// the included files are monitored by the file monitoring of the context
+		staged->mResourceManager->setShaderIncludeCache(mShaderIncludeCache);
+#endif
+		// the directory of the shared cache is changed by applyStagedReload()
+		staged->mResourceManager->setShaderCacheDirectoryDeferred(true);
+		// compiled and linked by the driver while the current scene is rendered
+		staged->mResourceManager->setShaderLoadingAsync(true);
+		rm = staged->mResourceManager.get();
 	}
 	if (reloadSceneManager) {
-		sceneManager.reset(new SceneManager());
-		sm = sceneManager.get();
+		staged->mSceneManager.reset(new SceneManager());
+		sm = staged->mSceneManager.get();
 	}
 	if (reloadRenderPassManager) {
-		passManager.reset(new RenderPassManager());
-		pm = passManager.get();
+		staged->mPassManager.reset(new RenderPassManager());
+		pm = staged->mPassManager.get();
 	}
 	LOGI("Start reloading scene.\n");
-	if (!sceneloader::reload(*sceneConfig, fileMonitoring, *rm, *sm, *pm,
-			reloadResourceManager, reloadSceneManager, reloadRenderPassManager)) {
-		LOGE("Can't load scene file.\n");
-		return;
-	}
-	LOGI("loaded successful.\n");
-	mSceneConfig = std::move(sceneConfig);
-	if (reloadResourceManager) {
-		mResourceManager = std::move(resourceManager);
+	staged->mIsLoaded = sceneloader::reload(sceneConfig, staged->mFileMonitoring, *rm, *sm, *pm,
+			reloadResourceManager, reloadSceneManager, reloadRenderPassManager, prevRm);
+	return staged;
+}
+
+void gs::Context::applyStagedReload()
+{
+	std::unique_ptr<StagedReload> staged = std::move(mStagedReload);
+	mSceneConfig = std::move(staged->mSceneConfig);
+	if (staged->mResourceManager) {
+		mResourceManager = std::move(staged->mResourceManager);
+		mResourceManager->applyShaderCacheDirectory();
 	}
-	if (reloadSceneManager) {
-		mSceneManager = std::move(sceneManager);
+	if (staged->mSceneManager) {
+		mSceneManager = std::move(staged->mSceneManager);
 	}
-	if (reloadRenderPassManager) {
-		mPassManager = std::move(passManager);
+	if (staged->mPassManager) {
+		mPassManager = std::move(staged->mPassManager);
 	}
 #ifdef USE_NEW_FILE_MONITORING_AT_SCENE_RELOAD
 	LOGI("Switch hot reloading.\n");
-	mFileMonitoring = fileMonitoring;
-	mHotReloadingId = mFileMonitoring->addFile(mSceneFilename, hotReloading, std::shared_ptr<void>(), this);
+	mFileMonitoring = staged->mFileMonitoring;
+	mHotReloadingId = mFileMonitoring->addFile(mSceneFilename, hotReloading, std::shared_ptr<void>(), this,
+			FileChangeMonitoring::DEFAULT_SETTLE_MSEC, true);
 #endif
 	LOGI("Reload and apply scene file.\n");
+	getHotReloadStatistic().markUploaded(mSceneReloadId);
+	mSceneReloadId = 0;
+}
+
+void gs::Context::discardStagedReload()
+{
+	if (!mStagedReload) {
+		return;
+	}
+	LOGI("Discard the reloaded scene which is not applied yet.\n");
+	mStagedReload.reset();
+}
+
+void gs::Context::releaseSceneReload()
+{
+	getHotReloadStatistic().release(mSceneReloadId);
+	mSceneReloadId = 0;
 }
 
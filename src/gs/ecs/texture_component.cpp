@@ -5,7 +5,7 @@
 
 
 gs::TextureComponent::TextureComponent(std::weak_ptr<Entity> entity)
-		:Component(entity), mSharedCustomData(), mIsUsedFlags(0), mTextureIds{}
+		:Component(entity), mSharedCustomData(), mIsUsedFlags(0), mTextureIds{}, mFbAttachments{}
 {
 	reset();
 }
@@ -20,11 +20,12 @@ void gs::TextureComponent::reset()
 	mIsUsedFlags = 0;
 	for (int i = 0; i < MAX_TEXTURE_UNITS; ++i) {
 		mTextureIds[i] = TEXTURE_ID_INVALID;
+		mFbAttachments[i] = 0;
 	}
 }
 
 void gs::TextureComponent::setTextureId(TTextureId textureId,
-		unsigned int textureUnit)
+		unsigned int textureUnit, unsigned int fbAttachment)
 {
 	if (textureUnit >= MAX_TEXTURE_UNITS) {
 		return;
@@ -37,5 +38,6 @@ void gs::TextureComponent::setTextureId(TTextureId textureId,
 		mIsUsedFlags |= lookUpSet[textureUnit];
 	}
 	mTextureIds[textureUnit] = textureId;
+	mFbAttachments[textureUnit] = fbAttachment;
 }
 
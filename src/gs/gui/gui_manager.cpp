@@ -9,9 +9,14 @@
 
 #include <gs/res/resource.h>
 #include <gs/res/texture.h>
+#include <gs/res/texture_atlas.h>
 #include <gs/res/shader_program.h>
 #include <gs/res/mesh.h>
 #include <gs/res/framebuffer.h>
+#include <gs/res/render_target_pool.h>
+#include <gs/res/texture_decoder.h>
+#include <gs/res/texture_cache.h>
+#include <gs/res/texture_compression.h>
 #include <gs/res/resource_manager.h>
 #include <gs/res/uniform.h>
 
@@ -27,8 +32,10 @@
 #include <gs/rendering/renderer.h>
 #include <gs/rendering/render_pass.h>
 #include <gs/rendering/render_pass_manager.h>
+#include <gs/rendering/render_statistic.h>
 
 #include <gs/system/file_change_monitoring.h>
+#include <gs/system/hot_reload_statistic.h>
 #include <gs/system/log.h>
 #include <gs/common/fs.h>
 
@@ -226,8 +233,14 @@ namespace gs
 				return; // no ImGui::TreePop() here!
 			}
 			IntentText("filename: %s", tex.getFilename().c_str());
-			IntentText("resolution: %ux%u", tex.getWidth(), tex.getHeight());
+			IntentText("resolution: %ux%u%s", tex.getWidth(), tex.getHeight(),
+					tex.isLoading() ? " (loading, placeholder is used)" : "");
 			IntentText("mipmap: %s", (tex.getMipmap() == TexMipmap::MIPMAP) ? "true" : "false");
+			IntentText("compression: %s (used: %s)", getCompressionStr(tex.getCompression()),
+					getCompressionStr(tex.getUsedCompression()));
+			IntentText("format: %s (internal format: 0x%x)",
+					(tex.getFormat() == TexFormat::RGBA8) ? "rgba8" : "auto",
+					tex.getInternalFormat());
 			IntentText("minification filter: %s",
 					(tex.getMinFilter() == TexFilter::LINEAR) ? "linear" : "nearest");
 			IntentText("magnification filter: %s",
@@ -235,6 +248,26 @@ namespace gs
 			ImGui::TreePop();
 		}
 
+		void addTextureAtlasResToMenu(const TextureAtlas& atlas)
+		{
+			if (!addResToMenu(atlas, "texture atlas")) {
+				return; // no ImGui::TreePop() here!
+			}
+			const Texture& tex = *atlas.getTexture();
+			IntentText("resolution: %ux%u", tex.getWidth(), tex.getHeight());
+			IntentText("mipmap: %s", (tex.getMipmap() == TexMipmap::MIPMAP) ? "true" : "false");
+			IntentText("padding: %u, pack count: %u", atlas.getPadding(), atlas.getPackCount());
+			if (ImGui::TreeNode("regions:")) {
+				for (const TextureAtlas::Region& r : atlas.getRegions()) {
+					IntentText("%s: %dx%d at %d/%d, %s", r.mName.c_str(),
+							r.mRect.mWidth, r.mRect.mHeight, r.mRect.mLeft, r.mRect.mTop,
+							r.mFilename.c_str());
+				}
+				ImGui::TreePop();
+			}
+			ImGui::TreePop();
+		}
+
 		const char* getShaderTypeStr(ShaderType type)
 		{
 			switch (type) {
@@ -533,6 +566,34 @@ namespace gs
 				return; // no ImGui::TreePop() here!
 			}
 			IntentText("resolution: %ux%u", fb.getWidth(), fb.getHeight());
+			const ResolutionScale& rs = fb.getResolutionScale();
+			if (rs.isDynamic()) {
+				IntentText("resolution scale: %.2f (dynamic, base: %ux%u, target: %.1f ms, avg: %.1f ms, range: %.2f - %.2f)",
+						rs.getScale(), fb.getBaseWidth(), fb.getBaseHeight(),
+						rs.getTargetFrameTimeMsec(), rs.getAvgFrameTimeMsec(),
+						rs.getMinScale(), rs.getMaxScale());
+			}
+			else {
+				IntentText("resolution scale: %.2f (base: %ux%u)", rs.getScale(),
+						fb.getBaseWidth(), fb.getBaseHeight());
+			}
+			IntentText("resize pending: %s", fb.isResizePending() ? "true" : "false");
+			IntentText("color attachments: %u", fb.getColorAttachmentCount());
+			for (unsigned int i = 0; i < fb.getColorAttachmentCount(); ++i) {
+				IntentText("color-%u: internal format 0x%x", i, fb.getFormat().mColorFormats[i]);
+			}
+			switch (fb.getFormat().mDepth) {
+				case FbDepth::NONE:
+					IntentText("depth: none");
+					break;
+				case FbDepth::RENDERBUFFER:
+					IntentText("depth: renderbuffer");
+					break;
+				case FbDepth::TEXTURE:
+					IntentText("depth: texture");
+					break;
+			}
+			IntentText("mipmap: %s", fb.getFormat().mMipmap ? "true" : "false");
 			ImGui::TreePop();
 		}
 
@@ -575,9 +636,92 @@ namespace gs
 			addCreatedContextToMenu(cp);
 		}
 
+		void addRenderCountersToMenu(const RenderCounters& rc)
+		{
+			IntentText("draw calls: %u", rc.mDrawCalls);
+			IntentText("vertices: %u", rc.mVertices);
+			IntentText("program binds: %u", rc.mProgramBinds);
+			IntentText("texture binds: %u", rc.mTextureBinds);
+			IntentText("vao binds: %u", rc.mVaoBinds);
+			IntentText("vbo binds: %u", rc.mVboBinds);
+			IntentText("uniform uploads: %u", rc.mUniformUploads);
+			IntentText("buffer uploads: %" PRIu64 " bytes", rc.mBufferUploadBytes);
+			IntentText("framebuffer switches: %u", rc.mFramebufferSwitches);
+		}
+
+		void addRenderStatisticToMenu(const RenderStatistic& rs)
+		{
+			IntentText("frame: %u", rs.getFrameNumber());
+			ImGui::Indent();
+			if (ImGui::Button("Dump statistic to render-statistic.tml")) {
+				rs.writeToFile("render-statistic.tml");
+			}
+			ImGui::Unindent();
+			if (ImGui::TreeNode("frame (all passes + gui)")) {
+				addRenderCountersToMenu(rs.getFrameCounters());
+				ImGui::TreePop();
+			}
+			const std::vector<RenderCounters>& passes = rs.getPassCounters();
+			char strId[32];
+			size_t passCount = passes.size();
+			for (size_t i = 0; i < passCount; ++i) {
+				snprintf(strId, 32, "stat-render-pass_%zu", i);
+				if (ImGui::TreeNode(strId, "render-pass %zu - draw calls: %u",
+						i, passes[i].mDrawCalls)) {
+					addRenderCountersToMenu(passes[i]);
+					ImGui::TreePop();
+				}
+			}
+		}
+
+		void addHotReloadLatencyToMenu(const HotReloadStatistic& hrs)
+		{
+			const std::deque<HotReloadStatistic::Record>& history = hrs.getHistory();
+			IntentText("reloads: %zu (in progress: %u)", history.size(), hrs.getActiveCount());
+			if (history.empty()) {
+				return;
+			}
+			const HotReloadStatistic::Record& last = history.back();
+			IntentText("last: %s, total: %u ms", last.mFilename.c_str(),
+					last.getMsec(HotReloadPhase::TOTAL));
+			IntentText("detect: %u ms, load: %u ms, upload: %u ms, present: %u ms",
+					last.getMsec(HotReloadPhase::DETECT), last.getMsec(HotReloadPhase::LOAD),
+					last.getMsec(HotReloadPhase::UPLOAD), last.getMsec(HotReloadPhase::PRESENT));
+
+			const char* phaseNames[] = {"detect", "load", "upload", "present", "total"};
+			if (ImGui::TreeNode("percentiles (ms)")) {
+				for (unsigned int i = 0; i <= static_cast<unsigned int>(HotReloadPhase::TOTAL); ++i) {
+					HotReloadPhase phase = static_cast<HotReloadPhase>(i);
+					IntentText("%-8s p50: %u, p90: %u, p99: %u, max: %u", phaseNames[i],
+							hrs.getPercentile(phase, 50), hrs.getPercentile(phase, 90),
+							hrs.getPercentile(phase, 99), hrs.getPercentile(phase, 100));
+				}
+				ImGui::TreePop();
+			}
+			if (ImGui::TreeNode("history")) {
+				std::vector<float> totals;
+				totals.reserve(history.size());
+				for (const HotReloadStatistic::Record& r : history) {
+					totals.push_back(float(r.getMsec(HotReloadPhase::TOTAL)));
+				}
+				ImGui::PlotHistogram("total (ms)", totals.data(), int(totals.size()));
+				// newest first
+				for (auto it = history.rbegin(); it != history.rend(); ++it) {
+					IntentText("%s: %u ms (detect %u, load %u, upload %u, present %u)",
+							it->mFilename.c_str(), it->getMsec(HotReloadPhase::TOTAL),
+							it->getMsec(HotReloadPhase::DETECT), it->getMsec(HotReloadPhase::LOAD),
+							it->getMsec(HotReloadPhase::UPLOAD), it->getMsec(HotReloadPhase::PRESENT));
+				}
+				ImGui::TreePop();
+			}
+		}
+
 		void addFileChangeMonitoringToMenu(const FileChangeMonitoring& fcm)
 		{
-			if (ImGui::TreeNode("sorted by watch id")) {
+			fcm.lock();
+			IntentText("dropped (content not changed): %u", fcm.getUnchangedContentCount());
+			fcm.unlock();
+			if (ImGui::TreeNode("by watch id")) {
 				fcm.lock();
 				char strId[32];
 				for (const auto& it : fcm.getFilesByWatchId()) {
@@ -616,7 +760,7 @@ namespace gs
 				fcm.unlock();
 				ImGui::TreePop();
 			}
-			if (ImGui::TreeNode("sorted by watch dir")) {
+			if (ImGui::TreeNode("by watch dir")) {
 				fcm.lock();
 				char strId[32];
 				unsigned int i = 0;
@@ -652,7 +796,7 @@ namespace gs
 				fcm.unlock();
 				ImGui::TreePop();
 			}
-			if (ImGui::TreeNode("sorted by filename")) {
+			if (ImGui::TreeNode("by filename")) {
 				fcm.lock();
 				for (const auto& it : fcm.getFilesByName()) {
 					const FileChangeMonitoring::Filename* fn =
@@ -685,15 +829,16 @@ namespace gs
 				fcm.unlock();
 				ImGui::TreePop();
 			}
-			if (ImGui::TreeNode("sorted by callback id")) {
+			if (ImGui::TreeNode("by callback id")) {
 				fcm.lock();
 				for (const auto& it : fcm.getFilesByCallbackId()) {
 					const FileChangeMonitoring::Callback* cb =
 							it.second.mFileEntry->getCallbackForFile(it.second.mBasename, it.first);
 					if (cb) {
-						IntentText("cb id: %u, %s, watch id: %ld, reload: %u",
+						IntentText("cb id: %u, %s, watch id: %ld, reload: %u, settle: %u ms%s",
 								it.first, cb->mOrigFilename.c_str(),
-								long(it.second.mFileEntry->getWatchId()), cb->mCallCount);
+								long(it.second.mFileEntry->getWatchId()), cb->mCallCount,
+								cb->mSettleMsec, cb->mCheckContent ? ", content check" : "");
 					}
 					else {
 						IntentText("cb id: %u, basename: %s (callback not found!)", it.first, it.second.mBasename.c_str());
@@ -762,20 +907,37 @@ namespace gs
 			snprintf(tmpLabel, 64, "resources - count: %u", rm.getResourceCount());
 			if (ImGui::CollapsingHeaderEx("resources", tmpLabel))
 			{
-				const ResourceManager::TResByIdNumberMap& resMap = rm.getResourceMapByIdNumber();
-				for (const auto& it : resMap) {
-					switch (it.second->getType()) {
+				const RenderTargetPool& pool = *rm.getRenderTargetPool();
+				IntentText("render target pool - unused: %u, created: %u, reused: %u",
+						pool.getUnusedCount(), pool.getCreatedCount(), pool.getReusedCount());
+				IntentText("texture decoder - threads: %u, queued: %u, loading textures: %u",
+						rm.getTextureDecoder().getThreadCount(), rm.getTextureDecoder().getQueuedCount(),
+						rm.getLoadingTextureCount());
+				if (rm.getTextureCache()) {
+					const TextureCache& cache = *rm.getTextureCache();
+					IntentText("texture cache - %s, hits: %u, misses: %u",
+							cache.getDirectory().c_str(), cache.getHitCount(), cache.getMissCount());
+				}
+				const ResourceManager::TResVector& resources = rm.getResources();
+				for (const auto& res : resources) {
+					if (!res) {
+						continue; // unused id number
+					}
+					switch (res->getType()) {
 						case ResType::TEXTURE:
-							addTextureResToMenu(*static_cast<Texture*>(it.second.get()));
+							addTextureResToMenu(*static_cast<Texture*>(res.get()));
 							break;
 						case ResType::SHADER_PROGRAM:
-							addShaderProgResToMenu(*static_cast<ShaderProgram*>(it.second.get()));
+							addShaderProgResToMenu(*static_cast<ShaderProgram*>(res.get()));
 							break;
 						case ResType::MESH:
-							addMeshResToMenu(*static_cast<Mesh*>(it.second.get()));
+							addMeshResToMenu(*static_cast<Mesh*>(res.get()));
 							break;
 						case ResType::FRAMEBUFFER:
-							addFramebufferResToMenu(*static_cast<Framebuffer*>(it.second.get()));
+							addFramebufferResToMenu(*static_cast<Framebuffer*>(res.get()));
+							break;
+						case ResType::TEXTURE_ATLAS:
+							addTextureAtlasResToMenu(*static_cast<TextureAtlas*>(res.get()));
 							break;
 					}
 				}
@@ -820,12 +982,33 @@ namespace gs
 						IntentText("camera: %s", p.mCamera ? "is used" : "not used");
 						IntentText("scene-id (number): %u", p.mSceneId);
 						IntentText("depth-test: %s", p.mDepthTest ? "true" : "false");
+						if (p.isProgressive()) {
+							IntentText("progressive: tile %u of %u (%ux%u tiles, %u per frame), completed images: %u, preview: %s",
+									p.mNextTile, p.getTileCount(), p.mTileCols, p.mTileRows,
+									p.mTilesPerFrame, p.mCompletedImageCount,
+									p.mProgressivePreview ? "partial" : "complete");
+						}
+						const std::vector<RenderCounters>& passStat =
+								getRenderStatistic().getPassCounters();
+						if (i < passStat.size() && ImGui::TreeNode("statistic:"))
+						{
+							addRenderCountersToMenu(passStat[i]);
+							ImGui::TreePop();
+						}
 						ImGui::TreePop();
 					}
 					++i;
 				}
 			}
 
+			const RenderStatistic& rs = getRenderStatistic();
+			snprintf(tmpLabel, 64, "statistic - draw calls: %u",
+					rs.getFrameCounters().mDrawCalls);
+			if (ImGui::CollapsingHeaderEx("statistic", tmpLabel))
+			{
+				addRenderStatisticToMenu(rs);
+			}
+
 			fcm.lock();
 			snprintf(tmpLabel, 64, "hot reloading - file change monitoring - reload: %u",
 					fcm.getCallCount());
@@ -835,6 +1018,14 @@ namespace gs
 				addFileChangeMonitoringToMenu(fcm);
 			}
 
+			const HotReloadStatistic& hrs = getHotReloadStatistic();
+			snprintf(tmpLabel, 64, "hot reloading - latency: %u ms",
+					hrs.getHistory().empty() ? 0 : hrs.getHistory().back().getMsec(HotReloadPhase::TOTAL));
+			if (ImGui::CollapsingHeaderEx("hot_reload_latency", tmpLabel))
+			{
+				addHotReloadLatencyToMenu(hrs);
+			}
+
 			ImGui::End();
 		}
 
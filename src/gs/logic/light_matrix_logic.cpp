@@ -25,17 +25,21 @@ void gs::LightMatrixLogic::handleEvent(const std::shared_ptr<Entity>& e, Resourc
 void gs::LightMatrixLogic::update(const std::shared_ptr<Entity>& e, ResourceManager& rm,
 		const Properties& p)
 {
-	std::shared_ptr<gs::ShaderProgram> shader = rm.getShaderProgramByIdName(mShaderIdName);
+	// lookup of the shader and the uniform only once (not for each frame)
+	std::shared_ptr<gs::ShaderProgram> shader = mShader.lock();
 	if (!shader) {
-		LOGE("failed\n");
-		return;
+		shader = rm.getShaderProgramByIdName(mShaderIdName);
+		if (!shader) {
+			LOGE("failed\n");
+			return;
+		}
+		mShader = shader;
+		mModelMatrixHandle = shader->getUniformHandle("uLightModelMatrix" + std::to_string(mLightNr));
 	}
-	std::string nr = std::to_string(mLightNr);
 
-	bool model = shader->changeUniformMat4("uLightModelMatrix" + nr, p.mModelMatrix);
+	bool model = shader->changeUniformMat4(mModelMatrixHandle, p.mModelMatrix);
 	if (!model && !mWarningIsPrinted) {
 		LOGW("No uLightModelMatrix%u exist!\n", mLightNr);
 		mWarningIsPrinted = true;
 	}
 }
-
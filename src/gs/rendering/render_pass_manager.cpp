@@ -2,6 +2,7 @@
 #include <gs/rendering/gl_api.h>
 #include <gs/rendering/properties.h>
 #include <gs/rendering/renderer.h>
+#include <gs/rendering/render_statistic.h>
 #include <gs/res/resource_manager.h>
 #include <gs/res/framebuffer.h>
 #include <gs/scene/scene_manager.h>
@@ -11,6 +12,87 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+namespace gs
+{
+	namespace
+	{
+		bool isInvalidateFramebufferSupported()
+		{
+#ifdef GLSLSCENE_USE_GLEW
+			return GLEW_VERSION_4_3 || GLEW_ARB_invalidate_subdata;
+#else
+			return false;
+#endif
+		}
+
+		/**
+		 * Tell the driver that the content of the attachments is not needed.
+		 * @param fb Null for the default framebuffer.
+		 */
+		void invalidateAttachments(const Framebuffer* fb, bool color, bool depth)
+		{
+			if (!isInvalidateFramebufferSupported()) {
+				return;
+			}
+			GLenum attachments[FramebufferFormat::MAX_COLOR_ATTACHMENTS + 2];
+			GLsizei count = 0;
+			if (!fb) {
+				if (color) {
+					attachments[count++] = GL_COLOR;
+				}
+				if (depth) {
+					attachments[count++] = GL_DEPTH;
+					attachments[count++] = GL_STENCIL;
+				}
+			}
+			else {
+				if (color) {
+					unsigned int colorCount = fb->getColorAttachmentCount();
+					for (unsigned int i = 0; i < colorCount; ++i) {
+						attachments[count++] = GL_COLOR_ATTACHMENT0 + i;
+					}
+				}
+				if (depth && fb->hasDepth()) {
+					attachments[count++] = GL_DEPTH_ATTACHMENT;
+				}
+			}
+			if (count) {
+				glInvalidateFramebuffer(GL_FRAMEBUFFER, count, attachments);
+			}
+		}
+
+		/**
+		 * Clear the color and depth buffer depending on the load actions.
+		 * glClear() respects the scissor box.
+		 */
+		void clearForLoadActions(const RenderPass& pass, const Framebuffer* fb,
+				bool allowInvalidate)
+		{
+			GLbitfield clearMask = 0;
+			if (pass.mColorLoad == LoadAction::CLEAR && (!fb || fb->getColorAttachmentCount())) {
+				glClearColor(pass.mClearColor.r, pass.mClearColor.g, pass.mClearColor.b, pass.mClearColor.a);
+				clearMask |= GL_COLOR_BUFFER_BIT;
+			}
+			if (pass.mDepthLoad == LoadAction::CLEAR) {
+				if (!fb) {
+					clearMask |= GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
+				}
+				else if (fb->hasDepth()) {
+					clearMask |= GL_DEPTH_BUFFER_BIT;
+				}
+			}
+			if (clearMask) {
+				glClear(clearMask);
+			}
+			if (allowInvalidate && (pass.mColorLoad == LoadAction::DONT_CARE ||
+					pass.mDepthLoad == LoadAction::DONT_CARE)) {
+				invalidateAttachments(fb, pass.mColorLoad == LoadAction::DONT_CARE,
+						pass.mDepthLoad == LoadAction::DONT_CARE);
+			}
+		}
+	}
+}
+
 gs::RenderPassManager::RenderPassManager()
 {
 }
@@ -53,20 +135,46 @@ void gs::RenderPassManager::renderAllPasses(Renderer &renderer,
 		RenderPass& pass = mPasses[i];
 
 		Size2u resolution;
+		std::shared_ptr<Framebuffer> fb;
+		++renderCounters().mFramebufferSwitches;
 		if (!pass.mFramebufferId) {
 			glBindFramebuffer(GL_FRAMEBUFFER, 0);
 			glViewport(0, 0, p.mWindowSizeI.mWidth, p.mWindowSizeI.mHeight);
 			resolution = Size2u(p.mWindowSizeI.mWidth, p.mWindowSizeI.mHeight);
 		}
 		else {
-			std::shared_ptr<Framebuffer> fb = rm.getFramebufferByIdNumber(pass.mFramebufferId);
+			fb = rm.getFramebufferByIdNumber(pass.mFramebufferId);
 			if (!fb) {
 				LOGE("Can't find frame buffer!\n");
+				getRenderStatistic().endPass();
 				continue;
 			}
-			fb->bind(p.mWindowSizeI.mWidth, p.mWindowSizeI.mHeight); // also set the viewport!!!
+			fb->updateResolutionScale(p.mDeltaTimeSec, p.mTsMsec);
+			fb->bind(p.mWindowSizeI.mWidth, p.mWindowSizeI.mHeight, p.mTsMsec); // also set the viewport!!!
 			resolution = Size2u(fb->getWidth(), fb->getHeight());
 		}
+
+		bool progressive = fb && pass.isProgressive();
+		unsigned int tileCount = 1;
+		p.mTsMsec = properties.mTsMsec;
+		p.mTsSec = properties.mTsSec;
+		if (progressive) {
+			fb->setPresentBufferEnabled(!pass.mProgressivePreview);
+			if (resolution != pass.mResolution || pass.mNextTile >= pass.getTileCount()) {
+				// size is changed --> start a new image
+				pass.mNextTile = 0;
+			}
+			if (pass.mNextTile == 0) {
+				pass.mImageTsMsec = p.mTsMsec;
+				pass.mImageTsSec = p.mTsSec;
+			}
+			p.mTsMsec = pass.mImageTsMsec;
+			p.mTsSec = pass.mImageTsSec;
+			tileCount = pass.getTileCount() - pass.mNextTile;
+			if (tileCount > pass.mTilesPerFrame) {
+				tileCount = pass.mTilesPerFrame;
+			}
+		}
 		pass.mResolution = resolution;
 		p.mViewportPosPixelI = Vector2i(0, 0);
 		p.mViewportSizePixelU = resolution;
@@ -76,18 +184,10 @@ void gs::RenderPassManager::renderAllPasses(Renderer &renderer,
 		//mProperties.mViewSize = Size2f(static_cast<float>(width), static_cast<float>(height));
 		//mProperties.mViewRatio = Size2f(float(width) / float(height), 1.0f);
 
-		glClearColor(pass.mClearColor.r, pass.mClearColor.g, pass.mClearColor.b, pass.mClearColor.a);
-
-		if (!pass.mFramebufferId) {
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-		}
-		else {
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		}
-
 		std::shared_ptr<Scene> scene = sm.getSceneByIdNumber(pass.mSceneId);
 		if (!scene) {
 			LOGE("Can't find scene for rendering!\n");
+			getRenderStatistic().endPass();
 			continue;
 		}
 
@@ -115,16 +215,53 @@ void gs::RenderPassManager::renderAllPasses(Renderer &renderer,
 		if (pass.mDepthTest) {
 			glEnable(GL_DEPTH_TEST);
 		}
+		if (progressive) {
+			glEnable(GL_SCISSOR_TEST);
+		}
 
-		renderer.render(scene->getRootOe(), rm, p);
+		for (unsigned int t = 0; t < tileCount; ++t) {
+			if (progressive) {
+				// glClear() and the rendering is only done inside of the tile
+				unsigned int col = pass.mNextTile % pass.mTileCols;
+				unsigned int row = pass.mNextTile / pass.mTileCols;
+				unsigned int x0 = col * resolution.mWidth / pass.mTileCols;
+				unsigned int x1 = (col + 1) * resolution.mWidth / pass.mTileCols;
+				unsigned int y0 = row * resolution.mHeight / pass.mTileRows;
+				unsigned int y1 = (row + 1) * resolution.mHeight / pass.mTileRows;
+				glScissor(x0, y0, x1 - x0, y1 - y0);
+				++pass.mNextTile;
+			}
+			// no invalidation for progressive rendering. This would also
+			// invalidate the already rendered tiles.
+			clearForLoadActions(pass, fb.get(), !progressive);
 
+			renderer.render(scene->getRootOe(), rm, p);
+		}
+
+		if (progressive) {
+			glDisable(GL_SCISSOR_TEST);
+		}
 		if (pass.mDepthTest) {
 			glDisable(GL_DEPTH_TEST);
 		}
 
+		if (fb) {
+			bool isImageComplete = !progressive || pass.mNextTile >= pass.getTileCount();
+			if (progressive && isImageComplete) {
+				++pass.mCompletedImageCount;
+				fb->presentWork();
+			}
+			// with a present buffer the mipmaps are only necessary for a new image
+			if (isImageComplete || !fb->isPresentBufferEnabled()) {
+				fb->generateMipmaps();
+			}
+		}
+
 		renderer.getTextureUnitStack().bindForRendering();
 		renderer.getShaderStack().bindForRendering();
 		renderer.switchToTextureUnitForLoading();
+
+		getRenderStatistic().endPass();
 	}
 }
 
@@ -0,0 +1,118 @@
+#include <gs/rendering/render_statistic.h>
+#include <gs/system/log.h>
+#include <sstream>
+#include <fstream>
+
+namespace gs
+{
+	namespace
+	{
+		RenderStatistic renderStatistic;
+
+		void addCountersAsTml(std::stringstream& s, const RenderCounters& c)
+		{
+			s << "\t\tdraw-calls = " << c.mDrawCalls << "\n";
+			s << "\t\tvertices = " << c.mVertices << "\n";
+			s << "\t\tprogram-binds = " << c.mProgramBinds << "\n";
+			s << "\t\ttexture-binds = " << c.mTextureBinds << "\n";
+			s << "\t\tvao-binds = " << c.mVaoBinds << "\n";
+			s << "\t\tvbo-binds = " << c.mVboBinds << "\n";
+			s << "\t\tuniform-uploads = " << c.mUniformUploads << "\n";
+			s << "\t\tbuffer-upload-bytes = " << c.mBufferUploadBytes << "\n";
+			s << "\t\tframebuffer-switches = " << c.mFramebufferSwitches << "\n";
+		}
+	}
+}
+
+gs::RenderCounters& gs::RenderCounters::operator+=(const RenderCounters& c)
+{
+	mDrawCalls += c.mDrawCalls;
+	mVertices += c.mVertices;
+	mProgramBinds += c.mProgramBinds;
+	mTextureBinds += c.mTextureBinds;
+	mVaoBinds += c.mVaoBinds;
+	mVboBinds += c.mVboBinds;
+	mUniformUploads += c.mUniformUploads;
+	mBufferUploadBytes += c.mBufferUploadBytes;
+	mFramebufferSwitches += c.mFramebufferSwitches;
+	return *this;
+}
+
+std::string gs::RenderCounters::toString() const
+{
+	std::stringstream s;
+	s << "draw calls: " << mDrawCalls <<
+			", vertices: " << mVertices <<
+			", program binds: " << mProgramBinds <<
+			", texture binds: " << mTextureBinds <<
+			", vao binds: " << mVaoBinds <<
+			", vbo binds: " << mVboBinds <<
+			", uniform uploads: " << mUniformUploads <<
+			", buffer uploads: " << mBufferUploadBytes << " bytes" <<
+			", framebuffer switches: " << mFramebufferSwitches;
+	return s.str();
+}
+
+gs::RenderStatistic::RenderStatistic()
+		:mCurrent(), mCurrentFrame(), mCurrentPasses(),
+		mFrame(), mPasses(), mFrameNumber(0)
+{
+}
+
+gs::RenderStatistic::~RenderStatistic()
+{
+}
+
+void gs::RenderStatistic::endPass()
+{
+	mCurrentPasses.push_back(mCurrent);
+	mCurrentFrame += mCurrent;
+	mCurrent.reset();
+}
+
+void gs::RenderStatistic::endFrame()
+{
+	// counters after the last pass (e.g. GUI) are only added to the frame
+	mCurrentFrame += mCurrent;
+	mCurrent.reset();
+
+	mFrame = mCurrentFrame;
+	mCurrentFrame.reset();
+	// swap instead of copy --> no new allocation for the next frame
+	mPasses.swap(mCurrentPasses);
+	mCurrentPasses.clear();
+	++mFrameNumber;
+}
+
+std::string gs::RenderStatistic::toTmlString() const
+{
+	std::stringstream s;
+	s << "render-statistic\n";
+	s << "\tframe = " << mFrameNumber << "\n";
+	s << "\tpass-count = " << mPasses.size() << "\n";
+	s << "\ttotal\n";
+	addCountersAsTml(s, mFrame);
+	size_t passCount = mPasses.size();
+	for (size_t i = 0; i < passCount; ++i) {
+		s << "\tpass\n";
+		s << "\t\tindex = " << i << "\n";
+		addCountersAsTml(s, mPasses[i]);
+	}
+	return s.str();
+}
+
+bool gs::RenderStatistic::writeToFile(const std::string& filename) const
+{
+	std::ofstream f(filename);
+	if (!f.is_open()) {
+		LOGE("Can't open '%s' for writing the render statistic\n", filename.c_str());
+		return false;
+	}
+	f << toTmlString();
+	return f.good();
+}
+
+gs::RenderStatistic& gs::getRenderStatistic()
+{
+	return renderStatistic;
+}
@@ -75,14 +75,15 @@ void gs::Renderer::renderEntity(const std::shared_ptr<Entity>& e, const Resource
 	unsigned int texUnitPushedFlags = 0;
 	if (tc) {
 		const TTextureId* tids = tc->getTextureIds();
+		const unsigned int* fbAttachments = tc->getFramebufferAttachments();
 		unsigned int usedFlags = tc->getUsedFlags();
 		for (int i = 0; i < TextureComponent::MAX_TEXTURE_UNITS; ++i) {
 			if (usedFlags & lookUpSet[i]) {
 				TTextureId tid = tids[i];
 				if (tid) {
-					std::shared_ptr<Texture> tex = rm.getTextureByIdNumber(tid);
+					Texture* tex = rm.getTexturePtrByIdNumber(tid, fbAttachments[i]);
 					if (tex) {
-						mTextureStack.pushTexture(tex.get(), i);
+						mTextureStack.pushTexture(tex, i);
 						texUnitPushedFlags |= lookUpSet[i];
 					}
 				}
@@ -102,9 +103,9 @@ void gs::Renderer::renderEntity(const std::shared_ptr<Entity>& e, const Resource
 	if (sc) {
 		TShaderId sid = sc->getShaderProgramId();
 		if (sid) {
-			std::shared_ptr<ShaderProgram> shader = rm.getShaderProgramByIdNumber(sid);
+			ShaderProgram* shader = rm.getShaderProgramPtrByIdNumber(sid);
 			if (shader) {
-				mShaderStack.pushShaderProgram(shader.get());
+				mShaderStack.pushShaderProgram(shader);
 				shaderPushed = true;
 			}
 		}
@@ -115,7 +116,7 @@ void gs::Renderer::renderEntity(const std::shared_ptr<Entity>& e, const Resource
 	}
 
 	if (e->getConstMesh()) {
-		std::shared_ptr<Mesh> m = rm.getMeshByIdNumber(e->getConstMesh()->getGraphicId());
+		Mesh* m = rm.getMeshPtrByIdNumber(e->getConstMesh()->getGraphicId());
 		if (m) {
 			mTextureStack.bindForRendering();
 			mShaderStack.bindForRendering();
@@ -0,0 +1,86 @@
+#include <gs/rendering/resolution_scale.h>
+#include <math.h>
+
+constexpr float gs::ResolutionScale::SCALE_STEP;
+
+gs::ResolutionScale::ResolutionScale()
+		:mScale(1.0f), mIsDynamic(false), mIsScaled(false), mTargetFrameTimeMsec(0.0f),
+		mMinScale(1.0f), mMaxScale(1.0f), mAvgFrameTimeMsec(0.0f),
+		mHasTs(false), mLastTsMsec(0), mLastAdjustTsMsec(0)
+{
+}
+
+gs::ResolutionScale::~ResolutionScale()
+{
+}
+
+void gs::ResolutionScale::setFixed(float scale)
+{
+	mScale = scale;
+	mIsDynamic = false;
+	// the scale is read from the config --> can be e.g. 0.9999
+	mIsScaled = fabsf(scale - 1.0f) > SCALE_STEP * 0.01f;
+	mMinScale = scale;
+	mMaxScale = scale;
+}
+
+void gs::ResolutionScale::setDynamic(float targetFrameTimeMsec,
+		float minScale, float maxScale)
+{
+	mIsDynamic = true;
+	mIsScaled = true;
+	mTargetFrameTimeMsec = targetFrameTimeMsec;
+	mMinScale = minScale;
+	mMaxScale = maxScale;
+	// start with the best quality
+	mScale = maxScale;
+	mAvgFrameTimeMsec = targetFrameTimeMsec;
+	mHasTs = false;
+}
+
+bool gs::ResolutionScale::update(float deltaTimeSec, uint32_t tsMsec)
+{
+	if (!mIsDynamic) {
+		return false;
+	}
+	if (!mHasTs) {
+		mHasTs = true;
+		mLastTsMsec = tsMsec;
+		mLastAdjustTsMsec = tsMsec;
+		return false;
+	}
+	if (tsMsec == mLastTsMsec) {
+		return false; // already updated for this frame
+	}
+	mLastTsMsec = tsMsec;
+
+	// exponential moving average --> a single slow frame has not a big effect
+	mAvgFrameTimeMsec = mAvgFrameTimeMsec * 0.9f + deltaTimeSec * 1000.0f * 0.1f;
+
+	if (tsMsec - mLastAdjustTsMsec < ADJUST_INTERVAL_MSEC) {
+		return false;
+	}
+	mLastAdjustTsMsec = tsMsec;
+
+	float scale = mScale;
+	if (mAvgFrameTimeMsec > mTargetFrameTimeMsec * 1.05f) {
+		scale -= SCALE_STEP;
+	}
+	else if (mAvgFrameTimeMsec < mTargetFrameTimeMsec * 0.8f) {
+		// increase only if there is enough headroom. Otherwise the scale
+		// would oscillate between two steps.
+		scale += SCALE_STEP;
+	}
+	if (scale < mMinScale) {
+		scale = mMinScale;
+	}
+	if (scale > mMaxScale) {
+		scale = mMaxScale;
+	}
+	// the scale is only changed in steps (or clamped)
+	if (fabsf(scale - mScale) < SCALE_STEP * 0.01f) {
+		return false;
+	}
+	mScale = scale;
+	return true;
+}
@@ -2,20 +2,31 @@
 #include <gs/rendering/gl_api.h>
 #include <gs/res/shader_program.h>
 
-#include <gs/system/log.h>
+#include <gs/rendering/render_statistic.h>
 
-#ifdef ENABLE_SHADER_STACK_STATISTIC
-#define INCREASE_BIND_CALLS_COUNT \
-	++mStat.mBindCalls; \
+#include <gs/system/log.h>
 
-#else
-#define INCREASE_BIND_CALLS_COUNT
-#endif
+namespace gs
+{
+	namespace
+	{
+		// unique for all shader stacks (a program can be used by many renderers)
+		unsigned int nextPassSerial()
+		{
+			static unsigned int serial = 0;
+			++serial;
+			if (!serial) {
+				++serial; // 0 is reserved for "unknown"
+			}
+			return serial;
+		}
+	}
+}
 
 gs::ShaderStack::ShaderStack()
 		:mLayers{}, mNextLayerIndex(0),
 		mCurrentBindedShader(nullptr), mShaderToBind(nullptr),
-		mProperties()
+		mProperties(), mPassSerial(0)
 {
 }
 
@@ -28,12 +39,15 @@ void gs::ShaderStack::resetStack()
 	mNextLayerIndex = 0;
 	mCurrentBindedShader = nullptr;
 	mShaderToBind = nullptr;
+	++renderCounters().mProgramBinds;
 	glUseProgram(0);
 }
 
 void gs::ShaderStack::setGlobalProperties(const Properties& p)
 {
 	mProperties = p;
+	// the per pass uniforms of the shader programs are uploaded again
+	mPassSerial = nextPassSerial();
 }
 
 void gs::ShaderStack::pushShaderProgram(ShaderProgram* shader)
@@ -54,12 +68,11 @@ void gs::ShaderStack::pushShaderProgram(ShaderProgram* shader)
 	if (mCurrentBindedShader != shader) {
 		bindShaderProgram(shader);
 		mCurrentBindedShader = shader;
-		INCREASE_BIND_CALLS_COUNT
 	}
 	else if (mCurrentBindedShader) {
 		// If correct shader is already binded then maybe the matrices has changed
 		// If a shader is current binded --> rebind matrices
-		mCurrentBindedShader->bindMatricesOnly(mMatrices);
+		mCurrentBindedShader->bindMatricesOnly(mProperties, mMatrices);
 	}
 #endif
 }
@@ -91,7 +104,6 @@ void gs::ShaderStack::popShaderProgram()
 	if (mCurrentBindedShader != shader) {
 		bindShaderProgram(shader);
 		mCurrentBindedShader = shader;
-		INCREASE_BIND_CALLS_COUNT
 	}
 #endif
 }
@@ -101,14 +113,14 @@ void gs::ShaderStack::bindForRendering()
 	if (mCurrentBindedShader != mShaderToBind) {
 		bindShaderProgram(mShaderToBind);
 		mCurrentBindedShader = mShaderToBind;
-		INCREASE_BIND_CALLS_COUNT
 	}
 }
 
 void gs::ShaderStack::bindShaderProgram(ShaderProgram* shaderProgram)
 {
+	++renderCounters().mProgramBinds;
 	if (shaderProgram) {
-		shaderProgram->bind(mProperties, mMatrices);
+		shaderProgram->bind(mProperties, mMatrices, mPassSerial);
 	}
 	else {
 		glUseProgram(0);
@@ -126,7 +138,7 @@ void gs::ShaderStack::setMatrices(const gs::Matrices &m)
 			// currently there is no shader used!
 			return;
 		}
-		mCurrentBindedShader->bindMatricesOnly(m);
+		mCurrentBindedShader->bindMatricesOnly(mProperties, m);
 	}
 }
 
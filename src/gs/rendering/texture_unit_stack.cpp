@@ -1,19 +1,11 @@
 #include <gs/rendering/texture_unit_stack.h>
 #include <gs/rendering/gl_api.h>
+#include <gs/rendering/render_statistic.h>
 
 #include <gs/res/texture.h>
 #include <gs/system/log.h>
 #include <gs/common/lookup8.h>
 
-#ifdef ENABLE_TEXTURE_UNIT_STACK_STATISTIC
-#define INCREASE_BIND_CALLS_COUNT \
-	++unit.mStat.mBindCalls; \
-	++mStat.mBindCalls; \
-
-#else
-#define INCREASE_BIND_CALLS_COUNT
-#endif
-
 #define SWITCH_TO_TEXTURE_UNIT(texUnitIndex) \
 	if (mCurrentActiveTextureUnit != texUnitIndex) { \
 		mCurrentActiveTextureUnit = texUnitIndex; \
@@ -77,7 +69,6 @@ void gs::TextureUnitStack::pushTexture(Texture* tex, unsigned int textureUnit)
 	if (unit.mCurrentBindedTexture != tex) {
 		bindTexture(tex, textureUnit);
 		unit.mCurrentBindedTexture = tex;
-		INCREASE_BIND_CALLS_COUNT
 	}
 	// set bit to false --> reset bit
 	mMustBeBinded &= lookUpReset[textureUnit];
@@ -120,7 +111,6 @@ void gs::TextureUnitStack::popTexture(unsigned int textureUnit)
 	if (unit.mCurrentBindedTexture != tex) {
 		bindTexture(tex, textureUnit);
 		unit.mCurrentBindedTexture = tex;
-		INCREASE_BIND_CALLS_COUNT
 	}
 	// set bit to false --> reset bit
 	mMustBeBinded &= lookUpReset[textureUnit];
@@ -140,7 +130,6 @@ void gs::TextureUnitStack::bindForRendering()
 		TextureUnit& unit = mUnits[0];
 		bindTexture(unit.mTextureToBind, 0);
 		unit.mCurrentBindedTexture = unit.mTextureToBind;
-		INCREASE_BIND_CALLS_COUNT
 		if (mustBeBinded == 1) {
 			return;
 		}
@@ -151,7 +140,6 @@ void gs::TextureUnitStack::bindForRendering()
 			TextureUnit& unit = mUnits[i];
 			bindTexture(unit.mTextureToBind, i);
 			unit.mCurrentBindedTexture = unit.mTextureToBind;
-			INCREASE_BIND_CALLS_COUNT
 			if (!(mustBeBinded & lookUpInvertLimit[i])) {
 				return;
 			}
@@ -169,32 +157,11 @@ void gs::TextureUnitStack::switchToTextureUnit(unsigned int textureUnit)
 	SWITCH_TO_TEXTURE_UNIT(textureUnit)
 }
 
-void gs::TextureUnitStack::resetStatistic()
-{
-#ifdef ENABLE_TEXTURE_UNIT_STACK_STATISTIC
-	for (int i = 0; i < MAX_UNITS; ++i) {
-		mUnits[i].mStat.reset();
-	}
-	mStat.reset();
-#endif
-}
-
-void gs::TextureUnitStack::printStatistic()
-{
-#ifdef ENABLE_TEXTURE_UNIT_STACK_STATISTIC
-	std::stringstream s;
-	s << mStat.mBindCalls << ": ";
-	for (int i = 0; i < MAX_UNITS; ++i) {
-		s << " " << mUnits[i].mStat.mBindCalls;
-	}
-	LOGI("%s\n", s.str().c_str());
-#endif
-}
-
 void gs::TextureUnitStack::bindTexture(Texture* tex, unsigned int textureUnit)
 {
 	SWITCH_TO_TEXTURE_UNIT(textureUnit)
 
+	++renderCounters().mTextureBinds;
 	if (tex) {
 		// texture used
 		GLuint texId = tex->getGlTexId();
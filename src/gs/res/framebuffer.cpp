@@ -1,28 +1,60 @@
 #include <gs/res/framebuffer.h>
 #include <gs/res/texture.h>
-#include <gs/common/color.h>
+#include <gs/res/render_target_pool.h>
 #include <gs/system/log.h>
 
-gs::Framebuffer::Framebuffer(int width, int height)
+namespace gs
+{
+	namespace
+	{
+		unsigned int scaleSize(unsigned int size, float scale)
+		{
+			unsigned int s = static_cast<unsigned int>(float(size) * scale + 0.5f);
+			return s ? s : 1;
+		}
+	}
+}
+
+gs::Framebuffer::Framebuffer(int width, int height,
+		const FramebufferFormat& format,
+		const ResolutionScale& resolutionScale,
+		const std::shared_ptr<RenderTargetPool>& pool)
 		:Resource(std::weak_ptr<FileChangeMonitoring>()),
 		mUseWindowWidth(true),
 		mUseWindowHeight(true),
+		mBaseWidth(1),
+		mBaseHeight(1),
 		mWidth(1),
 		mHeight(1),
+		mFormat(format),
+		mResolutionScale(resolutionScale),
+		mIsBound(false),
+		mResizePending(false),
+		mPendingWidth(0),
+		mPendingHeight(0),
+		mPendingSinceMsec(0),
+		mPool(pool),
 		mFbo(0),
-		//mTex(0),
-		mTexRes(),
+		mColorTexRes(),
+		mUsePresentBuffer(false),
+		mPresentColorTexRes(),
+		mDepthTexRes(),
 		mRbo(0)
 {
 	if (width >= 0) {
 		mUseWindowWidth = false;
-		mWidth = width;
+		mBaseWidth = width;
 	}
 	if (height >= 0) {
 		mUseWindowHeight = false;
-		mHeight = height;
+		mBaseHeight = height;
+	}
+	mWidth = scaleSize(mBaseWidth, mResolutionScale.getScale());
+	mHeight = scaleSize(mBaseHeight, mResolutionScale.getScale());
+	if (mFormat.mColorFormats.size() > FramebufferFormat::MAX_COLOR_ATTACHMENTS) {
+		LOGW("Only %d color attachments are supported\n", FramebufferFormat::MAX_COLOR_ATTACHMENTS);
+		mFormat.mColorFormats.resize(FramebufferFormat::MAX_COLOR_ATTACHMENTS);
 	}
-	createFramebuffer();
 }
 
 gs::Framebuffer::~Framebuffer()
@@ -30,82 +62,172 @@ gs::Framebuffer::~Framebuffer()
 	deleteFramebuffer();
 }
 
-void gs::Framebuffer::bind(int windowWidth, int windowHeight)
+bool gs::Framebuffer::load()
+{
+	if (mFbo) {
+		return true;
+	}
+	return createFramebuffer();
+}
+
+void gs::Framebuffer::bind(int windowWidth, int windowHeight, uint32_t tsMsec)
 {
-	bool recreate = false;
-	if (mUseWindowWidth && windowWidth != mWidth) {
-		mWidth = windowWidth;
-		recreate = true;
+	if (mUseWindowWidth) {
+		mBaseWidth = windowWidth;
+	}
+	if (mUseWindowHeight) {
+		mBaseHeight = windowHeight;
 	}
-	if (mUseWindowHeight && windowHeight != mHeight) {
-		mHeight = windowHeight;
-		recreate = true;
+	float scale = mResolutionScale.getScale();
+	unsigned int w = scaleSize(mBaseWidth, scale);
+	unsigned int h = scaleSize(mBaseHeight, scale);
+	if (w != mWidth || h != mHeight) {
+		if (!mResizePending || w != mPendingWidth || h != mPendingHeight) {
+			// new size --> wait until the size is stable
+			mResizePending = true;
+			mPendingWidth = w;
+			mPendingHeight = h;
+			mPendingSinceMsec = tsMsec;
+		}
+		// the first size is used immediately (no old content exist)
+		if (!mIsBound || tsMsec - mPendingSinceMsec >= RESIZE_SETTLE_MSEC) {
+			mWidth = w;
+			mHeight = h;
+			mResizePending = false;
+			recreateFramebuffer();
+		}
 	}
-	if (recreate) {
-		recreateFramebuffer();
+	else {
+		// e.g. resized back to the current size
+		mResizePending = false;
 	}
+	mIsBound = true;
 
 	// Render to our framebuffer
 	glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
 	glViewport(0, 0, mWidth, mHeight); // Render on the whole framebuffer, complete from the lower left corner to the upper right
 }
 
-bool gs::Framebuffer::createFramebuffer()
+std::shared_ptr<gs::Texture> gs::Framebuffer::getTexRes(unsigned int attachment) const
 {
-	// The framebuffer, which regroups 0, 1, or more textures, and 0 or 1 depth buffer.
-	glGenFramebuffers(1, &mFbo);
-	glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
-
-	mTexRes = std::make_shared<Texture>(std::weak_ptr<FileChangeMonitoring>(), "",
-			TexMipmap::NO_MIPMAP, TexFilter::NEAREST, TexFilter::NEAREST);
-	mTexRes->create(mWidth, mHeight, ColorU32::white());
-	mTexRes->load();
-
-#if 1
-	// The depth buffer
-	glGenRenderbuffers(1, &mRbo);
-	glBindRenderbuffer(GL_RENDERBUFFER, mRbo);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, mWidth, mHeight);
-	//glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, mWidth, mHeight);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, mRbo);
-#endif
-
-	// Set "renderedTexture" as our colour attachement #0
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mTexRes->getGlTexId(), 0);
+	if (attachment == DEPTH_ATTACHMENT) {
+		return mDepthTexRes;
+	}
+	if (attachment >= mColorTexRes.size()) {
+		return nullptr;
+	}
+	if (mUsePresentBuffer) {
+		return mPresentColorTexRes[attachment];
+	}
+	return mColorTexRes[attachment];
+}
 
-	// Set the list of draw buffers.
-	GLenum DrawBuffers[1] = {GL_COLOR_ATTACHMENT0};
-	glDrawBuffers(1, DrawBuffers); // "1" is the size of DrawBuffers
+void gs::Framebuffer::generateMipmaps()
+{
+	if (!mFormat.mMipmap) {
+		return;
+	}
+	// only the textures which can be read by getTexRes()
+	for (const std::shared_ptr<Texture>& tex : mUsePresentBuffer ? mPresentColorTexRes : mColorTexRes) {
+		if (tex) {
+			tex->generateMipmap();
+		}
+	}
+}
 
-	// Always check that our framebuffer is ok
-	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		LOGE("Wrong framebuffer status\n");
-		return false;
+bool gs::Framebuffer::setPresentBufferEnabled(bool enabled)
+{
+	if (enabled == mUsePresentBuffer) {
+		return true;
 	}
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (!enabled) {
+		if (mPool) {
+			for (const std::shared_ptr<Texture>& tex : mPresentColorTexRes) {
+				mPool->release(tex);
+			}
+		}
+		mPresentColorTexRes.clear();
+		mUsePresentBuffer = false;
+		return true;
+	}
+	mPresentColorTexRes.resize(mColorTexRes.size());
+	size_t colorCount = mPresentColorTexRes.size();
+	for (size_t i = 0; i < colorCount; ++i) {
+		if (!reallocTexture(mPresentColorTexRes[i], mFormat.mColorFormats[i], mFormat.mMipmap)) {
+			LOGE("Can't create present texture for color attachment %zu of framebuffer\n", i);
+			mPresentColorTexRes.clear();
+			return false;
+		}
+	}
+	mUsePresentBuffer = true;
 	return true;
 }
 
-bool gs::Framebuffer::recreateFramebuffer()
+void gs::Framebuffer::presentWork()
 {
+	if (!mUsePresentBuffer) {
+		return;
+	}
+	mColorTexRes.swap(mPresentColorTexRes);
 	glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
+	attachColorTextures();
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
 
-	mTexRes->create(mWidth, mHeight, ColorU32::white());
-	mTexRes->load();
+bool gs::Framebuffer::createFramebuffer()
+{
+	// The framebuffer, which regroups 0, 1, or more textures, and 0 or 1 depth buffer.
+	glGenFramebuffers(1, &mFbo);
+	if (mFormat.mDepth == FbDepth::RENDERBUFFER) {
+		// The depth buffer
+		glGenRenderbuffers(1, &mRbo);
+	}
+	mColorTexRes.resize(mFormat.mColorFormats.size());
+	return recreateFramebuffer();
+}
 
+bool gs::Framebuffer::recreateFramebuffer()
+{
+	// Only the gpu memory is allocated (no cpu side buffer).
+	size_t colorCount = mColorTexRes.size();
+	for (size_t i = 0; i < colorCount; ++i) {
+		if (!reallocTexture(mColorTexRes[i], mFormat.mColorFormats[i], mFormat.mMipmap)) {
+			LOGE("Can't create texture for color attachment %zu of framebuffer\n", i);
+			return false;
+		}
+	}
+	if (mUsePresentBuffer) {
+		for (size_t i = 0; i < colorCount; ++i) {
+			if (!reallocTexture(mPresentColorTexRes[i], mFormat.mColorFormats[i], mFormat.mMipmap)) {
+				LOGE("Can't create present texture for color attachment %zu of framebuffer\n", i);
+				return false;
+			}
+		}
+	}
+	if (mFormat.mDepth == FbDepth::TEXTURE) {
+		if (!reallocTexture(mDepthTexRes, GL_DEPTH_COMPONENT24, false)) {
+			LOGE("Can't create depth texture for framebuffer\n");
+			return false;
+		}
+	}
 
-	glBindRenderbuffer(GL_RENDERBUFFER, mRbo);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, mWidth, mHeight);
-	//glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, mWidth, mHeight);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, mRbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
 
-	// Set "renderedTexture" as our colour attachement #0
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mTexRes->getGlTexId(), 0);
+	switch (mFormat.mDepth) {
+		case FbDepth::NONE:
+			break;
+		case FbDepth::RENDERBUFFER:
+			glBindRenderbuffer(GL_RENDERBUFFER, mRbo);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, mWidth, mHeight);
+			//glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, mWidth, mHeight);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, mRbo);
+			break;
+		case FbDepth::TEXTURE:
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, mDepthTexRes->getGlTexId(), 0);
+			break;
+	}
 
-	// Set the list of draw buffers.
-	GLenum DrawBuffers[1] = {GL_COLOR_ATTACHMENT0};
-	glDrawBuffers(1, DrawBuffers); // "1" is the size of DrawBuffers
+	attachColorTextures();
 
 	// Always check that our framebuffer is ok
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
@@ -123,8 +245,67 @@ void gs::Framebuffer::deleteFramebuffer()
 	if (mFbo) {
 		glDeleteFramebuffers(1, &mFbo);
 	}
-	mTexRes.reset();
+	if (mPool) {
+		// give the textures back. Can be reused by the next framebuffer
+		for (const std::shared_ptr<Texture>& tex : mColorTexRes) {
+			mPool->release(tex);
+		}
+		for (const std::shared_ptr<Texture>& tex : mPresentColorTexRes) {
+			mPool->release(tex);
+		}
+		mPool->release(mDepthTexRes);
+	}
+	mColorTexRes.clear();
+	mPresentColorTexRes.clear();
+	mDepthTexRes.reset();
 	if (mRbo) {
 		glDeleteRenderbuffers(1, &mRbo);
 	}
 }
+
+void gs::Framebuffer::attachColorTextures()
+{
+	// Set "renderedTexture" as our colour attachement #0, #1, ...
+	size_t colorCount = mColorTexRes.size();
+	GLenum drawBuffers[FramebufferFormat::MAX_COLOR_ATTACHMENTS];
+	for (size_t i = 0; i < colorCount; ++i) {
+		drawBuffers[i] = GLenum(GL_COLOR_ATTACHMENT0 + i);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, drawBuffers[i], GL_TEXTURE_2D, mColorTexRes[i]->getGlTexId(), 0);
+	}
+
+	// Set the list of draw buffers.
+	if (colorCount) {
+		glDrawBuffers(GLsizei(colorCount), drawBuffers);
+	}
+	else {
+		// depth only (e.g. for shadow maps)
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+	}
+}
+
+bool gs::Framebuffer::reallocTexture(std::shared_ptr<Texture>& tex,
+		GLint internalFormat, bool mipmap)
+{
+	TexMipmap texMipmap = mipmap ? TexMipmap::MIPMAP : TexMipmap::NO_MIPMAP;
+	// Linear filtering for mipmaps and for a scaled resolution. Then the
+	// upscaling by the next render pass is smooth.
+	TexFilter filter = (mipmap || isScaled()) ? TexFilter::LINEAR : TexFilter::NEAREST;
+	// If a pool exist then the old texture is given back and maybe reused
+	// later (e.g. if the window is resized back to the old size).
+	if (mPool) {
+		std::shared_ptr<Texture> newTex = mPool->acquire(mWidth, mHeight, internalFormat, texMipmap, filter);
+		mPool->release(tex);
+		tex = newTex;
+		return tex != nullptr;
+	}
+	if (!tex || tex->getMinFilter() != filter) {
+		tex = std::make_shared<Texture>(std::weak_ptr<FileChangeMonitoring>(), "",
+				texMipmap, filter, filter);
+	}
+	if (!tex->createRenderTarget(mWidth, mHeight, internalFormat)) {
+		tex.reset();
+		return false;
+	}
+	return true;
+}
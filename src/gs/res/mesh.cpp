@@ -3,6 +3,7 @@
 #include <gs/res/shader_program.h>
 #include <gs/common/vertex.h>
 #include <gs/rendering/gl_api.h>
+#include <gs/rendering/render_statistic.h>
 #include <gs/system/log.h>
 #include <sstream>
 
@@ -135,6 +136,24 @@ bool gs::Mesh::addVertices(const void* vertices,
 	return true;
 }
 
+bool gs::Mesh::remapTexCoords(unsigned int texIndex,
+		float s0, float t0, float s1, float t1)
+{
+	if (texIndex >= mTexCount || !mVertexCount) {
+		return false;
+	}
+	unsigned int stride = mVertexSize / sizeof(float);
+	unsigned int offset = mPosCount + mNormalCount + texIndex * 2;
+	for (unsigned int i = 0; i < mVertexCount; ++i) {
+		float* st = &mVertices[i * stride + offset];
+		st[0] = s0 + st[0] * (s1 - s0);
+		st[1] = t0 + st[1] * (t1 - t0);
+	}
+	mChanged = true;
+	mChangedForString = true;
+	return true;
+}
+
 bool gs::Mesh::addVertices(const VertexV3C4* vertices,
 		unsigned int vertexCount)
 {
@@ -189,6 +208,9 @@ void gs::Mesh::draw()
 		return;
 	}
 
+	RenderCounters& rc = renderCounters();
+	++rc.mDrawCalls;
+	rc.mVertices += mVertexCount;
 	glDrawArrays(getPrimitive(mPrimitiveType), 0, mVertexCount);
 }
 
@@ -269,6 +291,9 @@ void gs::Mesh::drawNormals()
 		&v[0].r);
 		//v.data() + 3);
 
+	RenderCounters& rc = renderCounters();
+	++rc.mDrawCalls;
+	rc.mVertices += v.size();
 	glDrawArrays(GL_LINES, 0, v.size());
 
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -408,16 +433,21 @@ void gs::Mesh::unbindNoVaoVersion(const ShaderProgram* shaderProgram)
 
 void gs::Mesh::bindVaoVersion(const ShaderProgram* shaderProgram)
 {
+	RenderCounters& rc = renderCounters();
 	if (mVbo == 0) {
 		glGenBuffers(1, &mVbo);
 		// copy vertices array in a buffer for OpenGL
 		glBindBuffer(GL_ARRAY_BUFFER, mVbo);
 		glBufferData(GL_ARRAY_BUFFER, mVertices.size() * sizeof(float), mVertices.data(), GL_STATIC_DRAW);
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		++rc.mVboBinds;
+		rc.mBufferUploadBytes += mVertices.size() * sizeof(float);
 		mChanged = false;
 	}
 	else if (mChanged) {
 		LOGI("Mesh changed. --> Change data of VBO\n");
+		++rc.mVboBinds;
+		rc.mBufferUploadBytes += mVertices.size() * sizeof(float);
 		glBindBuffer(GL_ARRAY_BUFFER, mVbo);
 		// see https://www.khronos.org/opengl/wiki/Buffer_Object_Streaming
 		glBufferData(GL_ARRAY_BUFFER, mVertices.size() * sizeof(float), nullptr, GL_STATIC_DRAW);
@@ -455,6 +485,7 @@ void gs::Mesh::bindVaoVersion(const ShaderProgram* shaderProgram)
 	else {
 		glBindVertexArray(mVao);
 	}
+	++rc.mVaoBinds;
 }
 
 void gs::Mesh::unbindVaoVersion(const ShaderProgram* shaderProgram)
@@ -467,6 +498,7 @@ void gs::Mesh::createVao(const ShaderProgram* shaderProgram)
 	glGenVertexArrays(1, &mVao);
 	glBindVertexArray(mVao);
 	glBindBuffer(GL_ARRAY_BUFFER, mVbo);
+	++renderCounters().mVboBinds;
 
 	if (shaderProgram) {
 		const std::vector<Attribute>& attrs = shaderProgram->getAttributes();
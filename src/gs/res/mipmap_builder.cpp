@@ -0,0 +1,97 @@
+#include <gs/res/mipmap_builder.h>
+#include <gs/rendering/gl_api.h>
+#include <thread>
+#include <vector>
+#include <stddef.h>
+
+namespace gs
+{
+	namespace
+	{
+		// below this count of destination pixels no threads are used
+		const unsigned int MIN_PIXELS_FOR_THREADS = 256 * 256;
+
+		void downsampleRows(const unsigned char* src, unsigned int srcWidth,
+				unsigned int srcHeight, unsigned char* dst, unsigned int dstWidth,
+				unsigned int bytePerPixel, unsigned int yBegin, unsigned int yEnd)
+		{
+			size_t srcLineBytes = size_t(srcWidth) * bytePerPixel;
+			size_t dstLineBytes = size_t(dstWidth) * bytePerPixel;
+			for (unsigned int y = yBegin; y < yEnd; ++y) {
+				unsigned int sy0 = 2 * y;
+				unsigned int sy1 = (sy0 + 1 < srcHeight) ? sy0 + 1 : sy0;
+				const unsigned char* line0 = src + sy0 * srcLineBytes;
+				const unsigned char* line1 = src + sy1 * srcLineBytes;
+				unsigned char* out = dst + y * dstLineBytes;
+				for (unsigned int x = 0; x < dstWidth; ++x) {
+					unsigned int sx0 = 2 * x * bytePerPixel;
+					unsigned int sx1 = (2 * x + 1 < srcWidth) ? sx0 + bytePerPixel : sx0;
+					// simple loop without branches --> can be vectorized by the compiler
+					for (unsigned int c = 0; c < bytePerPixel; ++c) {
+						out[c] = static_cast<unsigned char>((line0[sx0 + c] +
+								line0[sx1 + c] + line1[sx0 + c] + line1[sx1 + c] + 2) >> 2);
+					}
+					out += bytePerPixel;
+				}
+			}
+		}
+	}
+}
+
+void gs::downsampleImage(const unsigned char* src, unsigned int srcWidth,
+		unsigned int srcHeight, unsigned char* dst, unsigned int bytePerPixel)
+{
+	unsigned int dstWidth = (srcWidth > 1) ? srcWidth / 2 : 1;
+	unsigned int dstHeight = (srcHeight > 1) ? srcHeight / 2 : 1;
+
+	unsigned int threadCount = std::thread::hardware_concurrency();
+	if (threadCount < 1 || dstWidth * dstHeight < MIN_PIXELS_FOR_THREADS) {
+		threadCount = 1;
+	}
+	if (threadCount > dstHeight) {
+		threadCount = dstHeight;
+	}
+	unsigned int rowsPerThread = (dstHeight + threadCount - 1) / threadCount;
+
+	std::vector<std::thread> threads;
+	// the first stripe is done by the calling thread
+	for (unsigned int i = 1; i < threadCount; ++i) {
+		unsigned int yBegin = i * rowsPerThread;
+		unsigned int yEnd = (yBegin + rowsPerThread < dstHeight) ? yBegin + rowsPerThread : dstHeight;
+		if (yBegin >= yEnd) {
+			break;
+		}
+		threads.emplace_back(downsampleRows, src, srcWidth, srcHeight, dst,
+				dstWidth, bytePerPixel, yBegin, yEnd);
+	}
+	downsampleRows(src, srcWidth, srcHeight, dst, dstWidth, bytePerPixel,
+			0, (rowsPerThread < dstHeight) ? rowsPerThread : dstHeight);
+	for (std::thread& t : threads) {
+		t.join();
+	}
+}
+
+void gs::uploadMipmapLevels(const unsigned char* level0, unsigned int width,
+		unsigned int height)
+{
+	const unsigned int bytePerPixel = 4;
+	// level 1 is the biggest level --> the buffers can be reused for all levels
+	unsigned int w1 = (width > 1) ? width / 2 : 1;
+	unsigned int h1 = (height > 1) ? height / 2 : 1;
+	std::vector<unsigned char> bufA(size_t(w1) * h1 * bytePerPixel);
+	std::vector<unsigned char> bufB(bufA.size());
+
+	const unsigned char* src = level0;
+	unsigned char* dst = bufA.data();
+	GLint level = 0;
+	while (width > 1 || height > 1) {
+		downsampleImage(src, width, height, dst, bytePerPixel);
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+		++level;
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, width, height,
+				0, GL_RGBA, GL_UNSIGNED_BYTE, dst);
+		src = dst;
+		dst = (dst == bufA.data()) ? bufB.data() : bufA.data();
+	}
+}
@@ -0,0 +1,202 @@
+#include <gs/res/pixel_buffer_pool.h>
+#include <gs/res/texture_decoder.h>
+#include <gs/system/log.h>
+#include <algorithm>
+
+gs::PixelBufferPool::PixelBufferPool(unsigned int maxFreeCount)
+		:mMaxFreeCount(maxFreeCount), mBuffers(), mFree(), mTotalBytes(0)
+{
+}
+
+gs::PixelBufferPool::~PixelBufferPool()
+{
+	// the decoder threads must be stopped before (no copy into a mapped buffer)
+	std::vector<std::shared_ptr<PixelBuffer> > buffers;
+	buffers.swap(mBuffers);
+	for (const std::shared_ptr<PixelBuffer>& buffer : buffers) {
+		deleteBuffer(buffer);
+	}
+	mFree.clear();
+}
+
+bool gs::PixelBufferPool::isSupported()
+{
+#ifdef GLSLSCENE_USE_GLEW
+	return (GLEW_VERSION_3_2 || GLEW_ARB_sync) &&
+			(GLEW_VERSION_3_0 || GLEW_ARB_map_buffer_range) &&
+			(GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object);
+#else
+	return false;
+#endif
+}
+
+std::shared_ptr<gs::PixelBuffer> gs::PixelBufferPool::acquire(size_t size)
+{
+	if (!size || !isSupported()) {
+		return nullptr;
+	}
+#ifdef GLSLSCENE_USE_GLEW
+	// the smallest free buffer which is large enough
+	auto bestIt = mFree.end();
+	for (auto it = mFree.begin(); it != mFree.end(); ++it) {
+		if ((*it)->mCapacity >= size &&
+				(bestIt == mFree.end() || (*it)->mCapacity < (*bestIt)->mCapacity)) {
+			bestIt = it;
+		}
+	}
+	std::shared_ptr<PixelBuffer> buffer;
+	if (bestIt != mFree.end()) {
+		buffer = *bestIt;
+		mFree.erase(bestIt);
+	}
+	else {
+		// the free buffers are too small --> replaced by a new buffer
+		while (mTotalBytes + size > MAX_TOTAL_BYTES && !mFree.empty()) {
+			std::shared_ptr<PixelBuffer> oldBuffer = mFree.front();
+			mFree.erase(mFree.begin());
+			deleteBuffer(oldBuffer);
+		}
+		if (mTotalBytes + size > MAX_TOTAL_BYTES) {
+			return nullptr;
+		}
+		buffer = std::make_shared<PixelBuffer>();
+		glGenBuffers(1, &buffer->mPbo);
+		if (!buffer->mPbo) {
+			return nullptr;
+		}
+		mBuffers.push_back(buffer);
+	}
+	buffer->mIsFree = false;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->mPbo);
+	if (buffer->mCapacity < size) {
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		mTotalBytes += size - buffer->mCapacity;
+		buffer->mCapacity = size;
+	}
+	// unsynchronized --> the fence of the last upload is already signaled
+	buffer->mMappedData = static_cast<unsigned char*>(glMapBufferRange(
+			GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT |
+			GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (!buffer->mMappedData) {
+		LOGW("Can't map pixel buffer with %zu bytes\n", size);
+		deleteBuffer(buffer);
+		return nullptr;
+	}
+	return buffer;
+#else
+	return nullptr;
+#endif
+}
+
+void gs::PixelBufferPool::setCopyJob(PixelBuffer& buffer, const std::shared_ptr<TextureDecodeJob>& job)
+{
+	buffer.mCopyJob = job;
+}
+
+bool gs::PixelBufferPool::bindForUpload(PixelBuffer& buffer)
+{
+	if (!buffer.mMappedData) {
+		return false;
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.mPbo);
+	GLboolean isValid = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	buffer.mMappedData = nullptr;
+	buffer.mCopyJob.reset();
+	if (!isValid) {
+		// e.g. the video memory was lost --> the client memory is used
+		LOGW("Content of pixel buffer %u is lost\n", buffer.mPbo);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return false;
+	}
+	return true;
+}
+
+void gs::PixelBufferPool::release(const std::shared_ptr<PixelBuffer>& buffer)
+{
+	if (!buffer || buffer->mIsFree) {
+		return;
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (buffer->mMappedData) {
+		// not used for an upload (e.g. the loading was canceled)
+		// --> is unmapped by update() after the copy is done
+		return;
+	}
+#ifdef GLSLSCENE_USE_GLEW
+	// the buffer is reused after the driver has read it
+	buffer->mFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+}
+
+void gs::PixelBufferPool::update()
+{
+	for (const std::shared_ptr<PixelBuffer>& buffer : mBuffers) {
+		if (buffer->mIsFree) {
+			continue;
+		}
+		if (buffer->mFence) {
+			if (!isFenceSignaled(*buffer)) {
+				continue;
+			}
+		}
+		else if (!buffer->mMappedData || buffer.use_count() > 1) {
+			continue; // used by a texture
+		}
+		else {
+			// dropped by a texture while it was mapped
+			if (buffer->mCopyJob && !buffer->mCopyJob->isCopied()) {
+				continue; // the decoder thread still writes into the buffer
+			}
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->mPbo);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			buffer->mMappedData = nullptr;
+			buffer->mCopyJob.reset();
+		}
+		buffer->mIsFree = true;
+		mFree.push_back(buffer);
+	}
+	// the buffers which are free for the longest time are deleted first
+	while (mFree.size() > mMaxFreeCount) {
+		std::shared_ptr<PixelBuffer> buffer = mFree.front();
+		mFree.erase(mFree.begin());
+		deleteBuffer(buffer);
+	}
+}
+
+bool gs::PixelBufferPool::isFenceSignaled(PixelBuffer& buffer)
+{
+#ifdef GLSLSCENE_USE_GLEW
+	GLsync fence = static_cast<GLsync>(buffer.mFence);
+	// timeout 0 --> doesn't block
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) {
+		return false;
+	}
+	glDeleteSync(fence);
+#endif
+	buffer.mFence = nullptr;
+	return true;
+}
+
+void gs::PixelBufferPool::deleteBuffer(const std::shared_ptr<PixelBuffer>& buffer)
+{
+#ifdef GLSLSCENE_USE_GLEW
+	if (buffer->mFence) {
+		glDeleteSync(static_cast<GLsync>(buffer->mFence));
+		buffer->mFence = nullptr;
+	}
+#endif
+	// a mapped buffer is unmapped by glDeleteBuffers()
+	glDeleteBuffers(1, &buffer->mPbo);
+	buffer->mPbo = 0;
+	buffer->mMappedData = nullptr;
+	buffer->mCopyJob.reset();
+	mTotalBytes -= buffer->mCapacity;
+	buffer->mCapacity = 0;
+	auto it = std::find(mBuffers.begin(), mBuffers.end(), buffer);
+	if (it != mBuffers.end()) {
+		mBuffers.erase(it);
+	}
+}
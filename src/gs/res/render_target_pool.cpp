@@ -0,0 +1,81 @@
+#include <gs/res/render_target_pool.h>
+#include <gs/res/texture.h>
+#include <gs/system/log.h>
+
+bool gs::RenderTargetPool::Key::operator<(const Key& k) const
+{
+	if (mWidth != k.mWidth) {
+		return mWidth < k.mWidth;
+	}
+	if (mHeight != k.mHeight) {
+		return mHeight < k.mHeight;
+	}
+	if (mInternalFormat != k.mInternalFormat) {
+		return mInternalFormat < k.mInternalFormat;
+	}
+	if (mMipmap != k.mMipmap) {
+		return mMipmap < k.mMipmap;
+	}
+	return mFilter < k.mFilter;
+}
+
+gs::RenderTargetPool::RenderTargetPool(unsigned int maxUnusedCount)
+		:mMaxUnusedCount(maxUnusedCount), mUnused(), mNextReleaseNumber(0),
+		mCreatedCount(0), mReusedCount(0)
+{
+}
+
+gs::RenderTargetPool::~RenderTargetPool()
+{
+	clear();
+}
+
+std::shared_ptr<gs::Texture> gs::RenderTargetPool::acquire(
+		unsigned int width, unsigned int height, GLint internalFormat,
+		TexMipmap mipmap, TexFilter filter)
+{
+	TUnusedMap::iterator it = mUnused.find(Key(width, height, internalFormat, mipmap, filter));
+	if (it != mUnused.end()) {
+		std::shared_ptr<Texture> tex = it->second.mTex;
+		mUnused.erase(it);
+		++mReusedCount;
+		return tex;
+	}
+
+	std::shared_ptr<Texture> tex = std::make_shared<Texture>(std::weak_ptr<FileChangeMonitoring>(), "",
+			mipmap, filter, filter);
+	if (!tex->createRenderTarget(width, height, internalFormat)) {
+		LOGE("Can't create render target %ux%u\n", width, height);
+		return nullptr;
+	}
+	++mCreatedCount;
+	return tex;
+}
+
+void gs::RenderTargetPool::release(const std::shared_ptr<Texture>& tex)
+{
+	if (!tex || !tex->getGlTexId()) {
+		return;
+	}
+	mUnused.insert(TUnusedMap::value_type(
+			Key(tex->getWidth(), tex->getHeight(), tex->getInternalFormat(),
+					tex->getMipmap(), tex->getMinFilter()),
+			Entry(tex, mNextReleaseNumber)));
+	++mNextReleaseNumber;
+
+	while (mUnused.size() > mMaxUnusedCount) {
+		// delete the texture which was released first
+		TUnusedMap::iterator oldest = mUnused.begin();
+		for (TUnusedMap::iterator it = mUnused.begin(); it != mUnused.end(); ++it) {
+			if (it->second.mReleaseNumber < oldest->second.mReleaseNumber) {
+				oldest = it;
+			}
+		}
+		mUnused.erase(oldest);
+	}
+}
+
+void gs::RenderTargetPool::clear()
+{
+	mUnused.clear();
+}
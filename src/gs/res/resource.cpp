@@ -1,24 +1,27 @@
 #include <gs/res/resource.h>
 #include <gs/system/file_change_monitoring.h>
+#include <gs/system/hot_reload_statistic.h>
 #include <gs/system/log.h>
 
 gs::Resource::Resource(const std::weak_ptr<FileChangeMonitoring>& fcm)
-		:mIdNumber(0), mIdName(), mFileMonitoring(fcm), mHotReloadingFiles()
+		:mIdNumber(0), mIdName(), mHotReloadId(0), mFileMonitoring(fcm), mHotReloadingFiles()
 {
 }
 
 gs::Resource::~Resource()
 {
+	releaseHotReload();
 	removeAllFilesForHotReloading();
 }
 
-unsigned int gs::Resource::addFileForHotReloading(const std::string &filename)
+unsigned int gs::Resource::addFileForHotReloading(const std::string &filename, bool checkContent)
 {
 	std::shared_ptr<FileChangeMonitoring> fcm(mFileMonitoring.lock());
 	if (!fcm) {
 		return 0;
 	}
-	unsigned int callbackId = fcm->addFile(filename, hotReloadingCb, std::shared_ptr<void>(), this);
+	unsigned int callbackId = fcm->addFile(filename, hotReloadingCb, std::shared_ptr<void>(), this,
+			FileChangeMonitoring::DEFAULT_SETTLE_MSEC, checkContent);
 	if (!callbackId) {
 		return 0;
 	}
@@ -44,12 +47,47 @@ void gs::Resource::hotReloadingCb(unsigned int callbackId,
 		const std::string& filename,
 		const std::shared_ptr<void>& unused, void* thisResource)
 {
-	static_cast<Resource*>(thisResource)->hotReloading(callbackId, filename);
+	Resource* res = static_cast<Resource*>(thisResource);
+	res->attachToHotReload();
+	res->hotReloading(callbackId, filename);
 }
 
 void gs::Resource::hotReloading(unsigned int callbackId, const std::string& filename)
 {
 	LOGI("hot reloading: reload %s\n", filename.c_str());
-	load();
+	if (load()) {
+		markHotReloadUploaded(); // if not already done by load()
+	}
+	else {
+		releaseHotReload();
+	}
+}
+
+void gs::Resource::attachToHotReload()
+{
+	HotReloadStatistic& hrs = getHotReloadStatistic();
+	unsigned int reloadId = hrs.attachCurrent();
+	if (!reloadId) {
+		return;
+	}
+	hrs.release(mHotReloadId);
+	mHotReloadId = reloadId;
+}
+
+void gs::Resource::markHotReloadLoaded()
+{
+	getHotReloadStatistic().markLoaded(mHotReloadId);
+}
+
+void gs::Resource::markHotReloadUploaded()
+{
+	getHotReloadStatistic().markUploaded(mHotReloadId);
+	mHotReloadId = 0;
+}
+
+void gs::Resource::releaseHotReload()
+{
+	getHotReloadStatistic().release(mHotReloadId);
+	mHotReloadId = 0;
 }
 
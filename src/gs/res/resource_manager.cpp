@@ -2,68 +2,203 @@
 #include <gs/res/shader_program.h>
 #include <gs/res/mesh.h>
 #include <gs/res/framebuffer.h>
+#include <gs/res/render_target_pool.h>
+#include <gs/res/texture_decoder.h>
+#include <gs/res/pixel_buffer_pool.h>
+#include <gs/res/texture_cache.h>
+#include <gs/res/shader_binary_cache.h>
+#include <gs/res/shader_include_cache.h>
+#include <gs/res/shader_object_cache.h>
 #include <gs/system/log.h>
+#include <algorithm>
 
 gs::ResourceManager::ResourceManager(const std::weak_ptr<FileChangeMonitoring>& fcm,
-		bool useVaoVersionForMesh)
+		bool useVaoVersionForMesh, const std::shared_ptr<TextureDecoder>& decoder,
+		const std::shared_ptr<RenderTargetPool>& renderTargetPool,
+		const std::shared_ptr<PixelBufferPool>& pixelBufferPool)
 		:mFileMonitoring(fcm), mUseVaoVersionForMesh(useVaoVersionForMesh),
-		mResByIdName(), mResByIdNumber(), mNextFreeResourceId(2)
+		mRenderTargetPool(renderTargetPool ? renderTargetPool : std::make_shared<RenderTargetPool>()),
+		mPixelBufferPool(pixelBufferPool ? pixelBufferPool : std::make_shared<PixelBufferPool>()),
+		mTextureDecoder(decoder ? decoder : std::make_shared<TextureDecoder>()), mTextureCache(),
+		mShaderBinaryCache(),
+		mShaderIncludeCache(std::make_shared<ShaderIncludeCache>(fcm)),
+		mShaderObjectCache(std::make_shared<ShaderObjectCache>()),
+		mLoadingTextures(), mShaderPrograms(), mTextureAtlases(), mIsShaderLoadingAsync(false),
+		mIsGpuObjectsDeferred(false), mMaxTextureSize(0), mPendingGpuResources(),
+		mIsShaderCacheDirectoryDeferred(false), mHasDeferredShaderCacheDirectory(false),
+		mDeferredShaderCacheDirectory(),
+		mResByIdName(), mResources(), mTexturePtrs(), mShaderProgramPtrs(), mMeshPtrs(),
+		mNextFreeResourceId(FIRST_RESOURCE_ID), mIdsInAddOrder(), mIdsByConfig()
 {
 }
 
+gs::ResourceManager::~ResourceManager()
+{
+	// the jobs which are not started are dropped (also if the decoder
+	// is used by another resource manager)
+	mLoadingTextures.clear();
+}
+
 gs::TTextureId gs::ResourceManager::addTexture(const std::string &idName,
 		const std::string &filename, gs::TexMipmap mipmap,
-		gs::TexFilter minFilter, gs::TexFilter magFilter)
+		gs::TexFilter minFilter, gs::TexFilter magFilter, bool keepData,
+		TexCompression compression, TexFormat format)
 {
 	std::shared_ptr<Texture> tex = std::make_shared<Texture>(mFileMonitoring, filename, mipmap, minFilter, magFilter);
-	if (!tex->load()) {
+	tex->setKeepData(keepData);
+	tex->setCompression(compression);
+	tex->setFormat(format);
+	bool success = mIsGpuObjectsDeferred ?
+			tex->startDecoding(*mTextureDecoder, mTextureCache) :
+			tex->startLoading(*mTextureDecoder, mTextureCache);
+	if (!success) {
 		LOGE("Load texture failed\n");
 		return 0;
 	}
 
-	return addResource(idName, tex);
+	TTextureId texId = addResource(idName, tex);
+	if (texId && mIsGpuObjectsDeferred) {
+		// the placeholder is created by updateLoading()
+		mPendingGpuResources.push_back(tex);
+	}
+	else if (texId && tex->isLoading()) {
+		mLoadingTextures.push_back(tex);
+	}
+	return texId;
+}
+
+gs::TTextureAtlasId gs::ResourceManager::addTextureAtlas(const std::string& idName,
+		const std::vector<TextureAtlas::Image>& images,
+		TexMipmap mipmap, TexFilter minFilter, TexFilter magFilter,
+		unsigned int padding, unsigned int maxSize)
+{
+	if (mMaxTextureSize && mMaxTextureSize < maxSize) {
+		maxSize = mMaxTextureSize;
+	}
+	std::shared_ptr<TextureAtlas> atlas = std::make_shared<TextureAtlas>(mFileMonitoring,
+			images, mipmap, minFilter, magFilter, padding, maxSize,
+			mTextureDecoder, mTextureCache);
+	bool success = mIsGpuObjectsDeferred ? atlas->startDecoding() : atlas->startLoading();
+	if (!success) {
+		LOGE("Load texture atlas failed\n");
+		return 0;
+	}
+
+	TTextureAtlasId atlasId = addResource(idName, atlas);
+	if (atlasId) {
+		mTextureAtlases.push_back(atlas);
+		if (mIsGpuObjectsDeferred) {
+			mPendingGpuResources.push_back(atlas);
+		}
+	}
+	return atlasId;
 }
 
 gs::TShaderId gs::ResourceManager::addShaderProgram(const std::string& idName,
 		const ShaderProgramLoadInfo& shaderProgramLoadInfo)
 {
 	std::shared_ptr<ShaderProgram> shaderProg = std::make_shared<ShaderProgram>(mFileMonitoring, shaderProgramLoadInfo);
-	if (!shaderProg->load()) {
+	shaderProg->setBinaryCache(mShaderBinaryCache);
+	shaderProg->setIncludeCache(mShaderIncludeCache);
+	shaderProg->setObjectCache(mShaderObjectCache);
+	if (mIsGpuObjectsDeferred) {
+		// compiled by updateLoading() (a failure is reported by hasFailedShaderProgram())
+		shaderProg->readSourceFiles();
+		TShaderId shaderId = addResource(idName, shaderProg);
+		if (shaderId) {
+			mPendingGpuResources.push_back(shaderProg);
+		}
+		return shaderId;
+	}
+	bool success = mIsShaderLoadingAsync ? shaderProg->startLoading() : shaderProg->load();
+	if (!success) {
 		LOGE("Load and compile shader failed\n");
 		return 0;
 	}
 
-	return addResource(idName, shaderProg);
+	TShaderId shaderId = addResource(idName, shaderProg);
+	if (shaderId) {
+		// for finishing the loading and the hot reloading. See updateLoading().
+		mShaderPrograms.push_back(shaderProg);
+	}
+	return shaderId;
 }
 
 gs::TResourceId gs::ResourceManager::addResource(const std::string &idName,
 		const std::shared_ptr<gs::Resource> &res)
 {
-	TResByIdNameMap::const_iterator itByName = mResByIdName.find(idName);
-	if (itByName != mResByIdName.cend()) {
-		LOGE("id name '%s' is already used for a resource.\n", idName.c_str());
+	// the first unused id number (taken over resources keep their id numbers)
+	size_t index = size_t(mNextFreeResourceId - FIRST_RESOURCE_ID);
+	while (index < mResources.size() && mResources[index]) {
+		++index;
+	}
+	TResourceId idNumber = FIRST_RESOURCE_ID + static_cast<TResourceId>(index);
+	if (!setResource(idNumber, idName, res)) {
 		return 0;
 	}
-	TResourceId idNumber = mNextFreeResourceId;
-	++mNextFreeResourceId;
+	mNextFreeResourceId = idNumber + 1;
 
 	res->setIdName(idName);
 	res->setIdNumber(idNumber);
+	return idNumber;
+}
+
+gs::TFramebufferId gs::ResourceManager::addFramebuffer(const std::string& idName,
+		const std::shared_ptr<Framebuffer>& fb)
+{
+	if (!mIsGpuObjectsDeferred) {
+		fb->load();
+	}
+	TFramebufferId fbId = addResource(idName, fb);
+	if (fbId && mIsGpuObjectsDeferred) {
+		mPendingGpuResources.push_back(fb);
+	}
+	return fbId;
+}
 
+bool gs::ResourceManager::setResource(TResourceId idNumber, const std::string& idName,
+		const std::shared_ptr<Resource>& res)
+{
+	TResByIdNameMap::const_iterator itByName = mResByIdName.find(idName);
+	if (itByName != mResByIdName.cend()) {
+		LOGE("id name '%s' is already used for a resource.\n", idName.c_str());
+		return false;
+	}
+	size_t index = size_t(idNumber - FIRST_RESOURCE_ID);
+	if (index >= mResources.size()) {
+		mResources.resize(index + 1);
+		mTexturePtrs.resize(index + 1, nullptr);
+		mShaderProgramPtrs.resize(index + 1, nullptr);
+		mMeshPtrs.resize(index + 1, nullptr);
+	}
+	else if (mResources[index]) {
+		// see addResource() --> id numbers are never reused
+		LOGE("id number %u is already used for the resource '%s'.\n",
+				idNumber, mResources[index]->getIdName().c_str());
+		return false;
+	}
 	mResByIdName[idName] = res;
-	mResByIdNumber[idNumber] = res;
-	return idNumber;
+	mResources[index] = res;
+	ResType type = res->getType();
+	mTexturePtrs[index] = (type == ResType::TEXTURE) ? static_cast<Texture*>(res.get()) : nullptr;
+	mShaderProgramPtrs[index] = (type == ResType::SHADER_PROGRAM) ? static_cast<ShaderProgram*>(res.get()) : nullptr;
+	mMeshPtrs[index] = (type == ResType::MESH) ? static_cast<Mesh*>(res.get()) : nullptr;
+	mIdsInAddOrder.push_back(idNumber);
+	return true;
 }
 
 std::string gs::ResourceManager::toString() const
 {
 	std::stringstream s;
-	for (const auto& r : mResByIdNumber) {
-		const auto& res = *r.second;
+	for (const auto& r : mResources) {
+		if (!r) {
+			continue;
+		}
+		const auto& res = *r;
 		s << "id: " << res.getIdNumber() <<
 				", id name: " << res.getIdName() <<
 				", type: ";
-		switch (r.second->getType()) {
+		switch (res.getType()) {
 			case ResType::TEXTURE:
 				s << "texture";
 				break;
@@ -76,12 +211,234 @@ std::string gs::ResourceManager::toString() const
 			case ResType::FRAMEBUFFER:
 				s << "framebuffer";
 				break;
+			case ResType::TEXTURE_ATLAS:
+				s << "texture atlas";
+				break;
 		}
 		s << "\n";
 	}
 	return s.str();
 }
 
+void gs::ResourceManager::setConfigOfResources(uint64_t configKey, size_t firstIndex)
+{
+	if (firstIndex >= mIdsInAddOrder.size()) {
+		return; // no resource was created (e.g. loading failed)
+	}
+	mIdsByConfig[configKey] = std::vector<TResourceId>(
+			mIdsInAddOrder.begin() + firstIndex, mIdsInAddOrder.end());
+}
+
+bool gs::ResourceManager::takeOverResources(const ResourceManager& prevRm, uint64_t configKey)
+{
+	auto it = prevRm.mIdsByConfig.find(configKey);
+	if (it == prevRm.mIdsByConfig.end()) {
+		return false;
+	}
+	const std::vector<TResourceId>& prevIds = it->second;
+	// check all resources of the entry first --> all or nothing is taken over
+	for (TResourceId id : prevIds) {
+		std::shared_ptr<Resource> res = prevRm.getResourceByIdNumber(id);
+		if (!res) {
+			return false;
+		}
+		if (mResByIdName.find(res->getIdName()) != mResByIdName.end()) {
+			return false;
+		}
+		// the id number is already used by a new resource
+		if (getResourceByIdNumber(id)) {
+			return false;
+		}
+	}
+	size_t firstIndex = mIdsInAddOrder.size();
+	for (TResourceId id : prevIds) {
+		std::shared_ptr<Resource> res = prevRm.getResourceByIdNumber(id);
+		// same id number and id name --> the resource itself is not changed
+		setResource(id, res->getIdName(), res);
+		if (res->getType() == ResType::SHADER_PROGRAM) {
+			// for finishing the hot reloading. See updateLoading().
+			mShaderPrograms.push_back(std::static_pointer_cast<ShaderProgram>(res));
+		}
+		else if (res->getType() == ResType::TEXTURE) {
+			// a loading texture is finished by updateLoading() of this or the
+			// previous resource manager (is dropped if it is not loading).
+			// Its state is not read here --> can be called by the loading thread.
+			mLoadingTextures.push_back(std::static_pointer_cast<Texture>(res));
+		}
+		else if (res->getType() == ResType::TEXTURE_ATLAS) {
+			mTextureAtlases.push_back(std::static_pointer_cast<TextureAtlas>(res));
+		}
+	}
+	setConfigOfResources(configKey, firstIndex);
+	return true;
+}
+
+bool gs::ResourceManager::setTextureCacheDirectory(const std::string& directory)
+{
+	if (directory.empty()) {
+		mTextureCache.reset();
+		return true;
+	}
+	std::shared_ptr<TextureCache> cache = std::make_shared<TextureCache>(directory);
+	if (!cache->isValid()) {
+		mTextureCache.reset();
+		return false;
+	}
+	mTextureCache = cache;
+	return true;
+}
+
+bool gs::ResourceManager::setShaderCacheDirectory(const std::string& directory)
+{
+	if (mIsShaderCacheDirectoryDeferred) {
+		mDeferredShaderCacheDirectory = directory;
+		mHasDeferredShaderCacheDirectory = true;
+		return true;
+	}
+	if (!mShaderBinaryCache) {
+		if (directory.empty()) {
+			return true;
+		}
+		mShaderBinaryCache = std::make_shared<ShaderBinaryCache>();
+	}
+	return mShaderBinaryCache->setDirectory(directory);
+}
+
+void gs::ResourceManager::applyShaderCacheDirectory()
+{
+	mIsShaderCacheDirectoryDeferred = false;
+	if (!mHasDeferredShaderCacheDirectory) {
+		return;
+	}
+	mHasDeferredShaderCacheDirectory = false;
+	if (!setShaderCacheDirectory(mDeferredShaderCacheDirectory)) {
+		LOGE("Can't use shader cache directory '%s'\n", mDeferredShaderCacheDirectory.c_str());
+	}
+	mDeferredShaderCacheDirectory.clear();
+}
+
+unsigned int gs::ResourceManager::updateLoading()
+{
+	createPendingGpuObjects();
+	size_t uploadedBytes = 0;
+	// buffers of the uploads of the previous frames are reused
+	mPixelBufferPool->update();
+	auto it = mLoadingTextures.begin();
+	while (it != mLoadingTextures.end()) {
+		Texture& tex = **it;
+		if (!tex.isLoading()) {
+			// e.g. synchronously loaded by hot reloading
+			it = mLoadingTextures.erase(it);
+			continue;
+		}
+		if (!tex.isDecoded() || uploadedBytes >= UPLOAD_BYTES_PER_FRAME) {
+			++it;
+			continue;
+		}
+		if (!tex.finishLoading(mTextureDecoder.get(), mPixelBufferPool.get())) {
+			// a decoder thread copies the image into a pixel buffer
+			++it;
+			continue;
+		}
+		// size of the uncompressed pixels (is also used for compressed textures)
+		uploadedBytes += size_t(tex.getWidth()) * tex.getHeight() * 4;
+		it = mLoadingTextures.erase(it);
+	}
+	// atlases which are loaded or reloaded by hot reloading
+	for (const std::shared_ptr<TextureAtlas>& atlas : mTextureAtlases) {
+		if (!atlas->isDecoded() || uploadedBytes >= UPLOAD_BYTES_PER_FRAME) {
+			continue;
+		}
+		atlas->finishLoading();
+		const std::shared_ptr<Texture>& tex = atlas->getTexture();
+		uploadedBytes += size_t(tex->getWidth()) * tex->getHeight() * 4;
+	}
+	// shader programs which are recompiled by hot reloading
+	for (const std::shared_ptr<ShaderProgram>& prog : mShaderPrograms) {
+		if (prog->isReloadRequested()) {
+			prog->startLoading();
+		}
+		if (prog->isLoading()) {
+			prog->finishLoading();
+		}
+	}
+	return static_cast<unsigned int>(mLoadingTextures.size());
+}
+
+bool gs::ResourceManager::isLoading() const
+{
+	if (!mLoadingTextures.empty() || !mPendingGpuResources.empty()) {
+		return true;
+	}
+	for (const std::shared_ptr<TextureAtlas>& atlas : mTextureAtlases) {
+		if (atlas->isLoading()) {
+			return true;
+		}
+	}
+	for (const std::shared_ptr<ShaderProgram>& prog : mShaderPrograms) {
+		if (prog->isLoading()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void gs::ResourceManager::createPendingGpuObjects()
+{
+	if (mIsGpuObjectsDeferred || mPendingGpuResources.empty()) {
+		return; // e.g. the resources are still added by the loading thread
+	}
+	size_t count = std::min(mPendingGpuResources.size(), size_t(GPU_OBJECTS_PER_FRAME));
+	for (size_t i = 0; i < count; ++i) {
+		const std::shared_ptr<Resource>& res = mPendingGpuResources[i];
+		switch (res->getType()) {
+			case ResType::TEXTURE: {
+				std::shared_ptr<Texture> tex = std::static_pointer_cast<Texture>(res);
+				if (!tex->createPlaceholder()) {
+					LOGE("Can't create placeholder for texture '%s'\n", tex->getIdName().c_str());
+				}
+				if (tex->isLoading()) {
+					mLoadingTextures.push_back(tex);
+				}
+				break;
+			}
+			case ResType::TEXTURE_ATLAS:
+				if (!std::static_pointer_cast<TextureAtlas>(res)->createPlaceholder()) {
+					LOGE("Can't create placeholder for texture atlas '%s'\n", res->getIdName().c_str());
+				}
+				break;
+			case ResType::SHADER_PROGRAM: {
+				std::shared_ptr<ShaderProgram> prog = std::static_pointer_cast<ShaderProgram>(res);
+				bool success = mIsShaderLoadingAsync ? prog->startLoading() : prog->load();
+				if (!success) {
+					LOGE("Load and compile shader '%s' failed\n", prog->getIdName().c_str());
+				}
+				// also a failed program --> see hasFailedShaderProgram()
+				mShaderPrograms.push_back(prog);
+				break;
+			}
+			default:
+				// e.g. the framebuffer and its attachments
+				if (!res->load()) {
+					LOGE("Can't create resource '%s'\n", res->getIdName().c_str());
+				}
+				break;
+		}
+	}
+	mPendingGpuResources.erase(mPendingGpuResources.begin(),
+			mPendingGpuResources.begin() + count);
+}
+
+bool gs::ResourceManager::hasFailedShaderProgram() const
+{
+	for (const std::shared_ptr<ShaderProgram>& prog : mShaderPrograms) {
+		if (!prog->isLoading() && !prog->isLinked()) {
+			return true;
+		}
+	}
+	return false;
+}
+
 gs::TResourceId gs::ResourceManager::getResourceId(const std::string& idName) const
 {
 	TResByIdNameMap::const_iterator it = mResByIdName.find(idName);
@@ -102,21 +459,25 @@ std::shared_ptr<gs::Resource> gs::ResourceManager::getResourceByIdName(const std
 
 std::shared_ptr<gs::Resource> gs::ResourceManager::getResourceByIdNumber(TResourceId idNumber) const
 {
-	TResByIdNumberMap::const_iterator it = mResByIdNumber.find(idNumber);
-	if (it == mResByIdNumber.cend()) {
+	size_t index = size_t(idNumber - FIRST_RESOURCE_ID);
+	if (index >= mResources.size()) {
 		return std::shared_ptr<gs::Resource>();
 	}
-	return it->second;
+	return mResources[index];
 }
 
-std::shared_ptr<gs::Texture> gs::ResourceManager::getTextureByIdName(const std::string& idName) const
+std::shared_ptr<gs::Texture> gs::ResourceManager::getTextureByIdName(const std::string& idName,
+		unsigned int fbAttachment) const
 {
 	std::shared_ptr<Resource> res = getResourceByIdName(idName);
 	if (!res) {
 		return std::shared_ptr<Texture>();
 	}
 	if (res->getType() == ResType::FRAMEBUFFER) {
-		return std::static_pointer_cast<Framebuffer>(res)->getTexRes();
+		return std::static_pointer_cast<Framebuffer>(res)->getTexRes(fbAttachment);
+	}
+	if (res->getType() == ResType::TEXTURE_ATLAS) {
+		return std::static_pointer_cast<TextureAtlas>(res)->getTexture();
 	}
 	if (res->getType() != ResType::TEXTURE) {
 		return std::shared_ptr<Texture>();
@@ -124,14 +485,18 @@ std::shared_ptr<gs::Texture> gs::ResourceManager::getTextureByIdName(const std::
 	return std::static_pointer_cast<Texture>(res);
 }
 
-std::shared_ptr<gs::Texture> gs::ResourceManager::getTextureByIdNumber(TResourceId idNumber) const
+std::shared_ptr<gs::Texture> gs::ResourceManager::getTextureByIdNumber(TResourceId idNumber,
+		unsigned int fbAttachment) const
 {
 	std::shared_ptr<Resource> res = getResourceByIdNumber(idNumber);
 	if (!res) {
 		return std::shared_ptr<Texture>();
 	}
 	if (res->getType() == ResType::FRAMEBUFFER) {
-		return std::static_pointer_cast<Framebuffer>(res)->getTexRes();
+		return std::static_pointer_cast<Framebuffer>(res)->getTexRes(fbAttachment);
+	}
+	if (res->getType() == ResType::TEXTURE_ATLAS) {
+		return std::static_pointer_cast<TextureAtlas>(res)->getTexture();
 	}
 	if (res->getType() != ResType::TEXTURE) {
 		return std::shared_ptr<Texture>();
@@ -192,3 +557,47 @@ std::shared_ptr<gs::Framebuffer> gs::ResourceManager::getFramebufferByIdNumber(T
 	}
 	return std::static_pointer_cast<Framebuffer>(res);
 }
+
+std::shared_ptr<gs::TextureAtlas> gs::ResourceManager::getTextureAtlasByIdName(const std::string& idName) const
+{
+	std::shared_ptr<Resource> res = getResourceByIdName(idName);
+	if (!res || res->getType() != ResType::TEXTURE_ATLAS) {
+		return std::shared_ptr<TextureAtlas>();
+	}
+	return std::static_pointer_cast<TextureAtlas>(res);
+}
+
+std::shared_ptr<gs::TextureAtlas> gs::ResourceManager::getTextureAtlasByIdNumber(TResourceId idNumber) const
+{
+	std::shared_ptr<Resource> res = getResourceByIdNumber(idNumber);
+	if (!res || res->getType() != ResType::TEXTURE_ATLAS) {
+		return std::shared_ptr<TextureAtlas>();
+	}
+	return std::static_pointer_cast<TextureAtlas>(res);
+}
+
+gs::Texture* gs::ResourceManager::getTexturePtrByIdNumber(TResourceId idNumber,
+		unsigned int fbAttachment) const
+{
+	Texture* tex = getPtrByIdNumber(mTexturePtrs, idNumber);
+	if (tex) {
+		return tex;
+	}
+	// framebuffer and texture atlas are not so often used as textures
+	size_t index = size_t(idNumber - FIRST_RESOURCE_ID);
+	if (index >= mResources.size()) {
+		return nullptr;
+	}
+	const Resource* res = mResources[index].get();
+	if (!res) {
+		return nullptr;
+	}
+	if (res->getType() == ResType::FRAMEBUFFER) {
+		// the texture is owned by the framebuffer
+		return static_cast<const Framebuffer*>(res)->getTexRes(fbAttachment).get();
+	}
+	if (res->getType() == ResType::TEXTURE_ATLAS) {
+		return static_cast<const TextureAtlas*>(res)->getTexture().get();
+	}
+	return nullptr;
+}
@@ -0,0 +1,213 @@
+#include <gs/res/shader_binary_cache.h>
+#include <gs/res/shader_info.h>
+#include <gs/common/fs.h>
+#include <gs/common/hash.h>
+#include <gs/system/log.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+namespace gs
+{
+	namespace
+	{
+		/**
+		 * Header of a cache file (16 bytes). The binary follows directly
+		 * after the header.
+		 */
+		struct CacheFileHeader
+		{
+			char mMagic[4]; // "GSSB"
+			uint32_t mVersion;
+			uint32_t mFormat; // binary format of glGetProgramBinary()
+			uint32_t mDataSize;
+		};
+
+		std::string getGlString(GLenum name)
+		{
+			const GLubyte* str = glGetString(name);
+			return str ? reinterpret_cast<const char*>(str) : "";
+		}
+	}
+}
+
+gs::ShaderBinaryCache::ShaderBinaryCache()
+		:mDirectory(), mBinaries(), mHitCount(0), mMissCount(0)
+{
+}
+
+gs::ShaderBinaryCache::~ShaderBinaryCache()
+{
+}
+
+bool gs::ShaderBinaryCache::setDirectory(const std::string& directory)
+{
+	if (directory.empty()) {
+		mDirectory.clear();
+		return true;
+	}
+	std::string dir = fs::getRemoveEndingSlashes(directory, '/');
+	if (!fs::createDirectory(dir)) {
+		LOGE("Can't create shader cache directory '%s'\n", dir.c_str());
+		mDirectory.clear();
+		return false;
+	}
+	mDirectory = dir;
+	return true;
+}
+
+bool gs::ShaderBinaryCache::isSupported()
+{
+#ifdef GLSLSCENE_USE_GLEW
+	if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary) {
+		return false;
+	}
+	// e.g. some drivers support the extension without any format
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+	return formatCount > 0;
+#else
+	return false;
+#endif
+}
+
+uint64_t gs::ShaderBinaryCache::calcKey(const std::vector<ShaderLoadInfo>& shaderSources,
+		const std::vector<Attribute>& attributes)
+{
+	uint64_t key = hash::FNV_OFFSET_BASIS;
+	key = hash::hashU32(key, FILE_VERSION);
+	// a binary is only valid for the same driver
+	key = hash::hashString(key, getGlString(GL_VENDOR));
+	key = hash::hashString(key, getGlString(GL_RENDERER));
+	key = hash::hashString(key, getGlString(GL_VERSION));
+	for (const ShaderLoadInfo& info : shaderSources) {
+		key = hash::hashU32(key, static_cast<uint32_t>(info.getShaderType()));
+		key = hash::hashString(key, info.getFilenameOrSource());
+	}
+	for (const Attribute& a : attributes) {
+		key = hash::hashString(key, a.mName);
+	}
+	return key;
+}
+
+GLuint gs::ShaderBinaryCache::loadProgram(uint64_t key)
+{
+	auto it = mBinaries.find(key);
+	if (it == mBinaries.end()) {
+		Binary binary;
+		if (mDirectory.empty() || !readFile(key, binary)) {
+			++mMissCount;
+			return 0;
+		}
+		it = mBinaries.emplace(key, std::move(binary)).first;
+	}
+	const Binary& binary = it->second;
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, binary.mFormat, binary.mData.data(),
+			static_cast<GLsizei>(binary.mData.size()));
+	GLint isLinked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &isLinked);
+	if (isLinked == GL_FALSE) {
+		// e.g. the driver is updated without a change of the version string
+		LOGW("shader binary %016" PRIx64 " is rejected by the driver --> compile from source\n", key);
+		glDeleteProgram(program);
+		mBinaries.erase(it);
+		if (!mDirectory.empty()) {
+			remove(getCacheFilename(key).c_str());
+		}
+		++mMissCount;
+		return 0;
+	}
+	++mHitCount;
+	return program;
+}
+
+bool gs::ShaderBinaryCache::storeProgram(uint64_t key, GLuint program)
+{
+	GLint size = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+	if (size <= 0) {
+		return false;
+	}
+	Binary binary;
+	binary.mData.resize(size);
+	GLsizei length = 0;
+	glGetProgramBinary(program, size, &length, &binary.mFormat, binary.mData.data());
+	if (length <= 0) {
+		return false;
+	}
+	binary.mData.resize(length);
+	if (!mDirectory.empty()) {
+		writeFile(key, binary);
+	}
+	mBinaries[key] = std::move(binary);
+	return true;
+}
+
+void gs::ShaderBinaryCache::prepareProgramForLinking(GLuint program)
+{
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+std::string gs::ShaderBinaryCache::getCacheFilename(uint64_t key) const
+{
+	char name[32];
+	snprintf(name, 32, "%016" PRIx64 ".gssb", key);
+	return mDirectory + "/" + name;
+}
+
+bool gs::ShaderBinaryCache::readFile(uint64_t key, Binary& outBinary) const
+{
+	std::string cacheFilename = getCacheFilename(key);
+	FILE* f = fopen(cacheFilename.c_str(), "rb");
+	if (!f) {
+		return false; // not cached
+	}
+	CacheFileHeader header;
+	if (fread(&header, sizeof(header), 1, f) != 1 ||
+			memcmp(header.mMagic, "GSSB", 4) != 0 ||
+			header.mVersion != FILE_VERSION || !header.mDataSize) {
+		LOGW("Shader cache file '%s' is invalid\n", cacheFilename.c_str());
+		fclose(f);
+		return false;
+	}
+	outBinary.mFormat = header.mFormat;
+	outBinary.mData.resize(header.mDataSize);
+	if (fread(outBinary.mData.data(), 1, header.mDataSize, f) != header.mDataSize) {
+		LOGW("Shader cache file '%s' is truncated\n", cacheFilename.c_str());
+		fclose(f);
+		return false;
+	}
+	fclose(f);
+	return true;
+}
+
+bool gs::ShaderBinaryCache::writeFile(uint64_t key, const Binary& binary) const
+{
+	std::string cacheFilename = getCacheFilename(key);
+	// write into a temporary file first. Otherwise another process could
+	// read a half written cache file.
+	std::string tmpFilename = cacheFilename + ".tmp";
+	FILE* f = fopen(tmpFilename.c_str(), "wb");
+	if (!f) {
+		LOGW("Can't create shader cache file '%s'\n", tmpFilename.c_str());
+		return false;
+	}
+	CacheFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.mMagic, "GSSB", 4);
+	header.mVersion = FILE_VERSION;
+	header.mFormat = binary.mFormat;
+	header.mDataSize = static_cast<uint32_t>(binary.mData.size());
+	bool success = fwrite(&header, sizeof(header), 1, f) == 1 &&
+			fwrite(binary.mData.data(), 1, binary.mData.size(), f) == binary.mData.size();
+	if (fclose(f) != 0) {
+		success = false;
+	}
+	if (!success || rename(tmpFilename.c_str(), cacheFilename.c_str()) != 0) {
+		LOGW("Can't write shader cache file '%s'\n", cacheFilename.c_str());
+		remove(tmpFilename.c_str());
+		return false;
+	}
+	return true;
+}
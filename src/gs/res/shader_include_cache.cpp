@@ -0,0 +1,232 @@
+#include <gs/res/shader_include_cache.h>
+#include <gs/res/shader_program.h>
+#include <gs/system/file_change_monitoring.h>
+#include <gs/common/fs.h>
+#include <gs/system/log.h>
+#include <algorithm>
+
+namespace gs
+{
+	namespace
+	{
+		// directory of the file with an ending slash. Empty for a file
+		// without directory (e.g. "noise.glsl") or for an inline source.
+		std::string getIncludeDir(const std::string& filename)
+		{
+			if (filename.find('/') == std::string::npos) {
+				return "";
+			}
+			return fs::getDirnameFromPath(filename);
+		}
+
+		/**
+		 * Check if the line is an include directive.
+		 * @return 1 for an include (outName is set), 0 for no include,
+		 *         -1 for an include with a wrong syntax.
+		 */
+		int parseIncludeLine(const std::string& line, std::string& outName)
+		{
+			size_t pos = line.find_first_not_of(" \t");
+			if (pos == std::string::npos || line[pos] != '#') {
+				return 0;
+			}
+			pos = line.find_first_not_of(" \t", pos + 1);
+			if (pos == std::string::npos || line.compare(pos, 7, "include") != 0) {
+				return 0;
+			}
+			pos = line.find_first_not_of(" \t", pos + 7);
+			if (pos == std::string::npos || (line[pos] != '"' && line[pos] != '<')) {
+				return -1;
+			}
+			char endCh = (line[pos] == '"') ? '"' : '>';
+			size_t endPos = line.find(endCh, pos + 1);
+			if (endPos == std::string::npos || endPos == pos + 1) {
+				return -1;
+			}
+			outName = line.substr(pos + 1, endPos - pos - 1);
+			return 1;
+		}
+	}
+}
+
+gs::ShaderIncludeCache::ShaderIncludeCache(const std::weak_ptr<FileChangeMonitoring>& fcm)
+		:mFileMonitoring(fcm), mFiles(), mMonitoredFiles(), mDependents(), mDependencies()
+{
+}
+
+gs::ShaderIncludeCache::~ShaderIncludeCache()
+{
+	std::shared_ptr<FileChangeMonitoring> fcm(mFileMonitoring.lock());
+	if (!fcm) {
+		return;
+	}
+	for (const auto& file : mMonitoredFiles) {
+		fcm->removeFile(file.second);
+	}
+}
+
+bool gs::ShaderIncludeCache::preprocess(const std::string& source,
+		const std::string& filename, std::string& outSource,
+		std::set<std::string>& outIncludedFiles)
+{
+	std::vector<std::string> includeStack;
+	includeStack.push_back(filename);
+	// index of a file is the source string number of the #line directives
+	std::vector<std::string> fileOrder;
+	fileOrder.push_back(filename);
+	outSource.clear();
+	outSource.reserve(source.size());
+	bool success = preprocessFile(source, filename, 0, includeStack, fileOrder, outSource);
+	// also if not successful --> a missing file can be created later
+	for (size_t i = 1; i < fileOrder.size(); ++i) {
+		outIncludedFiles.insert(fileOrder[i]);
+	}
+	if (!success) {
+		return false;
+	}
+	if (fileOrder.size() > 1) {
+		for (size_t i = 0; i < fileOrder.size(); ++i) {
+			LOGI("shader source string %zu: %s\n", i,
+					fileOrder[i].empty() ? "<inline source>" : fileOrder[i].c_str());
+		}
+	}
+	return true;
+}
+
+void gs::ShaderIncludeCache::setDependencies(ShaderProgram* program,
+		const std::set<std::string>& files)
+{
+	removeDependencies(program);
+	if (files.empty()) {
+		return;
+	}
+	for (const std::string& file : files) {
+		mDependents[file].insert(program);
+	}
+	mDependencies[program] = files;
+}
+
+void gs::ShaderIncludeCache::removeDependencies(ShaderProgram* program)
+{
+	auto it = mDependencies.find(program);
+	if (it == mDependencies.end()) {
+		return;
+	}
+	for (const std::string& file : it->second) {
+		auto depIt = mDependents.find(file);
+		if (depIt == mDependents.end()) {
+			continue;
+		}
+		depIt->second.erase(program);
+		if (depIt->second.empty()) {
+			mDependents.erase(depIt);
+		}
+	}
+	mDependencies.erase(it);
+}
+
+const std::string* gs::ShaderIncludeCache::getFile(const std::string& filename)
+{
+	auto it = mFiles.find(filename);
+	if (it != mFiles.end()) {
+		return &it->second;
+	}
+	if (mMonitoredFiles.find(filename) == mMonitoredFiles.end()) {
+		// also monitored if the file doesn't exist yet (can be created later)
+		std::shared_ptr<FileChangeMonitoring> fcm(mFileMonitoring.lock());
+		unsigned int callbackId = fcm ?
+				fcm->addFile(filename, fileChangedCb, std::shared_ptr<void>(), this,
+						FileChangeMonitoring::DEFAULT_SETTLE_MSEC, true) : 0;
+		if (callbackId) {
+			mMonitoredFiles[filename] = callbackId;
+		}
+	}
+	std::string content = fs::readFileAsString(filename);
+	if (content.empty()) {
+		return nullptr;
+	}
+	return &(mFiles[filename] = std::move(content));
+}
+
+bool gs::ShaderIncludeCache::preprocessFile(const std::string& source,
+		const std::string& filename, unsigned int fileIndex,
+		std::vector<std::string>& includeStack,
+		std::vector<std::string>& fileOrder, std::string& outSource)
+{
+	const char* name = filename.empty() ? "<inline source>" : filename.c_str();
+	std::string dir = getIncludeDir(filename);
+	unsigned int lineNumber = 0;
+	size_t lineStart = 0;
+	while (lineStart < source.size()) {
+		size_t lineEnd = source.find('\n', lineStart);
+		if (lineEnd == std::string::npos) {
+			lineEnd = source.size();
+		}
+		std::string line = source.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+		++lineNumber;
+
+		std::string includeName;
+		int rv = parseIncludeLine(line, includeName);
+		if (rv == 0) {
+			outSource += line;
+			outSource += '\n';
+			continue;
+		}
+		if (rv < 0) {
+			LOGE("%s:%u: wrong #include syntax. Should be #include \"<filename>\"\n",
+					name, lineNumber);
+			return false;
+		}
+		std::string includeFilename = (includeName[0] == '/') ? includeName : dir + includeName;
+		if (std::find(includeStack.begin(), includeStack.end(), includeFilename) != includeStack.end()) {
+			LOGE("%s:%u: recursive #include of %s\n", name, lineNumber, includeFilename.c_str());
+			return false;
+		}
+		if (std::find(fileOrder.begin(), fileOrder.end(), includeFilename) != fileOrder.end()) {
+			// already included --> only once (empty line to keep the line numbers)
+			outSource += '\n';
+			continue;
+		}
+		unsigned int includeIndex = static_cast<unsigned int>(fileOrder.size());
+		fileOrder.push_back(includeFilename);
+		const std::string* content = getFile(includeFilename);
+		if (!content) {
+			LOGE("%s:%u: can't include %s (or file is empty)\n",
+					name, lineNumber, includeFilename.c_str());
+			return false;
+		}
+		includeStack.push_back(includeFilename);
+		outSource += "#line 1 " + std::to_string(includeIndex) + "\n";
+		// the pointer is still valid if a nested getFile() add files to mFiles
+		if (!preprocessFile(*content, includeFilename, includeIndex,
+				includeStack, fileOrder, outSource)) {
+			return false;
+		}
+		includeStack.pop_back();
+		outSource += "#line " + std::to_string(lineNumber + 1) + " " +
+				std::to_string(fileIndex) + "\n";
+	}
+	return true;
+}
+
+void gs::ShaderIncludeCache::fileChangedCb(unsigned int callbackId,
+		const std::string& filename,
+		const std::shared_ptr<void>& unused, void* thisCache)
+{
+	static_cast<ShaderIncludeCache*>(thisCache)->fileChanged(filename);
+}
+
+void gs::ShaderIncludeCache::fileChanged(const std::string& filename)
+{
+	mFiles.erase(filename);
+	auto it = mDependents.find(filename);
+	if (it == mDependents.end()) {
+		return;
+	}
+	LOGI("hot reloading: %s is included by %zu shader programs\n",
+			filename.c_str(), it->second.size());
+	for (ShaderProgram* program : it->second) {
+		program->requestReload();
+	}
+}
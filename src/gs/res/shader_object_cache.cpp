@@ -0,0 +1,170 @@
+#include <gs/res/shader_object_cache.h>
+#include <gs/common/hash.h>
+#include <gs/system/log.h>
+#include <vector>
+
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0 // for not supported
+#endif
+#ifndef GL_TESS_CONTROL_SHADER
+#define GL_TESS_CONTROL_SHADER 0 // for not supported
+#endif
+#ifndef GL_TESS_EVALUATION_SHADER
+#define GL_TESS_EVALUATION_SHADER 0 // for not supported
+#endif
+#ifndef GL_GEOMETRY_SHADER
+#define GL_GEOMETRY_SHADER 0 // for not supported
+#endif
+
+namespace gs
+{
+	namespace
+	{
+		GLuint getGlShaderType(ShaderType shaderType)
+		{
+			switch (shaderType) {
+				case ShaderType::COMPUTE_SHADER:
+					return GL_COMPUTE_SHADER;
+				case ShaderType::VERTEX_SHADER:
+					return GL_VERTEX_SHADER;
+				case ShaderType::TESS_CONTROL_SHADER:
+					return GL_TESS_CONTROL_SHADER;
+				case ShaderType::TESS_EVALUATION_SHADER:
+					return GL_TESS_EVALUATION_SHADER;
+				case ShaderType::GEOMETRY_SHADER:
+					return GL_GEOMETRY_SHADER;
+				case ShaderType::FRAGMENT_SHADER:
+					return GL_FRAGMENT_SHADER;
+			}
+			return 0;
+		}
+
+		std::string getShaderTypeAsString(ShaderType shaderType)
+		{
+			switch (shaderType) {
+				case ShaderType::COMPUTE_SHADER:
+					return "COMPUTE SHADER";
+				case ShaderType::VERTEX_SHADER:
+					return "VERTEX SHADER";
+				case ShaderType::TESS_CONTROL_SHADER:
+					return "TESS CONTROL SHADER";
+				case ShaderType::TESS_EVALUATION_SHADER:
+					return "TESS EVALUATION SHADER";
+				case ShaderType::GEOMETRY_SHADER:
+					return "GEOMETRY SHADER";
+				case ShaderType::FRAGMENT_SHADER:
+					return "FRAGMENT SHADER";
+			}
+			return "unknown";
+		}
+
+		// glCompileShader() without checking the result (see isShaderCompiled())
+		GLuint startCompileShader(ShaderType shaderType, const std::string& sourceCode)
+		{
+			GLuint glShaderType = getGlShaderType(shaderType);
+			if (!glShaderType) {
+				LOGE("%s is not supported\n", getShaderTypeAsString(shaderType).c_str());
+				return 0;
+			}
+			GLuint shader = glCreateShader(glShaderType);
+
+			// Get strings for glShaderSource.
+			const char* source = sourceCode.c_str();
+			glShaderSource(shader, 1, &source, nullptr);
+
+			glCompileShader(shader);
+			return shader;
+		}
+
+		// wait for the compiling if it is not done yet
+		bool isShaderCompiled(ShaderType shaderType, GLuint shader)
+		{
+			GLint isCompiled = 0;
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
+			if(isCompiled == GL_FALSE)
+			{
+				GLint maxLength = 0;
+				glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
+
+				// The maxLength includes the NULL character
+				std::vector<GLchar> errorLog(maxLength);
+				glGetShaderInfoLog(shader, maxLength, &maxLength, &errorLog[0]);
+
+				LOGE("compile error for %s:\n%s\n",
+						getShaderTypeAsString(shaderType).c_str(), errorLog.data());
+				return false;
+			}
+			return true;
+		}
+	}
+}
+
+gs::ShaderObjectCache::ShaderObjectCache()
+		:mShaders(), mCompileCount(0), mReuseCount(0)
+{
+}
+
+gs::ShaderObjectCache::~ShaderObjectCache()
+{
+	for (auto& it : mShaders) {
+		glDeleteShader(it.second.mShader);
+	}
+}
+
+uint64_t gs::ShaderObjectCache::calcKey(ShaderType shaderType, const std::string& source)
+{
+	uint64_t key = hash::FNV_OFFSET_BASIS;
+	key = hash::hashU32(key, static_cast<uint32_t>(shaderType));
+	return hash::hashString(key, source);
+}
+
+GLuint gs::ShaderObjectCache::acquire(ShaderType shaderType,
+		const std::string& source, uint64_t& outKey)
+{
+	outKey = calcKey(shaderType, source);
+	auto it = mShaders.find(outKey);
+	if (it != mShaders.end()) {
+		++it->second.mUseCount;
+		++mReuseCount;
+		return it->second.mShader;
+	}
+	GLuint shader = startCompileShader(shaderType, source);
+	if (!shader) {
+		return 0;
+	}
+	++mCompileCount;
+	Entry& entry = mShaders[outKey];
+	entry.mShader = shader;
+	entry.mType = shaderType;
+	entry.mUseCount = 1;
+	return shader;
+}
+
+void gs::ShaderObjectCache::release(uint64_t key)
+{
+	auto it = mShaders.find(key);
+	if (it == mShaders.end()) {
+		return;
+	}
+	if (it->second.mUseCount > 1) {
+		--it->second.mUseCount;
+		return;
+	}
+	// a shader object which is still attached to a program is deleted
+	// by the driver after it's detached
+	glDeleteShader(it->second.mShader);
+	mShaders.erase(it);
+}
+
+bool gs::ShaderObjectCache::isCompiled(uint64_t key)
+{
+	auto it = mShaders.find(key);
+	if (it == mShaders.end()) {
+		return false;
+	}
+	Entry& entry = it->second;
+	if (entry.mCompileStatus < 0) {
+		entry.mCompileStatus = isShaderCompiled(entry.mType, entry.mShader) ? 1 : 0;
+	}
+	return entry.mCompileStatus == 1;
+}
@@ -1,124 +1,41 @@
 #include <gs/res/shader_program.h>
+#include <gs/res/shader_binary_cache.h>
+#include <gs/res/shader_include_cache.h>
+#include <gs/res/shader_object_cache.h>
 #include <gs/system/log.h>
 #include <gs/common/fs.h>
 #include <gs/rendering/gl_api.h>
+#include <gs/rendering/render_statistic.h>
 #include <gs/res/uniform.h>
 #include <gs/rendering/properties.h>
 #include <gs/rendering/matrices.h>
 #include <glm/gtc/type_ptr.hpp>
+#include <set>
 
-#ifndef GL_COMPUTE_SHADER
-#define GL_COMPUTE_SHADER 0 // for not supported
-#endif
-#ifndef GL_TESS_CONTROL_SHADER
-#define GL_TESS_CONTROL_SHADER 0 // for not supported
-#endif
-#ifndef GL_TESS_EVALUATION_SHADER
-#define GL_TESS_EVALUATION_SHADER 0 // for not supported
-#endif
-#ifndef GL_GEOMETRY_SHADER
-#define GL_GEOMETRY_SHADER 0 // for not supported
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1 // same value for the ARB extension
 #endif
 
 namespace gs
 {
 	namespace
 	{
-		GLuint getGlShaderType(ShaderType shaderType)
-		{
-			switch (shaderType) {
-				case ShaderType::COMPUTE_SHADER:
-					return GL_COMPUTE_SHADER;
-				case ShaderType::VERTEX_SHADER:
-					return GL_VERTEX_SHADER;
-				case ShaderType::TESS_CONTROL_SHADER:
-					return GL_TESS_CONTROL_SHADER;
-				case ShaderType::TESS_EVALUATION_SHADER:
-					return GL_TESS_EVALUATION_SHADER;
-				case ShaderType::GEOMETRY_SHADER:
-					return GL_GEOMETRY_SHADER;
-				case ShaderType::FRAGMENT_SHADER:
-					return GL_FRAGMENT_SHADER;
-			}
-			return 0;
-		}
-
-		std::string getShaderTypeAsString(ShaderType shaderType)
-		{
-			switch (shaderType) {
-				case ShaderType::COMPUTE_SHADER:
-					return "COMPUTE SHADER";
-				case ShaderType::VERTEX_SHADER:
-					return "VERTEX SHADER";
-				case ShaderType::TESS_CONTROL_SHADER:
-					return "TESS CONTROL SHADER";
-				case ShaderType::TESS_EVALUATION_SHADER:
-					return "TESS EVALUATION SHADER";
-				case ShaderType::GEOMETRY_SHADER:
-					return "GEOMETRY SHADER";
-				case ShaderType::FRAGMENT_SHADER:
-					return "FRAGMENT SHADER";
-			}
-			return "unknown";
-		}
-
-		GLuint createAndLoadShader(ShaderType shaderType, const std::string& sourceCode)
+		bool isParallelShaderCompileSupported()
 		{
-			GLuint glShaderType = getGlShaderType(shaderType);
-			if (!glShaderType) {
-				return 0;
-			}
-			GLuint shader = glCreateShader(glShaderType);
-
-			// Get strings for glShaderSource.
-			const char* source = sourceCode.c_str();
-			glShaderSource(shader, 1, &source, nullptr);
-
-			glCompileShader(shader);
-
-			GLint isCompiled = 0;
-			glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
-			if(isCompiled == GL_FALSE)
-			{
-				GLint maxLength = 0;
-				glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
-
-				// The maxLength includes the NULL character
-				std::vector<GLchar> errorLog(maxLength);
-				glGetShaderInfoLog(shader, maxLength, &maxLength, &errorLog[0]);
-
-				LOGE("compile error for %s:\n%s\n",
-						getShaderTypeAsString(shaderType).c_str(), errorLog.data());
-
-				// Exit with failure.
-				glDeleteShader(shader); // Don't leak the shader.
-				return 0;
-			}
-
-			return shader;
+#ifdef GLSLSCENE_USE_GLEW
+			return GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+#else
+			return false;
+#endif
 		}
 
-		GLuint createAndCompileShaderProgram(const std::vector<ShaderLoadInfo>& shaderSources)
+		/**
+		 * glLinkProgram() without checking the result (see isShaderProgramLinked()).
+		 * @param isRetrievable If true then the binary of the linked program
+		 *        can be stored by the shader binary cache.
+		 */
+		GLuint startLinkShaderProgram(const std::vector<GLuint>& shaders, bool isRetrievable)
 		{
-			std::vector<GLuint> shaders;
-			shaders.resize(shaderSources.size(), 0);
-			unsigned int i = 0;
-			for (const auto& info : shaderSources) {
-				shaders[i] = createAndLoadShader(info.getShaderType(), info.getFilenameOrSource());
-				if (!shaders[i]) {
-					break;
-				}
-				++i;
-			}
-			if (i != shaderSources.size()) {
-				// i has now the index of the failed shader (which need not to be deleted
-				// because it was not created)
-				for (unsigned int ii = 0; ii < i; ++ii) {
-					glDeleteShader(shaders[ii]);
-				}
-				return 0;
-			}
-
 			GLuint program = glCreateProgram();
 
 			// Attach our shaders to our program
@@ -126,9 +43,18 @@ namespace gs
 				glAttachShader(program, shaderId);
 			}
 
+			if (isRetrievable) {
+				ShaderBinaryCache::prepareProgramForLinking(program);
+			}
+
 			// Link our program
 			glLinkProgram(program);
+			return program;
+		}
 
+		// wait for the linking if it is not done yet
+		bool isShaderProgramLinked(GLuint program)
+		{
 			// Note the different functions here: glGetProgram* instead of glGetShader*.
 			GLint isLinked = 0;
 			glGetProgramiv(program, GL_LINK_STATUS, (int *)&isLinked);
@@ -141,31 +67,26 @@ namespace gs
 				std::vector<GLchar> infoLog(maxLength);
 				glGetProgramInfoLog(program, maxLength, &maxLength, &infoLog[0]);
 
-				// We don't need the program anymore.
-				glDeleteProgram(program);
-				// Don't leak shaders either.
-				for (GLuint shaderId : shaders) {
-					glDeleteShader(shaderId);
-				}
-
 				// Use the infoLog as you see fit.
 				LOGE("linking error:\n%s\n", infoLog.data());
-
-				// In this simple program, we'll just leave
-				return 0;
+				return false;
 			}
+			return true;
+		}
 
-			// Always detach shaders after a successful link.
-			for (GLuint shaderId : shaders) {
-				glDetachShader(program, shaderId);
+		// the shader objects are kept by the shader object cache
+		void detachAllShaders(GLuint program)
+		{
+			GLint count = 0;
+			glGetProgramiv(program, GL_ATTACHED_SHADERS, &count);
+			if (count <= 0) {
+				return;
 			}
-
-			// also delete the shader objects because they are not used for other shader programs
-			for (GLuint shaderId : shaders) {
-				glDeleteShader(shaderId);
+			std::vector<GLuint> shaders(count);
+			glGetAttachedShaders(program, count, &count, shaders.data());
+			for (GLint i = 0; i < count; ++i) {
+				glDetachShader(program, shaders[i]);
 			}
-
-			return program;
 		}
 
 		bool loadAttributeLocations(GLuint shaderProgramId, std::vector<Attribute>& attributes)
@@ -245,151 +166,214 @@ namespace gs
 			}
 		}
 
-		void applyUniformValues(const std::vector<Uniform>& uniforms, const Properties& p, const Matrices& m)
-		{
-			for (const Uniform& u : uniforms) {
-				switch (u.mSource) {
-					case UniformSource::INVALID:
-						LOGW("Uniform with invalid source.\n");
-						break;
-					// no value used
-					case UniformSource::ABSOLUTE_TIME_SEC:
-						setUniformFromFloat(u, p.mTsSec, 0.0f, 0.0f, 0.0f);
-						break;
-					// using mFloat to store the reference time as seconds (time relative to start time)
-					case UniformSource::RELATIVE_TIME_SEC:
-						setUniformFromFloat(u, p.mTsSec - u.mValue.mFloat, 0.0f, 0.0f, 0.0f);
-						break;
-					// no value used
-					case UniformSource::DELTA_TIME_SEC:
-						setUniformFromFloat(u, p.mDeltaTimeSec, 0.0f, 0.0f, 0.0f);
-						break;
-					// no value used
-					case UniformSource::MOUSE_POS_FACTOR:
-						setUniformFromFloat(u, p.mMousePosFactor.x, p.mMousePosFactor.y, 0.0f, 0.0f);
-						break;
-					// no value used
-					case UniformSource::MOUSE_POS_PIXEL:
-						setUniformFromFloat(u, p.mMousePosPixel.x, p.mMousePosPixel.y, 0.0f, 0.0f);
-						break;
-					// no value used
-					case UniformSource::VIEWPORT_POS_PIXEL:
-						setUniformFromFloat(u, p.mViewportPosPixel.x, p.mViewportPosPixel.y, 0.0f, 0.0f);
-						break;
-					// no value used
-					case UniformSource::VIEWPORT_SIZE_PIXEL:
-						setUniformFromFloat(u, p.mViewportSizePixel.mWidth, p.mViewportSizePixel.mHeight, 0.0f, 0.0f);
-						break;
-					// no value used
-					case UniformSource::VIEW_SIZE:
-						setUniformFromFloat(u, p.mViewSize.x, p.mViewSize.y, p.mViewSize.z, 0.0f);
-						break;
-					// no value used
-					case UniformSource::VIEW_RATIO:
-						setUniformFromFloat(u, p.mViewRatio.mWidth, p.mViewRatio.mHeight, 0.0f, 0.0f);
-						break;
-					case UniformSource::PROJECTION_MATRIX:
-						if (u.mInverse) {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(glm::inverse(p.mProjectionMatrix)));
-						}
-						else {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(p.mProjectionMatrix));
-						}
-						break;
-					case UniformSource::VIEW_MATRIX:
-						if (u.mInverse) {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(glm::inverse(p.mViewMatrix)));
-						}
-						else {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(p.mViewMatrix));
-						}
-						break;
-					case UniformSource::MODEL_MATRIX:
-						if (u.mInverse) {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(glm::inverse(m.mModelMatrix)));
-						}
-						else {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(m.mModelMatrix));
-						}
-						break;
-					case UniformSource::MODEL_VIEW_MATRIX:
-						if (u.mInverse) {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(glm::inverse(m.mModelViewMatrix)));
-						}
-						else {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(m.mModelViewMatrix));
-						}
-						break;
-					case UniformSource::ENTITY_MATRIX:
-						if (u.mInverse) {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(glm::inverse(m.mEntityMatrix)));
-						}
-						else {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(m.mEntityMatrix));
-						}
-						break;
-					case UniformSource::MVP_MATRIX:
-						if (u.mInverse) {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(glm::inverse(m.mMvpMatrix)));
-						}
-						else {
-							glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(m.mMvpMatrix));
-						}
-						break;
-					// value is used (which one depends on UniformType)
-					case UniformSource::CUSTOM_VALUE:
-						if (u.mLocation == -1) {
-							break;
-						}
-						switch (u.mType) {
-							case UniformType::INVALID:
-								LOGW("Uniform with invalid type.\n");
-								break;
-							case UniformType::INT:
-							case UniformType::SAMPLER2D:
-								glUniform1i(u.mLocation, u.mValue.mInt);
-								break;
-							case UniformType::FLOAT:
-								glUniform1f(u.mLocation, u.mValue.mFloat);
-								break;
-							case UniformType::VEC2:
-								glUniform2f(u.mLocation, u.mValue.mVec2.x, u.mValue.mVec2.y);
-								break;
-							case UniformType::VEC3:
-								glUniform3f(u.mLocation, u.mValue.mVec3.x, u.mValue.mVec3.y, u.mValue.mVec3.z);
-								break;
-							case UniformType::VEC4:
-								glUniform4f(u.mLocation, u.mValue.mVec4.x, u.mValue.mVec4.y, u.mValue.mVec4.z, u.mValue.mVec4.w);
-								break;
-							case UniformType::MAT4X4:
-								glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, u.mValue.mMat4.m);
-								break;
-						}
-						break;
-				}
+		void setUniformFromMatrix(const Uniform& u, const glm::mat4& m)
+		{
+			if (u.mInverse) {
+				glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(glm::inverse(m)));
+			}
+			else {
+				glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(m));
 			}
 		}
 
-		void applyUniformMatricesOnly(const std::vector<Uniform>& uniforms, const Matrices& m)
-		{
-			for (const Uniform& u : uniforms) {
-				switch (u.mSource) {
-					case UniformSource::MODEL_MATRIX:
-						glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(m.mModelMatrix));
-						break;
-					case UniformSource::MODEL_VIEW_MATRIX:
-						glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(m.mModelViewMatrix));
-						break;
-					case UniformSource::ENTITY_MATRIX:
-						glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(m.mEntityMatrix));
-						break;
-					case UniformSource::MVP_MATRIX:
-						glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, glm::value_ptr(m.mMvpMatrix));
-						break;
-					default:
-						break;
-				}
+		// setters for the uniform sources (selected once by getUniformSetFunc())
+
+		void setAbsoluteTimeSec(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromFloat(u, p.mTsSec, 0.0f, 0.0f, 0.0f);
+		}
+
+		void setRelativeTimeSec(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			// using mFloat to store the reference time as seconds (time relative to start time)
+			setUniformFromFloat(u, p.mTsSec - u.mValue.mFloat, 0.0f, 0.0f, 0.0f);
+		}
+
+		void setDeltaTimeSec(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromFloat(u, p.mDeltaTimeSec, 0.0f, 0.0f, 0.0f);
+		}
+
+		void setMousePosFactor(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromFloat(u, p.mMousePosFactor.x, p.mMousePosFactor.y, 0.0f, 0.0f);
+		}
+
+		void setMousePosPixel(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromFloat(u, p.mMousePosPixel.x, p.mMousePosPixel.y, 0.0f, 0.0f);
+		}
+
+		void setViewportPosPixel(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromFloat(u, p.mViewportPosPixel.x, p.mViewportPosPixel.y, 0.0f, 0.0f);
+		}
+
+		void setViewportSizePixel(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromFloat(u, p.mViewportSizePixel.mWidth, p.mViewportSizePixel.mHeight, 0.0f, 0.0f);
+		}
+
+		void setViewSize(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromFloat(u, p.mViewSize.x, p.mViewSize.y, p.mViewSize.z, 0.0f);
+		}
+
+		void setViewRatio(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromFloat(u, p.mViewRatio.mWidth, p.mViewRatio.mHeight, 0.0f, 0.0f);
+		}
+
+		void setProjectionMatrix(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromMatrix(u, p.mProjectionMatrix);
+		}
+
+		void setViewMatrix(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromMatrix(u, p.mViewMatrix);
+		}
+
+		void setModelMatrix(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromMatrix(u, m.mModelMatrix);
+		}
+
+		void setModelViewMatrix(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromMatrix(u, m.mModelViewMatrix);
+		}
+
+		void setEntityMatrix(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromMatrix(u, m.mEntityMatrix);
+		}
+
+		void setMvpMatrix(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			setUniformFromMatrix(u, m.mMvpMatrix);
+		}
+
+		void setCustomInt(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			glUniform1i(u.mLocation, u.mValue.mInt);
+		}
+
+		void setCustomFloat(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			glUniform1f(u.mLocation, u.mValue.mFloat);
+		}
+
+		void setCustomVec2(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			glUniform2f(u.mLocation, u.mValue.mVec2.x, u.mValue.mVec2.y);
+		}
+
+		void setCustomVec3(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			glUniform3f(u.mLocation, u.mValue.mVec3.x, u.mValue.mVec3.y, u.mValue.mVec3.z);
+		}
+
+		void setCustomVec4(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			glUniform4f(u.mLocation, u.mValue.mVec4.x, u.mValue.mVec4.y, u.mValue.mVec4.z, u.mValue.mVec4.w);
+		}
+
+		void setCustomMat4(const Uniform& u, const Properties& p, const Matrices& m)
+		{
+			glUniformMatrix4fv(u.mLocation, 1, GL_FALSE, u.mValue.mMat4.m);
+		}
+
+		typedef void (*TUniformSetFunc)(const Uniform& u, const Properties& p, const Matrices& m);
+
+		enum class UniformRate
+		{
+			PER_FRAME = 0,
+			PER_PASS,
+			PER_ENTITY,
+		};
+
+		/**
+		 * Select the setter and how often the uniform value can change.
+		 * The custom values are only changed by the logic and the GUI
+		 * --> not at rendering (per frame). The time is per pass because
+		 * a progressive pass use the time of its image.
+		 * @return null if the uniform is invalid.
+		 */
+		TUniformSetFunc getUniformSetFunc(const Uniform& u, UniformRate& outRate)
+		{
+			switch (u.mSource) {
+				case UniformSource::INVALID:
+					LOGW("Uniform %s with invalid source.\n", u.mName.c_str());
+					return nullptr;
+				case UniformSource::ABSOLUTE_TIME_SEC:
+					outRate = UniformRate::PER_PASS;
+					return setAbsoluteTimeSec;
+				case UniformSource::RELATIVE_TIME_SEC:
+					outRate = UniformRate::PER_PASS;
+					return setRelativeTimeSec;
+				case UniformSource::DELTA_TIME_SEC:
+					outRate = UniformRate::PER_FRAME;
+					return setDeltaTimeSec;
+				case UniformSource::MOUSE_POS_FACTOR:
+					outRate = UniformRate::PER_FRAME;
+					return setMousePosFactor;
+				case UniformSource::MOUSE_POS_PIXEL:
+					outRate = UniformRate::PER_FRAME;
+					return setMousePosPixel;
+				case UniformSource::VIEWPORT_POS_PIXEL:
+					outRate = UniformRate::PER_PASS;
+					return setViewportPosPixel;
+				case UniformSource::VIEWPORT_SIZE_PIXEL:
+					outRate = UniformRate::PER_PASS;
+					return setViewportSizePixel;
+				case UniformSource::VIEW_SIZE:
+					outRate = UniformRate::PER_PASS;
+					return setViewSize;
+				case UniformSource::VIEW_RATIO:
+					outRate = UniformRate::PER_PASS;
+					return setViewRatio;
+				case UniformSource::PROJECTION_MATRIX:
+					outRate = UniformRate::PER_PASS;
+					return setProjectionMatrix;
+				case UniformSource::VIEW_MATRIX:
+					outRate = UniformRate::PER_PASS;
+					return setViewMatrix;
+				case UniformSource::MODEL_MATRIX:
+					outRate = UniformRate::PER_ENTITY;
+					return setModelMatrix;
+				case UniformSource::MODEL_VIEW_MATRIX:
+					outRate = UniformRate::PER_ENTITY;
+					return setModelViewMatrix;
+				case UniformSource::ENTITY_MATRIX:
+					outRate = UniformRate::PER_ENTITY;
+					return setEntityMatrix;
+				case UniformSource::MVP_MATRIX:
+					outRate = UniformRate::PER_ENTITY;
+					return setMvpMatrix;
+				case UniformSource::CUSTOM_VALUE:
+					outRate = UniformRate::PER_FRAME;
+					switch (u.mType) {
+						case UniformType::INVALID:
+							LOGW("Uniform %s with invalid type.\n", u.mName.c_str());
+							return nullptr;
+						case UniformType::INT:
+						case UniformType::SAMPLER2D:
+							return setCustomInt;
+						case UniformType::FLOAT:
+							return setCustomFloat;
+						case UniformType::VEC2:
+							return setCustomVec2;
+						case UniformType::VEC3:
+							return setCustomVec3;
+						case UniformType::VEC4:
+							return setCustomVec4;
+						case UniformType::MAT4X4:
+							return setCustomMat4;
+					}
+					return nullptr;
 			}
+			return nullptr;
 		}
 	}
 }
@@ -397,13 +381,21 @@ namespace gs
 gs::ShaderProgram::ShaderProgram(const std::weak_ptr<FileChangeMonitoring>& fcm,
 		const ShaderProgramLoadInfo& shaderProgramLoadInfo)
 		:Resource(fcm), mShaderProgramLoadInfo(shaderProgramLoadInfo), mShaderSources(),
-		mAddedSourceFilesForHotReloading(false), mShaderProgramId(0)
+		mAddedSourceFilesForHotReloading(false), mReadSourceFiles(),
+		mBinaryCache(), mIncludeCache(),
+		// own cache if no shared cache is set (see setObjectCache())
+		mObjectCache(std::make_shared<ShaderObjectCache>()),
+		mShaderProgramId(0), mShaderKeys(),
+		mPendingProgramId(0), mPendingShaderKeys(), mPendingSources(), mPendingBinaryKey(0)
 {
 }
 
 gs::ShaderProgram::~ShaderProgram()
 {
 	unload();
+	if (mIncludeCache) {
+		mIncludeCache->removeDependencies(this);
+	}
 }
 
 gs::ResType gs::ShaderProgram::getType() const
@@ -413,17 +405,185 @@ gs::ResType gs::ShaderProgram::getType() const
 
 bool gs::ShaderProgram::load()
 {
-	const std::vector<ShaderLoadInfo>& shaderInfos = mShaderProgramLoadInfo.mShaderInfos;
+	cancelLoading();
+	mIsReloadRequested = false;
+
 	std::vector<ShaderLoadInfo> shaderSources;
+	if (!readShaderSources(shaderSources)) {
+		releaseHotReload();
+		return false;
+	}
+
+	GLuint shaderProgramId = 0;
+	bool useBinaryCache = mBinaryCache && ShaderBinaryCache::isSupported();
+	uint64_t binaryKey = 0;
+	if (useBinaryCache) {
+		binaryKey = ShaderBinaryCache::calcKey(shaderSources, mShaderProgramLoadInfo.mAttributes);
+		// no compiling if the sources are not changed (e.g. reload of the scene)
+		shaderProgramId = mBinaryCache->loadProgram(binaryKey);
+	}
+	std::vector<uint64_t> shaderKeys;
+	if (!shaderProgramId) {
+		shaderProgramId = startCompileAndLink(shaderSources, useBinaryCache, shaderKeys);
+		if (!shaderProgramId) {
+			releaseHotReload();
+			return false;
+		}
+		if (!isCompiledAndLinked(shaderProgramId, shaderKeys)) {
+			glDeleteProgram(shaderProgramId);
+			releaseShaders(shaderKeys);
+			releaseHotReload();
+			return false;
+		}
+		detachAllShaders(shaderProgramId);
+		if (useBinaryCache) {
+			mBinaryCache->storeProgram(binaryKey, shaderProgramId);
+		}
+	}
+	return applyLinkedProgram(shaderProgramId, shaderSources, shaderKeys);
+}
+
+bool gs::ShaderProgram::startLoading()
+{
+	if (!isParallelShaderCompileSupported()) {
+		return load();
+	}
+	cancelLoading();
+	mIsReloadRequested = false;
+
+	std::vector<ShaderLoadInfo> shaderSources;
+	if (!readShaderSources(shaderSources)) {
+		releaseHotReload();
+		return false;
+	}
+
+	bool useBinaryCache = mBinaryCache && ShaderBinaryCache::isSupported();
+	uint64_t binaryKey = 0;
+	if (useBinaryCache) {
+		binaryKey = ShaderBinaryCache::calcKey(shaderSources, mShaderProgramLoadInfo.mAttributes);
+		// loading a binary doesn't compile --> is fast enough to do it directly
+		GLuint shaderProgramId = mBinaryCache->loadProgram(binaryKey);
+		if (shaderProgramId) {
+			return applyLinkedProgram(shaderProgramId, shaderSources, std::vector<uint64_t>());
+		}
+	}
+
+	// The driver compiles and links with its own threads. The old program
+	// is used until finishLoading() apply the new program.
+	std::vector<uint64_t> shaderKeys;
+	mPendingProgramId = startCompileAndLink(shaderSources, useBinaryCache, shaderKeys);
+	if (!mPendingProgramId) {
+		releaseHotReload();
+		return false;
+	}
+	mPendingShaderKeys = shaderKeys;
+	mPendingSources = shaderSources;
+	mPendingBinaryKey = useBinaryCache ? binaryKey : 0;
+	return true;
+}
+
+bool gs::ShaderProgram::finishLoading()
+{
+	if (!mPendingProgramId) {
+		return true;
+	}
+	// GL_COMPLETION_STATUS_KHR doesn't block (unlike GL_LINK_STATUS)
+	GLint isCompleted = GL_FALSE;
+	glGetProgramiv(mPendingProgramId, GL_COMPLETION_STATUS_KHR, &isCompleted);
+	if (isCompleted == GL_FALSE) {
+		return false;
+	}
+	GLuint shaderProgramId = mPendingProgramId;
+	std::vector<uint64_t> shaderKeys;
+	shaderKeys.swap(mPendingShaderKeys);
+	std::vector<ShaderLoadInfo> shaderSources;
+	shaderSources.swap(mPendingSources);
+	uint64_t binaryKey = mPendingBinaryKey;
+	mPendingProgramId = 0;
+	mPendingBinaryKey = 0;
+	if (!isCompiledAndLinked(shaderProgramId, shaderKeys)) {
+		glDeleteProgram(shaderProgramId);
+		releaseShaders(shaderKeys);
+		if (mShaderProgramId) {
+			LOGE("Shader program can't be reloaded --> old program is used\n");
+		}
+		else {
+			LOGE("Shader program can't be compiled or linked\n");
+		}
+		releaseHotReload();
+		return true;
+	}
+	detachAllShaders(shaderProgramId);
+	if (binaryKey) {
+		mBinaryCache->storeProgram(binaryKey, shaderProgramId);
+	}
+	applyLinkedProgram(shaderProgramId, shaderSources, shaderKeys);
+	return true;
+}
+
+void gs::ShaderProgram::unload()
+{
+	cancelLoading();
+
+	resetUniformLocations(mShaderProgramLoadInfo.mUniforms);
+	resetAttributeLocations(mShaderProgramLoadInfo.mAttributes);
+
+	if (mShaderProgramId) {
+		glDeleteProgram(mShaderProgramId);
+		mShaderProgramId = 0;
+	}
+	releaseShaders(mShaderKeys);
+	mShaderSources.clear();
+	mFrameUniforms.clear();
+	mPassUniforms.clear();
+	mEntityUniforms.clear();
+}
+
+void gs::ShaderProgram::requestReload()
+{
+	mIsReloadRequested = true;
+	// e.g. an included file is changed (see ShaderIncludeCache)
+	attachToHotReload();
+}
+
+void gs::ShaderProgram::hotReloading(unsigned int callbackId, const std::string& filename)
+{
+	LOGI("hot reloading: recompile %s\n", filename.c_str());
+	// compile without blocking the frame. See ResourceManager::updateLoading().
+	requestReload();
+}
+
+void gs::ShaderProgram::readSourceFiles()
+{
+	const std::vector<ShaderLoadInfo>& shaderInfos = mShaderProgramLoadInfo.mShaderInfos;
+	mReadSourceFiles.assign(shaderInfos.size(), std::string());
+	for (size_t i = 0; i < shaderInfos.size(); ++i) {
+		if (shaderInfos[i].isFilename()) {
+			mReadSourceFiles[i] = fs::readFileAsString(shaderInfos[i].getFilenameOrSource());
+		}
+	}
+}
+
+bool gs::ShaderProgram::readShaderSources(std::vector<ShaderLoadInfo>& outShaderSources)
+{
+	const std::vector<ShaderLoadInfo>& shaderInfos = mShaderProgramLoadInfo.mShaderInfos;
+	std::vector<std::string> readSourceFiles;
+	readSourceFiles.swap(mReadSourceFiles);
+	std::vector<ShaderLoadInfo>& shaderSources = outShaderSources;
+	shaderSources.clear();
 	shaderSources.reserve(shaderInfos.size());
 	int i = 0;
 	bool loadAllFiles = true;
+	std::set<std::string> includedFiles;
 	for (const auto& info : shaderInfos) {
 		if (info.isFilename()) {
 			if (!mAddedSourceFilesForHotReloading) {
-				addFileForHotReloading(info.getFilenameOrSource());
+				addFileForHotReloading(info.getFilenameOrSource(), true);
 			}
-			std::string fileContent = fs::readFileAsString(info.getFilenameOrSource());
+			size_t infoIndex = size_t(&info - shaderInfos.data());
+			// already read by readSourceFiles()?
+			std::string fileContent = (infoIndex < readSourceFiles.size()) ?
+					readSourceFiles[infoIndex] : fs::readFileAsString(info.getFilenameOrSource());
 			if (fileContent.empty()) {
 				LOGE("Can't load %s (or file is empty)\n", info.getFilenameOrSource().c_str());
 				loadAllFiles = false;
@@ -434,146 +594,312 @@ bool gs::ShaderProgram::load()
 		else {
 			shaderSources.emplace_back(shaderInfos[i]);
 		}
+		if (mIncludeCache) {
+			std::string source;
+			if (!mIncludeCache->preprocess(shaderSources.back().getFilenameOrSource(),
+					info.isFilename() ? info.getFilenameOrSource() : "",
+					source, includedFiles)) {
+				loadAllFiles = false;
+			}
+			shaderSources.back() = ShaderLoadInfo(info.getShaderType(), source, false);
+		}
 		++i;
 	}
 	mAddedSourceFilesForHotReloading = true;
+	if (mIncludeCache) {
+		// a changed included file reloads this program
+		mIncludeCache->setDependencies(this, includedFiles);
+	}
 	if (!loadAllFiles) {
 		LOGE("Can't load one or more files for the shader program.\n");
 		return false;
 	}
+	return true;
+}
 
-	GLuint shaderProgramId = createAndCompileShaderProgram(shaderSources);
-	if (!shaderProgramId) {
-		return false;
-	}
-
+bool gs::ShaderProgram::applyLinkedProgram(GLuint shaderProgramId,
+		const std::vector<ShaderLoadInfo>& shaderSources,
+		const std::vector<uint64_t>& shaderKeys)
+{
+	// compiled and linked (or loaded from the binary cache)
+	markHotReloadLoaded();
+	std::vector<uint64_t> keys = shaderKeys;
 	std::vector<Uniform> uniforms = mShaderProgramLoadInfo.mUniforms;
 	if (!loadUniformLocations(shaderProgramId, uniforms)) {
+		glDeleteProgram(shaderProgramId);
+		releaseShaders(keys);
+		releaseHotReload();
 		return false;
 	}
 
 	std::vector<Attribute> attributes = mShaderProgramLoadInfo.mAttributes;
 	if (!loadAttributeLocations(shaderProgramId, attributes)) {
+		glDeleteProgram(shaderProgramId);
+		releaseShaders(keys);
+		releaseHotReload();
 		return false;
 	}
 
 	// --> loading was successful --> unload old shader and apply new loaded shader
+	// (the shader objects which are also used by the new program are kept
+	// because they are already acquired for the new program)
 
 	unload();
 
 	mShaderSources = shaderSources;
 	mShaderProgramId = shaderProgramId;
+	mShaderKeys = keys;
 	// copy the uniforms to update the new location uniforms
 	mShaderProgramLoadInfo.mUniforms = uniforms;
 	// copy the attributes to update the new location attributes
 	mShaderProgramLoadInfo.mAttributes = attributes;
 
-	++mLoadCounter;
+	// unique for all programs --> a mesh which is taken over by an
+	// incremental reload can't mix up a new program at the same address
+	static unsigned int loadCounter = 0;
+	mLoadCounter = ++loadCounter;
+	buildUniformTables();
+	markHotReloadUploaded();
 	return true;
 }
 
-void gs::ShaderProgram::unload()
+void gs::ShaderProgram::cancelLoading()
 {
-	resetUniformLocations(mShaderProgramLoadInfo.mUniforms);
-	resetAttributeLocations(mShaderProgramLoadInfo.mAttributes);
-
-	if (mShaderProgramId) {
-		glDeleteProgram(mShaderProgramId);
-		mShaderProgramId = 0;
+	if (!mPendingProgramId) {
+		return;
 	}
-	mShaderSources.clear();
+	glDeleteProgram(mPendingProgramId);
+	mPendingProgramId = 0;
+	releaseShaders(mPendingShaderKeys);
+	mPendingSources.clear();
+	mPendingBinaryKey = 0;
 }
 
-bool gs::ShaderProgram::changeUniformFloat(const std::string& name, float value)
+GLuint gs::ShaderProgram::startCompileAndLink(const std::vector<ShaderLoadInfo>& shaderSources,
+		bool isRetrievable, std::vector<uint64_t>& outShaderKeys)
 {
-	for (auto& u : mShaderProgramLoadInfo.mUniforms) {
-		if (u.mName == name) {
-			if (u.mType != UniformType::FLOAT) {
-				LOGE("Uniform value can't be changed. %s is not a float.\n", u.mName.c_str());
-				return false;
-			}
-			u.mValue.mFloat = value;
-			return true;
+	std::vector<GLuint> shaders;
+	for (const ShaderLoadInfo& info : shaderSources) {
+		uint64_t key = 0;
+		// only compiled if the source is not already compiled for another program
+		GLuint shader = mObjectCache->acquire(info.getShaderType(), info.getFilenameOrSource(), key);
+		if (!shader) {
+			releaseShaders(outShaderKeys);
+			return 0;
 		}
+		shaders.push_back(shader);
+		outShaderKeys.push_back(key);
 	}
-	return false;
+	return startLinkShaderProgram(shaders, isRetrievable);
 }
 
-bool gs::ShaderProgram::changeUniformVec2(const std::string& name, const glm::vec2& v2)
+bool gs::ShaderProgram::isCompiledAndLinked(GLuint shaderProgramId,
+		const std::vector<uint64_t>& shaderKeys)
 {
-	for (auto& u : mShaderProgramLoadInfo.mUniforms) {
-		if (u.mName == name) {
-			if (u.mType != UniformType::VEC2) {
-				LOGE("Uniform value can't be changed. %s is not a vec2.\n", u.mName.c_str());
-				return false;
-			}
-			u.mValue.mVec2.x = v2.x;
-			u.mValue.mVec2.y = v2.y;
-			return true;
+	bool isCompiled = true;
+	for (uint64_t key : shaderKeys) {
+		if (!mObjectCache->isCompiled(key)) {
+			isCompiled = false;
 		}
 	}
-	return false;
+	// a failed compiling also fails the linking --> no second error message
+	return isCompiled && isShaderProgramLinked(shaderProgramId);
 }
 
-bool gs::ShaderProgram::changeUniformVec3(const std::string& name, const glm::vec3& v3)
+void gs::ShaderProgram::releaseShaders(std::vector<uint64_t>& shaderKeys)
 {
-	for (auto& u : mShaderProgramLoadInfo.mUniforms) {
-		if (u.mName == name) {
-			if (u.mType != UniformType::VEC3) {
-				LOGE("Uniform value can't be changed. %s is not a vec3.\n", u.mName.c_str());
-				return false;
-			}
-			u.mValue.mVec3.x = v3.x;
-			u.mValue.mVec3.y = v3.y;
-			u.mValue.mVec3.z = v3.z;
-			return true;
-		}
+	for (uint64_t key : shaderKeys) {
+		mObjectCache->release(key);
 	}
-	return false;
+	shaderKeys.clear();
+}
+
+gs::UniformHandle gs::ShaderProgram::getUniformHandle(const std::string& name) const
+{
+	UniformHandle handle;
+	handle.mName = name;
+	resolveUniformHandle(handle);
+	return handle;
+}
+
+bool gs::ShaderProgram::changeUniformFloat(const std::string& name, float value)
+{
+	UniformHandle handle = getUniformHandle(name);
+	return changeUniformFloat(handle, value);
+}
+
+bool gs::ShaderProgram::changeUniformVec2(const std::string& name, const glm::vec2& v2)
+{
+	UniformHandle handle = getUniformHandle(name);
+	return changeUniformVec2(handle, v2);
+}
+
+bool gs::ShaderProgram::changeUniformVec3(const std::string& name, const glm::vec3& v3)
+{
+	UniformHandle handle = getUniformHandle(name);
+	return changeUniformVec3(handle, v3);
 }
 
 bool gs::ShaderProgram::changeUniformVec4(const std::string& name, const glm::vec4& v4)
 {
-	for (auto& u : mShaderProgramLoadInfo.mUniforms) {
-		if (u.mName == name) {
-			if (u.mType != UniformType::VEC4) {
-				LOGE("Uniform value can't be changed. %s is not a vec4.\n", u.mName.c_str());
-				return false;
-			}
-			u.mValue.mVec4.x = v4.x;
-			u.mValue.mVec4.y = v4.y;
-			u.mValue.mVec4.z = v4.z;
-			u.mValue.mVec4.w = v4.w;
-			return true;
-		}
-	}
-	return false;
+	UniformHandle handle = getUniformHandle(name);
+	return changeUniformVec4(handle, v4);
 }
 
 bool gs::ShaderProgram::changeUniformMat4(const std::string& name, const glm::mat4& m)
 {
-	for (auto& u : mShaderProgramLoadInfo.mUniforms) {
-		if (u.mName == name) {
-			if (u.mType != UniformType::MAT4X4) {
-				LOGE("Uniform value can't be changed. %s is not a mat4.\n", u.mName.c_str());
-				return false;
-			}
-			memcpy(u.mValue.mMat4.m, glm::value_ptr(m), sizeof(u.mValue.mMat4.m));
-			return true;
-		}
+	UniformHandle handle = getUniformHandle(name);
+	return changeUniformMat4(handle, m);
+}
+
+bool gs::ShaderProgram::changeUniformFloat(UniformHandle& handle, float value)
+{
+	Uniform* u = getUniform(handle, UniformType::FLOAT, "float");
+	if (!u) {
+		return false;
+	}
+	u->mValue.mFloat = value;
+	return true;
+}
+
+bool gs::ShaderProgram::changeUniformVec2(UniformHandle& handle, const glm::vec2& v2)
+{
+	Uniform* u = getUniform(handle, UniformType::VEC2, "vec2");
+	if (!u) {
+		return false;
 	}
-	return false;
+	u->mValue.mVec2.x = v2.x;
+	u->mValue.mVec2.y = v2.y;
+	return true;
 }
 
-void gs::ShaderProgram::bind(const Properties& p, const Matrices& m)
+bool gs::ShaderProgram::changeUniformVec3(UniformHandle& handle, const glm::vec3& v3)
+{
+	Uniform* u = getUniform(handle, UniformType::VEC3, "vec3");
+	if (!u) {
+		return false;
+	}
+	u->mValue.mVec3.x = v3.x;
+	u->mValue.mVec3.y = v3.y;
+	u->mValue.mVec3.z = v3.z;
+	return true;
+}
+
+bool gs::ShaderProgram::changeUniformVec4(UniformHandle& handle, const glm::vec4& v4)
+{
+	Uniform* u = getUniform(handle, UniformType::VEC4, "vec4");
+	if (!u) {
+		return false;
+	}
+	u->mValue.mVec4.x = v4.x;
+	u->mValue.mVec4.y = v4.y;
+	u->mValue.mVec4.z = v4.z;
+	u->mValue.mVec4.w = v4.w;
+	return true;
+}
+
+bool gs::ShaderProgram::changeUniformMat4(UniformHandle& handle, const glm::mat4& m)
+{
+	Uniform* u = getUniform(handle, UniformType::MAT4X4, "mat4");
+	if (!u) {
+		return false;
+	}
+	memcpy(u->mValue.mMat4.m, glm::value_ptr(m), sizeof(u->mValue.mMat4.m));
+	return true;
+}
+
+void gs::ShaderProgram::bind(const Properties& p, const Matrices& m, unsigned int passSerial)
 {
 	glUseProgram(mShaderProgramId);
-	applyUniformValues(mShaderProgramLoadInfo.mUniforms, p, m);
+	// The uniform values are stored by the program object. Only the
+	// values which can be changed since the last bind are uploaded.
+	if (!p.mFrameNumber || p.mFrameNumber != mUploadedFrameNumber) {
+		applyUniformTable(mFrameUniforms, p, m);
+		mUploadedFrameNumber = p.mFrameNumber;
+	}
+	if (!passSerial || passSerial != mUploadedPassSerial) {
+		applyUniformTable(mPassUniforms, p, m);
+		mUploadedPassSerial = passSerial;
+	}
+	applyUniformTable(mEntityUniforms, p, m);
 }
 
-void gs::ShaderProgram::bindMatricesOnly(const Matrices& m)
+void gs::ShaderProgram::bindMatricesOnly(const Properties& p, const Matrices& m)
 {
 	//glUseProgram(mShaderProgramId);
-	applyUniformMatricesOnly(mShaderProgramLoadInfo.mUniforms, m);
+	applyUniformTable(mEntityUniforms, p, m);
+}
+
+void gs::ShaderProgram::resolveUniformHandle(UniformHandle& handle) const
+{
+	handle.mIndex = -1;
+	handle.mLoadCounter = mLoadCounter;
+	const std::vector<Uniform>& uniforms = mShaderProgramLoadInfo.mUniforms;
+	for (size_t i = 0; i < uniforms.size(); ++i) {
+		if (uniforms[i].mName == handle.mName) {
+			handle.mIndex = static_cast<int>(i);
+			return;
+		}
+	}
+}
+
+gs::Uniform* gs::ShaderProgram::getUniform(UniformHandle& handle, UniformType type,
+		const char* typeName)
+{
+	if (handle.mLoadCounter != mLoadCounter) {
+		// program was reloaded in the meantime --> resolve the name again
+		resolveUniformHandle(handle);
+	}
+	if (handle.mIndex < 0 ||
+			static_cast<size_t>(handle.mIndex) >= mShaderProgramLoadInfo.mUniforms.size()) {
+		return nullptr;
+	}
+	Uniform& u = mShaderProgramLoadInfo.mUniforms[handle.mIndex];
+	if (u.mType != type) {
+		LOGE("Uniform value can't be changed. %s is not a %s.\n", u.mName.c_str(), typeName);
+		return nullptr;
+	}
+	return &u;
 }
 
+void gs::ShaderProgram::buildUniformTables()
+{
+	mFrameUniforms.clear();
+	mPassUniforms.clear();
+	mEntityUniforms.clear();
+	const std::vector<Uniform>& uniforms = mShaderProgramLoadInfo.mUniforms;
+	for (size_t i = 0; i < uniforms.size(); ++i) {
+		const Uniform& u = uniforms[i];
+		UniformRate rate = UniformRate::PER_FRAME;
+		UniformSetter setter;
+		setter.mIndex = static_cast<unsigned int>(i);
+		setter.mSetFunc = getUniformSetFunc(u, rate);
+		if (!setter.mSetFunc || u.mLocation == -1) {
+			continue;
+		}
+		switch (rate) {
+			case UniformRate::PER_FRAME:
+				mFrameUniforms.push_back(setter);
+				break;
+			case UniformRate::PER_PASS:
+				mPassUniforms.push_back(setter);
+				break;
+			case UniformRate::PER_ENTITY:
+				mEntityUniforms.push_back(setter);
+				break;
+		}
+	}
+	// new program object --> no uniform value is uploaded yet
+	mUploadedFrameNumber = 0;
+	mUploadedPassSerial = 0;
+}
+
+void gs::ShaderProgram::applyUniformTable(const std::vector<UniformSetter>& table,
+		const Properties& p, const Matrices& m)
+{
+	const std::vector<Uniform>& uniforms = mShaderProgramLoadInfo.mUniforms;
+	for (const UniformSetter& setter : table) {
+		setter.mSetFunc(uniforms[setter.mIndex], p, m);
+	}
+	renderCounters().mUniformUploads += static_cast<unsigned int>(table.size());
+}
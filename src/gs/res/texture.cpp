@@ -1,11 +1,12 @@
 #include <gs/res/texture.h>
+#include <gs/res/texture_decoder.h>
+#include <gs/res/mipmap_builder.h>
+#include <gs/res/texture_cache.h>
+#include <gs/res/texture_compression.h>
+#include <gs/res/pixel_buffer_pool.h>
 #include <gs/common/rect.h>
 #include <gs/common/color.h>
 #include <gs/system/log.h>
-
-#define STB_IMAGE_STATIC
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb/stb_image.h>
 #include <string.h>
 
 namespace gs
@@ -28,6 +29,127 @@ namespace gs
 			}
 			return GL_REPEAT;
 		}
+
+		// format and type for glTexImage2D() for the given internal format
+		bool getFormatAndType(GLint internalFormat, GLenum& format, GLenum& type)
+		{
+			switch (internalFormat) {
+				case GL_RED:
+				case GL_R8:
+					format = GL_RED;
+					type = GL_UNSIGNED_BYTE;
+					return true;
+				case GL_RG:
+				case GL_RG8:
+					format = GL_RG;
+					type = GL_UNSIGNED_BYTE;
+					return true;
+				case GL_RGB:
+				case GL_RGB8:
+					format = GL_RGB;
+					type = GL_UNSIGNED_BYTE;
+					return true;
+				case GL_RGBA:
+				case GL_RGBA8:
+					format = GL_RGBA;
+					type = GL_UNSIGNED_BYTE;
+					return true;
+				case GL_R16:
+					format = GL_RED;
+					type = GL_UNSIGNED_SHORT;
+					return true;
+				case GL_RG16:
+					format = GL_RG;
+					type = GL_UNSIGNED_SHORT;
+					return true;
+				case GL_RGB16:
+					format = GL_RGB;
+					type = GL_UNSIGNED_SHORT;
+					return true;
+				case GL_RGBA16:
+					format = GL_RGBA;
+					type = GL_UNSIGNED_SHORT;
+					return true;
+				case GL_R16F:
+				case GL_R32F:
+					format = GL_RED;
+					type = GL_FLOAT;
+					return true;
+				case GL_RG16F:
+				case GL_RG32F:
+					format = GL_RG;
+					type = GL_FLOAT;
+					return true;
+				case GL_RGB16F:
+				case GL_RGB32F:
+					format = GL_RGB;
+					type = GL_FLOAT;
+					return true;
+				case GL_RGBA16F:
+				case GL_RGBA32F:
+					format = GL_RGBA;
+					type = GL_FLOAT;
+					return true;
+				case GL_DEPTH_COMPONENT:
+				case GL_DEPTH_COMPONENT16:
+				case GL_DEPTH_COMPONENT24:
+					format = GL_DEPTH_COMPONENT;
+					type = GL_UNSIGNED_INT;
+					return true;
+				case GL_DEPTH_COMPONENT32F:
+					format = GL_DEPTH_COMPONENT;
+					type = GL_FLOAT;
+					return true;
+				case GL_DEPTH24_STENCIL8:
+					format = GL_DEPTH_STENCIL;
+					type = GL_UNSIGNED_INT_24_8;
+					return true;
+			}
+			return false;
+		}
+
+		bool isGenerateMipmapSupported()
+		{
+#ifdef GLSLSCENE_USE_GLEW
+			return GLEW_VERSION_3_0 || GLEW_ARB_framebuffer_object;
+#else
+			return false;
+#endif
+		}
+
+		bool isTextureSwizzleSupported()
+		{
+#ifdef GLSLSCENE_USE_GLEW
+			return GLEW_VERSION_3_3 || GLEW_ARB_texture_swizzle;
+#else
+			return false;
+#endif
+		}
+
+		// R8, RG8, R16F, ... and float textures
+		bool isChannelAwareFormatSupported()
+		{
+#ifdef GLSLSCENE_USE_GLEW
+			return (GLEW_VERSION_3_0 || GLEW_ARB_texture_rg) &&
+					isTextureSwizzleSupported() && isGenerateMipmapSupported();
+#else
+			return false;
+#endif
+		}
+
+		GLint getImageInternalFormat(unsigned int channelCount, ImageDataType dataType)
+		{
+			static const GLint formats[3][4] = {
+					{GL_R8, GL_RG8, GL_RGB8, GL_RGBA8},
+					{GL_R16, GL_RG16, GL_RGB16, GL_RGBA16},
+					// 16 bit float is enough for hdr images and needs the half memory
+					{GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F},
+			};
+			if (channelCount < 1 || channelCount > 4) {
+				return GL_RGBA8;
+			}
+			return formats[static_cast<unsigned int>(dataType)][channelCount - 1];
+		}
 	}
 }
 
@@ -38,8 +160,11 @@ gs::Texture::Texture(const std::weak_ptr<FileChangeMonitoring>& fcm,
 		mMipmap(mipmap), mMinFilter(minFilter), mMagFilter(magFilter),
 		mWrap(wrap), mClampBorderColor(clampBorderColor),
 		mWidth(0), mHeight(0),
-		mBytePerPixel(0), mUpdateArea(0, 0, 0, 0), mData(nullptr),
-		mGlTexId(0)
+		mBytePerPixel(0), mUpdateArea(0, 0, 0, 0), mData(nullptr), mKeepData(false),
+		mCompression(TexCompression::NONE), mUsedCompression(TexCompression::NONE),
+		mLevelCount(1), mCompressedSize(0), mFormat(TexFormat::AUTO), mCache(),
+		mInternalFormat(GL_RGBA), mGlTexId(0), mGlTexWidth(0), mGlTexHeight(0),
+		mGlTexInternalFormat(0), mGlTexLevelCount(0), mDecodeJob(), mPixelBuffer()
 {
 }
 
@@ -66,11 +191,16 @@ bool gs::Texture::exist() const
 bool gs::Texture::load()
 {
 	if (!mFilename.empty()) {
-		unload();
+		// The gl texture is not deleted (like unload() would do). At hot
+		// reloading the storage is reused if the size is not changed.
+		cancelLoading(); // cancel a running asynchronous loading
+		freeImageData(mData);
+		mData = nullptr;
 
 		if (!loadFromFile()) {
 			return false;
 		}
+		markHotReloadLoaded();
 	}
 	else {
 		if (!mData || !mWidth || !mHeight) {
@@ -79,75 +209,135 @@ bool gs::Texture::load()
 		}
 	}
 
-	glGenTextures(1, &mGlTexId);
-	LOGI("opengl: tex id %u\n", mGlTexId);
-	glBindTexture(GL_TEXTURE_2D, mGlTexId);
-	switch (mMipmap)
-	{
-		case TexMipmap::NO_MIPMAP:
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, mWidth, mHeight,
-					0, GL_RGBA, GL_UNSIGNED_BYTE, mData);
-			break;
-		case TexMipmap::MIPMAP:
-			gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGBA, mWidth, mHeight,
-					GL_RGBA, GL_UNSIGNED_BYTE, mData);
-#ifdef COLORING_TEX_FOR_DEBUGGING
-			coloringTextureForDebugging(*this);
-#endif
-			break;
+	if (!uploadToGpu()) {
+		return false;
 	}
+	markHotReloadUploaded();
+	releaseDataAfterUpload();
+	if (getHotReloadingFileCount() == 0) {
+		addFileForHotReloading(mFilename);
+	}
+	return true;
+}
 
-	switch (mMinFilter)
-	{
-		case TexFilter::NEAREST:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-					(mMipmap == TexMipmap::MIPMAP) ?
-							GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST);
-			break;
-		case TexFilter::LINEAR:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-					(mMipmap == TexMipmap::MIPMAP) ?
-							GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
-			break;
+bool gs::Texture::startLoading(TextureDecoder& decoder,
+		const std::shared_ptr<TextureCache>& cache)
+{
+	if (mFilename.empty()) {
+		return load();
 	}
+	return startDecoding(decoder, cache) && createPlaceholder();
+}
 
-	switch (mMagFilter)
-	{
-		case TexFilter::NEAREST:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-					GL_NEAREST);
-			break;
-		case TexFilter::LINEAR:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-					GL_LINEAR);
-			break;
+bool gs::Texture::startDecoding(TextureDecoder& decoder,
+		const std::shared_ptr<TextureCache>& cache)
+{
+	unsigned int width = 0;
+	unsigned int height = 0;
+	unsigned int channels = 0;
+	if (mFilename.empty() || !getImageFileInfo(mFilename, width, height, channels)) {
+		LOGE("load image '%s' failed\n", mFilename.c_str());
+		return false;
 	}
+	mCache = cache; // is also used by load() (e.g. for hot reloading)
+	mDecodeJob = decoder.decode(mFilename, getLoadOptions(), cache);
+	return true;
+}
 
-	if (mWrap != TexWrap::DEFAULT) {
-		GLint glWrap = getOpenGLWrapping(mWrap);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, glWrap);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, glWrap);
-		if (mWrap == TexWrap::CLAMP_TO_BORDER) {
-			glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, mClampBorderColor.rgba);
+bool gs::Texture::createPlaceholder()
+{
+	if (!mGlTexId) {
+		// create() unloads the texture --> the decoding must be kept
+		std::shared_ptr<TextureDecodeJob> job = mDecodeJob;
+		// placeholder until the decoded image is uploaded
+		create(1, 1, ColorU32(128, 128, 128, 255));
+		mDecodeJob = job;
+		if (!uploadToGpu()) {
+			return false;
 		}
+		releaseDataAfterUpload();
 	}
-
-	glBindTexture(GL_TEXTURE_2D, 0); // unbind
 	if (getHotReloadingFileCount() == 0) {
 		addFileForHotReloading(mFilename);
 	}
 	return true;
 }
 
+bool gs::Texture::finishLoading(TextureDecoder* decoder, PixelBufferPool* pool)
+{
+	if (!mDecodeJob) {
+		return true;
+	}
+	if (!mDecodeJob->isDone()) {
+		return false;
+	}
+	if (!mDecodeJob->isSuccess()) {
+		LOGE("decoding of '%s' failed --> placeholder is used\n", mFilename.c_str());
+		mDecodeJob.reset();
+		return true;
+	}
+	if (!mPixelBuffer && decoder && pool) {
+		// the GL thread doesn't copy the pixels --> a worker thread fill the buffer
+		mPixelBuffer = pool->acquire(mDecodeJob->getImage().getDataSize());
+		if (mPixelBuffer) {
+			pool->setCopyJob(*mPixelBuffer, mDecodeJob);
+			decoder->copyToBuffer(mDecodeJob, mPixelBuffer->getMappedData());
+			return false;
+		}
+	}
+	if (mPixelBuffer && !mDecodeJob->isCopied()) {
+		return false;
+	}
+	std::shared_ptr<TextureDecodeJob> job = mDecodeJob;
+	std::shared_ptr<PixelBuffer> buffer = mPixelBuffer;
+	mDecodeJob.reset();
+	mPixelBuffer.reset();
+	takeImage(job->getImage()); // no copy, the buffer of the decoder is used
+	if (buffer && pool->bindForUpload(*buffer)) {
+		uploadToGpu(buffer->getPbo());
+	}
+	else {
+		uploadToGpu();
+	}
+	if (buffer) {
+		// the buffer is reused after the upload is done by the driver
+		pool->release(buffer);
+	}
+	releaseDataAfterUpload();
+	return true;
+}
+
+bool gs::Texture::isDecoded() const
+{
+	return mDecodeJob && mDecodeJob->isDone();
+}
+
+void gs::Texture::cancelLoading()
+{
+	mDecodeJob.reset();
+	// a mapped buffer is returned to the pool after the copy is done
+	// (see PixelBufferPool::update())
+	mPixelBuffer.reset();
+}
+
 void gs::Texture::unload()
 {
+	cancelLoading();
 	glDeleteTextures(1, &mGlTexId);
+	mGlTexId = 0;
+	mGlTexWidth = 0;
+	mGlTexHeight = 0;
+	mGlTexInternalFormat = 0;
+	mGlTexLevelCount = 0;
 	mWidth = 0;
 	mHeight = 0;
 	mBytePerPixel = 0;
-	delete[] mData;
+	freeImageData(mData);
 	mUpdateArea = RectInt(0, 0, 0, 0);
 	mData = NULL;
+	mUsedCompression = TexCompression::NONE;
+	mLevelCount = 1;
+	mCompressedSize = 0;
 }
 
 void gs::Texture::create(unsigned int width, unsigned int height, const ColorU32& color)
@@ -157,9 +347,10 @@ void gs::Texture::create(unsigned int width, unsigned int height, const ColorU32
 	mWidth = width;
 	mHeight = height;
 	mBytePerPixel = sizeof(color.mCol32); // should be 4
+	mInternalFormat = GL_RGBA8;
 	unsigned int lPixelCount(mWidth * mHeight);
 	unsigned int lSize(lPixelCount * mBytePerPixel);
-	mData = new unsigned char [lSize];
+	mData = allocImageData(lSize);
 	union {
 		unsigned char* data;
 		uint32_t* p32;
@@ -172,8 +363,80 @@ void gs::Texture::create(unsigned int width, unsigned int height, const ColorU32
 	mUpdateArea = RectInt(0, 0, mWidth, mHeight);
 }
 
+bool gs::Texture::createFromImage(DecodedImage& image)
+{
+	if (!image.mData || !image.mWidth || !image.mHeight) {
+		LOGE("No image for texture\n");
+		return false;
+	}
+	cancelLoading();
+	takeImage(image);
+	if (!uploadToGpu()) {
+		return false;
+	}
+	if (!mKeepData) {
+		// releaseDataAfterUpload() would keep the data (no filename)
+		freeImageData(mData);
+		mData = nullptr;
+		mUpdateArea = RectInt(0, 0, 0, 0);
+	}
+	return true;
+}
+
+bool gs::Texture::createRenderTarget(unsigned int width, unsigned int height,
+		GLint internalFormat)
+{
+	GLenum format = GL_RGBA;
+	GLenum type = GL_UNSIGNED_BYTE;
+	if (!getFormatAndType(internalFormat, format, type)) {
+		LOGE("Internal format 0x%x is not supported for a render target\n", internalFormat);
+		return false;
+	}
+	if (mGlTexId && !mData && mWidth == width && mHeight == height &&
+			mInternalFormat == internalFormat) {
+		return true; // nothing to do
+	}
+	// no cpu buffer necessary. The content only exist at the gpu.
+	freeImageData(mData);
+	mData = nullptr;
+	mBytePerPixel = 0;
+	mWidth = width;
+	mHeight = height;
+	mInternalFormat = internalFormat;
+	mUpdateArea = RectInt(0, 0, 0, 0);
+
+	if (!mGlTexId) {
+		glGenTextures(1, &mGlTexId);
+		LOGI("opengl: render target tex id %u\n", mGlTexId);
+	}
+	glBindTexture(GL_TEXTURE_2D, mGlTexId);
+	glTexImage2D(GL_TEXTURE_2D, 0, mInternalFormat, mWidth, mHeight,
+			0, format, type, nullptr);
+	mGlTexWidth = mWidth;
+	mGlTexHeight = mHeight;
+	mGlTexInternalFormat = mInternalFormat;
+	mGlTexLevelCount = 1;
+	applyTexParameters();
+	glBindTexture(GL_TEXTURE_2D, 0); // unbind
+	return true;
+}
+
+void gs::Texture::generateMipmap()
+{
+	if (!mGlTexId || mMipmap != TexMipmap::MIPMAP) {
+		return;
+	}
+	glBindTexture(GL_TEXTURE_2D, mGlTexId);
+	glGenerateMipmap(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, 0); // unbind
+}
+
 void gs::Texture::update(const RectInt& updateArea, const ColorU32& color)
 {
+	if (!mData) {
+		LOGW("Texture %s has no cpu data for update (see keep-data)\n", mFilename.c_str());
+		return;
+	}
 	RectInt area = updateArea;
 	area.regular();
 
@@ -259,6 +522,9 @@ const unsigned char* gs::Texture::getData() const
 gs::RectInt gs::Texture::getData(unsigned char* dst, const RectInt& area) const
 {
 	RectInt a;
+	if (!mData) {
+		return a;
+	}
 	if (!area.intersects(RectInt(0, 0, mWidth, mHeight), a)) {
 		return a;
 	}
@@ -275,26 +541,289 @@ gs::RectInt gs::Texture::getData(unsigned char* dst, const RectInt& area) const
 
 bool gs::Texture::loadFromFile()
 {
-	if (mFilename.size() < 4) {
-		LOGE("to short filename\n");
+	DecodedImage image;
+	bool success = mCache ? mCache->load(mFilename, getLoadOptions(), image) :
+			loadImageFile(mFilename, getLoadOptions(), image);
+	if (!success) {
 		return false;
 	}
-	int x = 0, y = 0, channels_in_file = 0;
-	stbi_set_flip_vertically_on_load(1);
-	unsigned char* pixelBuffer = stbi_load(mFilename.c_str(), &x, &y,
-			&channels_in_file, STBI_rgb_alpha /* 4 */);
-	if (!pixelBuffer || !x || !y) {
-		LOGE("load image '%s' failed\n", mFilename.c_str());
-		return false;
+	takeImage(image);
+	return true;
+}
+
+gs::ImageLoadOptions gs::Texture::getLoadOptions() const
+{
+	ImageLoadOptions options;
+	options.mFlipVertically = true;
+	options.mMipmap = (mMipmap == TexMipmap::MIPMAP);
+	if (mCompression != TexCompression::NONE && mKeepData) {
+		LOGW("Texture %s: compression is not used because the data is kept\n", mFilename.c_str());
 	}
-	unsigned int bufSize = x * y * 4;
-	mData = new unsigned char[bufSize];
-	memcpy(mData, pixelBuffer, bufSize);
-	stbi_image_free(pixelBuffer);
+	else {
+		options.mCompression = getSupportedCompression(mCompression);
+	}
+	if (mFormat == TexFormat::AUTO && !mKeepData &&
+			options.mCompression == TexCompression::NONE &&
+			isChannelAwareFormatSupported()) {
+		// update() and getData() expect 4 byte per pixel --> only without keep-data
+		options.mChannelAware = true;
+		options.mHighPrecision = true;
+	}
+	return options;
+}
 
-	mBytePerPixel = 4;
-	mWidth = x;
-	mHeight = y;
+void gs::Texture::takeImage(DecodedImage& image)
+{
+	freeImageData(mData);
+	mWidth = image.mWidth;
+	mHeight = image.mHeight;
+	mBytePerPixel = image.mBytePerPixel;
+	mInternalFormat = (image.mCompression == TexCompression::NONE) ?
+			getImageInternalFormat(image.mChannelCount, image.mDataType) :
+			getCompressedGlFormat(image.mCompression);
+	mUsedCompression = image.mCompression;
+	mLevelCount = image.mLevelCount;
+	mCompressedSize = image.mCompressedSize;
+	mData = image.releaseData();
 	mUpdateArea = RectInt(0, 0, mWidth, mHeight);
+}
+
+bool gs::Texture::uploadToGpu(GLuint pixelBuffer)
+{
+	if (!mData || !mWidth || !mHeight) {
+		LOGE("No buffer exist!\n");
+		return false;
+	}
+	// with a bound pixel buffer the pixel pointers are offsets into the buffer
+	// (the buffer has the same content as mData)
+	auto getPixels = [this, pixelBuffer](size_t offset) -> const void* {
+		return pixelBuffer ? reinterpret_cast<const void*>(offset) : mData + offset;
+	};
+	if (!mGlTexId) {
+		glGenTextures(1, &mGlTexId);
+		LOGI("opengl: tex id %u\n", mGlTexId);
+	}
+	// e.g. hot reloading of an image with the same size
+	bool isReused = isGlTexStorageReusable();
+	glBindTexture(GL_TEXTURE_2D, mGlTexId);
+	if (mUsedCompression != TexCompression::NONE) {
+		// all levels are already compressed
+		size_t levelOffset = 0;
+		unsigned int w = mWidth;
+		unsigned int h = mHeight;
+		unsigned int levelCount = 0;
+		for (unsigned int level = 0; level < mLevelCount; ++level) {
+			size_t levelSize = getCompressedLevelSize(mUsedCompression, w, h);
+			if (levelSize > mCompressedSize - levelOffset) {
+				LOGE("Compressed data of texture %s is too small for level %u of %u\n",
+						mFilename.c_str(), level, mLevelCount);
+				break;
+			}
+			if (isReused) {
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, w, h,
+						mInternalFormat, static_cast<GLsizei>(levelSize), getPixels(levelOffset));
+			}
+			else {
+				glCompressedTexImage2D(GL_TEXTURE_2D, level, mInternalFormat, w, h,
+						0, static_cast<GLsizei>(levelSize), getPixels(levelOffset));
+			}
+			levelOffset += levelSize;
+			w = (w > 1) ? w / 2 : 1;
+			h = (h > 1) ? h / 2 : 1;
+			++levelCount;
+		}
+		if (pixelBuffer) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		if (!levelCount) {
+			glBindTexture(GL_TEXTURE_2D, 0); // unbind
+			return false;
+		}
+		// only the levels which are uploaded
+		mLevelCount = levelCount;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mLevelCount - 1);
+		mGlTexWidth = mWidth;
+		mGlTexHeight = mHeight;
+		mGlTexInternalFormat = mInternalFormat;
+		mGlTexLevelCount = mLevelCount;
+		applyTexParameters();
+		glBindTexture(GL_TEXTURE_2D, 0); // unbind
+		mUpdateArea = RectInt(0, 0, 0, 0);
+		return true;
+	}
+	GLenum format = GL_RGBA;
+	GLenum type = GL_UNSIGNED_BYTE;
+	if (!getFormatAndType(mInternalFormat, format, type)) {
+		LOGE("Internal format 0x%x is not supported\n", mInternalFormat);
+		if (pixelBuffer) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+		glBindTexture(GL_TEXTURE_2D, 0); // unbind
+		return false;
+	}
+	// rows of RGB8, R8, ... are not aligned to 4 bytes
+	bool isUnaligned = (size_t(mWidth) * mBytePerPixel) % 4 != 0;
+	if (isUnaligned) {
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	}
+	if (isReused) {
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, mWidth, mHeight,
+				format, type, getPixels(0));
+	}
+	else {
+		glTexImage2D(GL_TEXTURE_2D, 0, mInternalFormat, mWidth, mHeight,
+				0, format, type, getPixels(0));
+	}
+	if (pixelBuffer) {
+		// the cpu fallback of updateMipmapLevels() uses client memory
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+	if (isUnaligned) {
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // default
+	}
+	mGlTexWidth = mWidth;
+	mGlTexHeight = mHeight;
+	mGlTexInternalFormat = mInternalFormat;
+	mGlTexLevelCount = 1;
+	if (isTextureSwizzleSupported()) {
+		// a grayscale image should also be gray at the shader (not red)
+		GLint swizzle[4] = {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA};
+		if (format == GL_RED) {
+			swizzle[1] = GL_RED;
+			swizzle[2] = GL_RED;
+			swizzle[3] = GL_ONE;
+		}
+		else if (format == GL_RG) {
+			// gray + alpha
+			swizzle[1] = GL_RED;
+			swizzle[2] = GL_RED;
+			swizzle[3] = GL_GREEN;
+		}
+		glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+	}
+	updateMipmapLevels();
+
+	applyTexParameters();
+
+	glBindTexture(GL_TEXTURE_2D, 0); // unbind
+	// everything is uploaded
+	mUpdateArea = RectInt(0, 0, 0, 0);
 	return true;
 }
+
+bool gs::Texture::uploadUpdateArea()
+{
+	if (!mUpdateArea.mWidth || !mUpdateArea.mHeight) {
+		return true; // nothing changed
+	}
+	if (!mData || mUsedCompression != TexCompression::NONE) {
+		LOGW("Texture %s has no cpu data for update (see keep-data)\n", mFilename.c_str());
+		return false;
+	}
+	if (!isGlTexStorageReusable()) {
+		// no gl texture or the size is changed (e.g. by create())
+		return uploadToGpu();
+	}
+	GLenum format = GL_RGBA;
+	GLenum type = GL_UNSIGNED_BYTE;
+	if (!getFormatAndType(mInternalFormat, format, type)) {
+		LOGE("Internal format 0x%x is not supported\n", mInternalFormat);
+		return false;
+	}
+	const RectInt& a = mUpdateArea;
+	glBindTexture(GL_TEXTURE_2D, mGlTexId);
+	// mData has the lines of the whole texture --> the line length is the
+	// texture width and not the width of the update area
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, mWidth);
+	bool isUnaligned = (size_t(mWidth) * mBytePerPixel) % 4 != 0;
+	if (isUnaligned) {
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	}
+	const unsigned char* src = mData +
+			(size_t(a.mTop) * mWidth + a.mLeft) * mBytePerPixel;
+	glTexSubImage2D(GL_TEXTURE_2D, 0, a.mLeft, a.mTop, a.mWidth, a.mHeight,
+			format, type, src);
+	if (isUnaligned) {
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // default
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0); // default
+	updateMipmapLevels();
+	glBindTexture(GL_TEXTURE_2D, 0); // unbind
+	mUpdateArea = RectInt(0, 0, 0, 0);
+	return true;
+}
+
+void gs::Texture::releaseDataAfterUpload()
+{
+	if ((mKeepData || mFilename.empty()) && mUsedCompression == TexCompression::NONE) {
+		return;
+	}
+	// the pixels are uploaded to the gpu and only needed for getData()
+	freeImageData(mData);
+	mData = nullptr;
+	mUpdateArea = RectInt(0, 0, 0, 0);
+}
+
+bool gs::Texture::isGlTexStorageReusable() const
+{
+	return mGlTexId && mGlTexWidth == mWidth && mGlTexHeight == mHeight &&
+			mGlTexInternalFormat == mInternalFormat &&
+			(mUsedCompression == TexCompression::NONE || mGlTexLevelCount == mLevelCount);
+}
+
+void gs::Texture::updateMipmapLevels()
+{
+	if (mMipmap != TexMipmap::MIPMAP) {
+		return;
+	}
+	// no gluBuild2DMipmaps() --> is slow and rescale NPOT images
+	// channel aware formats are only used if glGenerateMipmap() exist
+	// --> the cpu fallback is only used for RGBA8
+	if (isGenerateMipmapSupported()) {
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else {
+		uploadMipmapLevels(mData, mWidth, mHeight);
+	}
+#ifdef COLORING_TEX_FOR_DEBUGGING
+	coloringTextureForDebugging(*this);
+#endif
+}
+
+void gs::Texture::applyTexParameters()
+{
+	switch (mMinFilter)
+	{
+		case TexFilter::NEAREST:
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+					(mMipmap == TexMipmap::MIPMAP) ?
+							GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST);
+			break;
+		case TexFilter::LINEAR:
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+					(mMipmap == TexMipmap::MIPMAP) ?
+							GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+			break;
+	}
+
+	switch (mMagFilter)
+	{
+		case TexFilter::NEAREST:
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+					GL_NEAREST);
+			break;
+		case TexFilter::LINEAR:
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+					GL_LINEAR);
+			break;
+	}
+
+	if (mWrap != TexWrap::DEFAULT) {
+		GLint glWrap = getOpenGLWrapping(mWrap);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, glWrap);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, glWrap);
+		if (mWrap == TexWrap::CLAMP_TO_BORDER) {
+			glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, mClampBorderColor.rgba);
+		}
+	}
+}
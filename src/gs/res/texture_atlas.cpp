@@ -0,0 +1,330 @@
+#include <gs/res/texture_atlas.h>
+#include <gs/res/texture_decoder.h>
+#include <gs/res/texture_cache.h>
+#include <gs/system/log.h>
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+namespace gs
+{
+	namespace
+	{
+		/**
+		 * Shelf packing. The images are sorted by height and added from left
+		 * to right. If a shelf is full then a new shelf is started above.
+		 * @param outRects Rect of each image without padding.
+		 * @return False if the images don't fit into the width or maxHeight.
+		 */
+		bool packShelves(const std::vector<Size2u>& sizes, unsigned int padding,
+				unsigned int width, unsigned int maxHeight,
+				std::vector<RectInt>& outRects, unsigned int& outHeight)
+		{
+			std::vector<size_t> order(sizes.size());
+			for (size_t i = 0; i < order.size(); ++i) {
+				order[i] = i;
+			}
+			std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) {
+				return sizes[a].mHeight > sizes[b].mHeight;
+			});
+			outRects.assign(sizes.size(), RectInt());
+			unsigned int x = 0;
+			unsigned int y = 0;
+			unsigned int shelfHeight = 0;
+			for (size_t i : order) {
+				unsigned int w = sizes[i].mWidth + 2 * padding;
+				unsigned int h = sizes[i].mHeight + 2 * padding;
+				if (w > width) {
+					return false;
+				}
+				if (x + w > width) {
+					// next shelf
+					y += shelfHeight;
+					x = 0;
+					shelfHeight = 0;
+				}
+				outRects[i] = RectInt(x + padding, y + padding,
+						sizes[i].mWidth, sizes[i].mHeight);
+				x += w;
+				shelfHeight = std::max(shelfHeight, h);
+				if (y + shelfHeight > maxHeight) {
+					return false;
+				}
+			}
+			outHeight = y + shelfHeight;
+			return true;
+		}
+
+		unsigned int getNextPowerOfTwo(unsigned int value)
+		{
+			unsigned int p = 1;
+			while (p < value) {
+				p *= 2;
+			}
+			return p;
+		}
+
+		/**
+		 * Copy the image into the atlas. The border pixels are repeated
+		 * for the padding.
+		 */
+		void copyImage(const DecodedImage& image, const RectInt& rect,
+				unsigned int padding, unsigned char* atlas, unsigned int atlasWidth)
+		{
+			const unsigned int bpp = 4;
+			int w = rect.mWidth;
+			int h = rect.mHeight;
+			int pad = padding;
+			for (int y = -pad; y < h + pad; ++y) {
+				int srcY = std::min(std::max(y, 0), h - 1);
+				const unsigned char* srcLine = image.mData + size_t(srcY) * w * bpp;
+				unsigned char* dstLine = atlas +
+						(size_t(rect.mTop + y) * atlasWidth + rect.mLeft) * bpp;
+				memcpy(dstLine, srcLine, size_t(w) * bpp);
+				for (int x = 1; x <= pad; ++x) {
+					memcpy(dstLine - x * bpp, srcLine, bpp);
+					memcpy(dstLine + (w - 1 + x) * bpp, srcLine + (w - 1) * bpp, bpp);
+				}
+			}
+		}
+	}
+}
+
+gs::TextureAtlas::TextureAtlas(const std::weak_ptr<FileChangeMonitoring>& fcm,
+		const std::vector<Image>& images,
+		TexMipmap mipmap, TexFilter minFilter, TexFilter magFilter,
+		unsigned int padding, unsigned int maxSize,
+		const std::shared_ptr<TextureDecoder>& decoder,
+		const std::shared_ptr<TextureCache>& cache)
+		:Resource(fcm), mImages(images), mPadding(padding), mMaxSize(maxSize),
+		mDecoder(decoder), mCache(cache),
+		// the atlas texture itself has no file --> no hot reloading for it
+		mTexture(std::make_shared<Texture>(std::weak_ptr<FileChangeMonitoring>(),
+				"", mipmap, minFilter, magFilter, TexWrap::CLAMP_TO_EDGE)),
+		mRegions(), mWidth(0), mHeight(0), mPackCount(0), mDecodeJobs()
+{
+}
+
+gs::TextureAtlas::~TextureAtlas()
+{
+}
+
+bool gs::TextureAtlas::load()
+{
+	if (!startLoading()) {
+		return false;
+	}
+	for (const std::shared_ptr<TextureDecodeJob>& job : mDecodeJobs) {
+		mDecoder->wait(*job);
+	}
+	finishLoading();
+	return mTexture->getGlTexId() != 0;
+}
+
+void gs::TextureAtlas::unload()
+{
+	// the packing is kept for the next load()
+	mDecodeJobs.clear();
+	mTexture->unload();
+}
+
+bool gs::TextureAtlas::startLoading()
+{
+	return startDecoding() && createPlaceholder();
+}
+
+bool gs::TextureAtlas::startDecoding()
+{
+	if (mImages.empty()) {
+		LOGE("Texture atlas has no images\n");
+		return false;
+	}
+	// only the headers are read --> the packing doesn't wait for the decoding
+	std::vector<Size2u> sizes;
+	for (const Image& image : mImages) {
+		unsigned int width = 0;
+		unsigned int height = 0;
+		unsigned int channels = 0;
+		if (!getImageFileInfo(image.mFilename, width, height, channels)) {
+			LOGE("Image '%s' can't be used for the texture atlas\n", image.mFilename.c_str());
+			return false;
+		}
+		sizes.emplace_back(width, height);
+	}
+	if (!isPackingValid(sizes)) {
+		if (mPackCount) {
+			LOGE("Image sizes of the texture atlas are changed --> the old atlas is kept "
+					"(the remapped texture coordinates of the meshes would be wrong). "
+					"Change the texture-atlas entry of the scene file for repacking.\n");
+			return false;
+		}
+		if (!pack(sizes)) {
+			return false;
+		}
+	}
+	// all images are decoded in parallel by the decoder threads
+	mDecodeJobs.clear();
+	for (const Image& image : mImages) {
+		mDecodeJobs.push_back(mDecoder->decode(image.mFilename, ImageLoadOptions(), mCache));
+	}
+	return true;
+}
+
+bool gs::TextureAtlas::createPlaceholder()
+{
+	if (!mTexture->getGlTexId()) {
+		// placeholder until the decoded images are uploaded
+		mTexture->create(1, 1, ColorU32(128, 128, 128, 255));
+		if (!mTexture->load()) {
+			return false;
+		}
+	}
+	if (getHotReloadingFileCount() == 0) {
+		for (const Image& image : mImages) {
+			addFileForHotReloading(image.mFilename);
+		}
+	}
+	return true;
+}
+
+bool gs::TextureAtlas::finishLoading()
+{
+	if (mDecodeJobs.empty()) {
+		return true;
+	}
+	if (!isDecoded()) {
+		return false;
+	}
+	std::vector<std::shared_ptr<TextureDecodeJob> > jobs;
+	jobs.swap(mDecodeJobs);
+	bool success = true;
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		const DecodedImage& image = jobs[i]->getImage();
+		// the file can be changed after the header was read
+		if (!jobs[i]->isSuccess() || image.mChannelCount != 4 ||
+				image.mDataType != ImageDataType::UINT8 ||
+				image.mCompression != TexCompression::NONE ||
+				int(image.mWidth) != mRegions[i].mRect.mWidth ||
+				int(image.mHeight) != mRegions[i].mRect.mHeight) {
+			LOGE("Image '%s' can't be used for the texture atlas\n", jobs[i]->getFilename().c_str());
+			success = false;
+		}
+	}
+	if (!success) {
+		releaseHotReload();
+		return true; // the previous atlas (or the placeholder) is kept
+	}
+	markHotReloadLoaded();
+
+	DecodedImage atlas;
+	size_t atlasSize = size_t(mWidth) * mHeight * 4;
+	atlas.mData = allocImageData(atlasSize);
+	if (!atlas.mData) {
+		releaseHotReload();
+		return true;
+	}
+	memset(atlas.mData, 0, atlasSize);
+	atlas.mWidth = mWidth;
+	atlas.mHeight = mHeight;
+	atlas.mBytePerPixel = 4;
+	atlas.mChannelCount = 4;
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		copyImage(jobs[i]->getImage(), mRegions[i].mRect, mPadding, atlas.mData, mWidth);
+	}
+	if (!mTexture->createFromImage(atlas)) {
+		releaseHotReload();
+		return true;
+	}
+	markHotReloadUploaded();
+	return true;
+}
+
+bool gs::TextureAtlas::isDecoded() const
+{
+	if (mDecodeJobs.empty()) {
+		return false;
+	}
+	for (const std::shared_ptr<TextureDecodeJob>& job : mDecodeJobs) {
+		if (!job->isDone()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void gs::TextureAtlas::hotReloading(unsigned int callbackId, const std::string& filename)
+{
+	LOGI("hot reloading: reload texture atlas image %s\n", filename.c_str());
+	if (!startLoading()) {
+		releaseHotReload();
+	}
+}
+
+const gs::TextureAtlas::Region* gs::TextureAtlas::getRegion(const std::string& name) const
+{
+	for (const Region& region : mRegions) {
+		if (region.mName == name) {
+			return &region;
+		}
+	}
+	return nullptr;
+}
+
+bool gs::TextureAtlas::pack(const std::vector<Size2u>& sizes)
+{
+	// no GL_MAX_TEXTURE_SIZE query --> can be packed without the GL context
+	unsigned int maxSize = mMaxSize;
+	size_t area = 0;
+	unsigned int maxWidth = 0;
+	for (const Size2u& size : sizes) {
+		area += size_t(size.mWidth + 2 * mPadding) * (size.mHeight + 2 * mPadding);
+		maxWidth = std::max(maxWidth, size.mWidth + 2 * mPadding);
+	}
+	// start with a nearly square atlas. A wider atlas is tried if the
+	// images don't fit.
+	unsigned int width = getNextPowerOfTwo(std::max(maxWidth,
+			static_cast<unsigned int>(sqrt(double(area)))));
+	std::vector<RectInt> rects;
+	unsigned int height = 0;
+	bool isPacked = false;
+	for (; width <= maxSize; width *= 2) {
+		if (packShelves(sizes, mPadding, width, maxSize, rects, height)) {
+			isPacked = true;
+			break;
+		}
+	}
+	if (!isPacked) {
+		LOGE("Images don't fit into a texture atlas of %ux%u\n", maxSize, maxSize);
+		return false;
+	}
+	mWidth = width;
+	mHeight = height;
+	mRegions.resize(mImages.size());
+	for (size_t i = 0; i < mImages.size(); ++i) {
+		Region& region = mRegions[i];
+		region.mName = mImages[i].mName;
+		region.mFilename = mImages[i].mFilename;
+		region.mRect = rects[i];
+		region.mS0 = float(rects[i].mLeft) / mWidth;
+		region.mT0 = float(rects[i].mTop) / mHeight;
+		region.mS1 = float(rects[i].mLeft + rects[i].mWidth) / mWidth;
+		region.mT1 = float(rects[i].mTop + rects[i].mHeight) / mHeight;
+	}
+	++mPackCount;
+	LOGI("texture atlas: %zu images packed into %ux%u\n", mImages.size(), mWidth, mHeight);
+	return true;
+}
+
+bool gs::TextureAtlas::isPackingValid(const std::vector<Size2u>& sizes) const
+{
+	if (mRegions.size() != sizes.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < sizes.size(); ++i) {
+		if (unsigned(mRegions[i].mRect.mWidth) != sizes[i].mWidth ||
+				unsigned(mRegions[i].mRect.mHeight) != sizes[i].mHeight) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,272 @@
+#include <gs/res/texture_cache.h>
+#include <gs/res/texture_decoder.h>
+#include <gs/res/texture_compression.h>
+#include <gs/common/fs.h>
+#include <gs/common/hash.h>
+#include <gs/system/log.h>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace gs
+{
+	namespace
+	{
+		/**
+		 * Header of a cache file (36 bytes). The pixels follow directly
+		 * after the header (no padding).
+		 */
+		struct CacheFileHeader
+		{
+			char mMagic[4]; // "GSTC"
+			uint32_t mVersion;
+			uint32_t mWidth;
+			uint32_t mHeight;
+			uint32_t mChannelCount; // 1 to 4
+			uint32_t mDataType; // ImageDataType
+			uint32_t mCompression; // TexCompression
+			uint32_t mLevelCount;
+			uint32_t mDataSize; // size of the pixels (all levels)
+		};
+
+		unsigned int getBytePerChannel(ImageDataType dataType)
+		{
+			switch (dataType) {
+				case ImageDataType::UINT8:
+					return 1;
+				case ImageDataType::UINT16:
+					return 2;
+				case ImageDataType::FLOAT:
+					return 4;
+			}
+			return 1;
+		}
+
+		// floor(log2(max(width, height))) + 1
+		unsigned int getMaxLevelCount(unsigned int width, unsigned int height)
+		{
+			unsigned int size = (width > height) ? width : height;
+			unsigned int levelCount = 1;
+			while (size > 1) {
+				size /= 2;
+				++levelCount;
+			}
+			return levelCount;
+		}
+
+		/**
+		 * The values of the header are used for indexing and for the size
+		 * of the uploaded levels --> a corrupt or stale cache file must be
+		 * detected before the pixels are used.
+		 * @return The size of the pixels which follow the header. 0 if
+		 *         the header is invalid.
+		 */
+		size_t getValidDataSize(const CacheFileHeader& header)
+		{
+			if (!header.mWidth || !header.mHeight || !header.mDataSize ||
+					header.mChannelCount < 1 || header.mChannelCount > 4 ||
+					header.mDataType > uint32_t(ImageDataType::FLOAT) ||
+					header.mCompression >= uint32_t(TexCompression::AUTO) ||
+					!header.mLevelCount ||
+					header.mLevelCount > getMaxLevelCount(header.mWidth, header.mHeight)) {
+				return 0;
+			}
+			TexCompression compression = static_cast<TexCompression>(header.mCompression);
+			ImageDataType dataType = static_cast<ImageDataType>(header.mDataType);
+			size_t dataSize = 0;
+			if (compression == TexCompression::NONE) {
+				// the mipmaps of uncompressed images are created by the GPU
+				if (header.mLevelCount != 1) {
+					return 0;
+				}
+				dataSize = size_t(header.mWidth) * header.mHeight *
+						header.mChannelCount * getBytePerChannel(dataType);
+			}
+			else {
+				if (header.mChannelCount != 4 || dataType != ImageDataType::UINT8) {
+					return 0;
+				}
+				unsigned int w = header.mWidth;
+				unsigned int h = header.mHeight;
+				for (unsigned int level = 0; level < header.mLevelCount; ++level) {
+					dataSize += getCompressedLevelSize(compression, w, h);
+					w = (w > 1) ? w / 2 : 1;
+					h = (h > 1) ? h / 2 : 1;
+				}
+			}
+			return (dataSize == header.mDataSize) ? dataSize : 0;
+		}
+
+		unsigned int getProcessId()
+		{
+#ifdef _WIN32
+			return static_cast<unsigned int>(_getpid());
+#else
+			return static_cast<unsigned int>(getpid());
+#endif
+		}
+	}
+}
+
+gs::TextureCache::TextureCache(const std::string& directory)
+		:mDirectory(fs::getRemoveEndingSlashes(directory, '/')),
+		mIsValid(false), mHitCount(0), mMissCount(0), mTmpFileCounter(0)
+{
+	mIsValid = fs::createDirectory(mDirectory);
+	if (!mIsValid) {
+		LOGE("Can't create texture cache directory '%s'\n", mDirectory.c_str());
+	}
+}
+
+gs::TextureCache::~TextureCache()
+{
+}
+
+bool gs::TextureCache::load(const std::string& filename,
+		const ImageLoadOptions& options, DecodedImage& outImage)
+{
+	uint64_t key = 0;
+	if (!mIsValid || !calcKey(filename, options.toString(), key)) {
+		return loadImageFile(filename, options, outImage);
+	}
+	if (read(key, outImage)) {
+		++mHitCount;
+		return true;
+	}
+	++mMissCount;
+	if (!loadImageFile(filename, options, outImage)) {
+		return false;
+	}
+	write(key, outImage);
+	return true;
+}
+
+bool gs::TextureCache::calcKey(const std::string& filename,
+		const std::string& options, uint64_t& outKey)
+{
+	FILE* f = fopen(filename.c_str(), "rb");
+	if (!f) {
+		return false;
+	}
+	uint64_t key = hash::FNV_OFFSET_BASIS;
+	std::vector<unsigned char> buffer(64 * 1024);
+	size_t readSize = 0;
+	while ((readSize = fread(buffer.data(), 1, buffer.size(), f)) > 0) {
+		key = hash::hashBytes(key, buffer.data(), readSize);
+	}
+	bool isError = ferror(f) != 0;
+	fclose(f);
+	if (isError) {
+		return false;
+	}
+	key = hash::hashU32(key, FILE_VERSION);
+	key = hash::hashBytes(key, options.data(), options.size());
+	outKey = key;
+	return true;
+}
+
+bool gs::TextureCache::read(uint64_t key, DecodedImage& outImage) const
+{
+	std::string cacheFilename = getCacheFilename(key);
+	FILE* f = fopen(cacheFilename.c_str(), "rb");
+	if (!f) {
+		return false; // not cached
+	}
+	CacheFileHeader header;
+	if (fread(&header, sizeof(header), 1, f) != 1 ||
+			memcmp(header.mMagic, "GSTC", 4) != 0 ||
+			header.mVersion != FILE_VERSION) {
+		LOGW("Texture cache file '%s' is invalid\n", cacheFilename.c_str());
+		fclose(f);
+		return false;
+	}
+	// --> the image file is decoded again (and the cache file is overwritten)
+	size_t dataSize = getValidDataSize(header);
+	if (!dataSize) {
+		LOGW("Texture cache file '%s' has a wrong header\n", cacheFilename.c_str());
+		fclose(f);
+		return false;
+	}
+	ImageDataType dataType = static_cast<ImageDataType>(header.mDataType);
+	bool isCompressed = header.mCompression != uint32_t(TexCompression::NONE);
+	unsigned int bytePerPixel = isCompressed ? 0 : header.mChannelCount * getBytePerChannel(dataType);
+	unsigned char* data = allocImageData(dataSize);
+	if (!data) {
+		fclose(f);
+		return false;
+	}
+	if (fread(data, 1, dataSize, f) != dataSize) {
+		LOGW("Texture cache file '%s' is truncated\n", cacheFilename.c_str());
+		freeImageData(data);
+		fclose(f);
+		return false;
+	}
+	fclose(f);
+
+	freeImageData(outImage.mData);
+	outImage.mData = data;
+	outImage.mWidth = header.mWidth;
+	outImage.mHeight = header.mHeight;
+	outImage.mBytePerPixel = bytePerPixel;
+	outImage.mChannelCount = header.mChannelCount;
+	outImage.mDataType = dataType;
+	outImage.mCompression = static_cast<TexCompression>(header.mCompression);
+	outImage.mLevelCount = header.mLevelCount;
+	outImage.mCompressedSize = isCompressed ? dataSize : 0;
+	return true;
+}
+
+bool gs::TextureCache::write(uint64_t key, const DecodedImage& image) const
+{
+	if (!mIsValid || !image.mData) {
+		return false;
+	}
+	std::string cacheFilename = getCacheFilename(key);
+	// write into a temporary file first. Otherwise another thread (or
+	// process) could read a half written cache file. The process id
+	// --> processes which share the directory don't use the same name.
+	char tmpPostfix[48];
+	snprintf(tmpPostfix, 48, ".tmp%u_%u", getProcessId(), mTmpFileCounter++);
+	std::string tmpFilename = cacheFilename + tmpPostfix;
+	FILE* f = fopen(tmpFilename.c_str(), "wb");
+	if (!f) {
+		LOGW("Can't create texture cache file '%s'\n", tmpFilename.c_str());
+		return false;
+	}
+	CacheFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.mMagic, "GSTC", 4);
+	header.mVersion = FILE_VERSION;
+	header.mWidth = image.mWidth;
+	header.mHeight = image.mHeight;
+	header.mChannelCount = image.mChannelCount;
+	header.mDataType = static_cast<uint32_t>(image.mDataType);
+	header.mCompression = static_cast<uint32_t>(image.mCompression);
+	header.mLevelCount = image.mLevelCount;
+	size_t dataSize = image.getDataSize();
+	header.mDataSize = static_cast<uint32_t>(dataSize);
+	bool success = fwrite(&header, sizeof(header), 1, f) == 1 &&
+			fwrite(image.mData, 1, dataSize, f) == dataSize;
+	if (fclose(f) != 0) {
+		success = false;
+	}
+	if (!success || rename(tmpFilename.c_str(), cacheFilename.c_str()) != 0) {
+		LOGW("Can't write texture cache file '%s'\n", cacheFilename.c_str());
+		remove(tmpFilename.c_str());
+		return false;
+	}
+	return true;
+}
+
+std::string gs::TextureCache::getCacheFilename(uint64_t key) const
+{
+	char name[32];
+	snprintf(name, 32, "%016" PRIx64 ".gstc", key);
+	return mDirectory + "/" + name;
+}
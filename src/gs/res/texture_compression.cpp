@@ -0,0 +1,597 @@
+#include <gs/res/texture_compression.h>
+#include <gs/res/texture_decoder.h>
+#include <gs/res/mipmap_builder.h>
+#include <gs/system/log.h>
+#include <vector>
+#include <math.h>
+#include <string.h>
+
+namespace gs
+{
+	namespace
+	{
+		const float BC7_WEIGHTS4[16] = {
+				0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64
+		};
+
+		bool isS3tcSupported()
+		{
+#ifdef GLSLSCENE_USE_GLEW
+			return GLEW_EXT_texture_compression_s3tc;
+#else
+			return false;
+#endif
+		}
+
+		bool isBptcSupported()
+		{
+#ifdef GLSLSCENE_USE_GLEW
+			return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+#else
+			return false;
+#endif
+		}
+
+		unsigned int getBlockBytes(TexCompression compression)
+		{
+			return (compression == TexCompression::BC1) ? 8 : 16;
+		}
+
+		// 4x4 pixels of the image. Pixels outside of the image are clamped.
+		void fetchBlock(const unsigned char* rgba, unsigned int width,
+				unsigned int height, unsigned int bx, unsigned int by,
+				float px[16][4])
+		{
+			for (unsigned int y = 0; y < 4; ++y) {
+				unsigned int iy = (by * 4 + y < height) ? by * 4 + y : height - 1;
+				for (unsigned int x = 0; x < 4; ++x) {
+					unsigned int ix = (bx * 4 + x < width) ? bx * 4 + x : width - 1;
+					const unsigned char* p = rgba + (size_t(iy) * width + ix) * 4;
+					for (unsigned int c = 0; c < 4; ++c) {
+						px[y * 4 + x][c] = p[c];
+					}
+				}
+			}
+		}
+
+		/**
+		 * Endpoints of the line which fits best to the pixels (principal
+		 * axis by power iteration). Only the first channelCount channels
+		 * are used.
+		 */
+		void getEndpoints(const float px[16][4], unsigned int channelCount,
+				float e0[4], float e1[4])
+		{
+			float mean[4] = {0, 0, 0, 0};
+			for (unsigned int i = 0; i < 16; ++i) {
+				for (unsigned int c = 0; c < channelCount; ++c) {
+					mean[c] += px[i][c] * (1.0f / 16.0f);
+				}
+			}
+			float cov[4][4] = {};
+			for (unsigned int i = 0; i < 16; ++i) {
+				for (unsigned int a = 0; a < channelCount; ++a) {
+					for (unsigned int b = 0; b < channelCount; ++b) {
+						cov[a][b] += (px[i][a] - mean[a]) * (px[i][b] - mean[b]);
+					}
+				}
+			}
+			// start with the row of the channel with the biggest variance
+			unsigned int maxChannel = 0;
+			for (unsigned int c = 1; c < channelCount; ++c) {
+				if (cov[c][c] > cov[maxChannel][maxChannel]) {
+					maxChannel = c;
+				}
+			}
+			float axis[4] = {0, 0, 0, 0};
+			for (unsigned int c = 0; c < channelCount; ++c) {
+				axis[c] = cov[maxChannel][c];
+			}
+			for (unsigned int iter = 0; iter < 8; ++iter) {
+				float v[4] = {0, 0, 0, 0};
+				float maxAbs = 0.0f;
+				for (unsigned int a = 0; a < channelCount; ++a) {
+					for (unsigned int b = 0; b < channelCount; ++b) {
+						v[a] += cov[a][b] * axis[b];
+					}
+					maxAbs = (fabsf(v[a]) > maxAbs) ? fabsf(v[a]) : maxAbs;
+				}
+				if (maxAbs <= 0.0f) {
+					break;
+				}
+				for (unsigned int c = 0; c < channelCount; ++c) {
+					axis[c] = v[c] / maxAbs;
+				}
+			}
+			float len = 0.0f;
+			for (unsigned int c = 0; c < channelCount; ++c) {
+				len += axis[c] * axis[c];
+			}
+			len = sqrtf(len);
+			float tMin = 0.0f;
+			float tMax = 0.0f;
+			if (len > 0.0f) {
+				for (unsigned int c = 0; c < channelCount; ++c) {
+					axis[c] /= len;
+				}
+				tMin = 1e30f;
+				tMax = -1e30f;
+				for (unsigned int i = 0; i < 16; ++i) {
+					float t = 0.0f;
+					for (unsigned int c = 0; c < channelCount; ++c) {
+						t += (px[i][c] - mean[c]) * axis[c];
+					}
+					tMin = (t < tMin) ? t : tMin;
+					tMax = (t > tMax) ? t : tMax;
+				}
+			}
+			for (unsigned int c = 0; c < 4; ++c) {
+				float v0 = mean[c] + tMin * axis[c];
+				float v1 = mean[c] + tMax * axis[c];
+				e0[c] = (v0 < 0.0f) ? 0.0f : ((v0 > 255.0f) ? 255.0f : v0);
+				e1[c] = (v1 < 0.0f) ? 0.0f : ((v1 > 255.0f) ? 255.0f : v1);
+			}
+		}
+
+		unsigned int findNearest(const float p[4], const float palette[][4],
+				unsigned int paletteSize, unsigned int channelCount)
+		{
+			unsigned int best = 0;
+			float bestDist = 1e30f;
+			for (unsigned int i = 0; i < paletteSize; ++i) {
+				float dist = 0.0f;
+				for (unsigned int c = 0; c < channelCount; ++c) {
+					float d = p[c] - palette[i][c];
+					dist += d * d;
+				}
+				if (dist < bestDist) {
+					bestDist = dist;
+					best = i;
+				}
+			}
+			return best;
+		}
+
+		uint16_t to565(const float c[4])
+		{
+			unsigned int r = static_cast<unsigned int>(c[0] * 31.0f / 255.0f + 0.5f);
+			unsigned int g = static_cast<unsigned int>(c[1] * 63.0f / 255.0f + 0.5f);
+			unsigned int b = static_cast<unsigned int>(c[2] * 31.0f / 255.0f + 0.5f);
+			return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+		}
+
+		void from565(uint16_t c, float out[4])
+		{
+			unsigned int r = (c >> 11) & 0x1f;
+			unsigned int g = (c >> 5) & 0x3f;
+			unsigned int b = c & 0x1f;
+			out[0] = float((r << 3) | (r >> 2));
+			out[1] = float((g << 2) | (g >> 4));
+			out[2] = float((b << 3) | (b >> 2));
+			out[3] = 255.0f;
+		}
+
+		// BC1 color block (8 bytes), always the 4 color mode
+		void encodeColorBlock(const float px[16][4], unsigned char* out)
+		{
+			float e0[4];
+			float e1[4];
+			getEndpoints(px, 3, e0, e1);
+			uint16_t c0 = to565(e1);
+			uint16_t c1 = to565(e0);
+			if (c0 < c1) {
+				uint16_t tmp = c0;
+				c0 = c1;
+				c1 = tmp;
+			}
+			float palette[4][4];
+			from565(c0, palette[0]);
+			from565(c1, palette[1]);
+			for (unsigned int c = 0; c < 3; ++c) {
+				palette[2][c] = floorf((2.0f * palette[0][c] + palette[1][c]) / 3.0f);
+				palette[3][c] = floorf((palette[0][c] + 2.0f * palette[1][c]) / 3.0f);
+			}
+			uint32_t indices = 0;
+			if (c0 != c1) {
+				for (unsigned int i = 0; i < 16; ++i) {
+					indices |= findNearest(px[i], palette, 4, 3) << (2 * i);
+				}
+			}
+			out[0] = c0 & 0xff;
+			out[1] = c0 >> 8;
+			out[2] = c1 & 0xff;
+			out[3] = c1 >> 8;
+			for (unsigned int i = 0; i < 4; ++i) {
+				out[4 + i] = (indices >> (8 * i)) & 0xff;
+			}
+		}
+
+		// BC3 alpha block (8 bytes), 8 alpha values mode
+		void encodeAlphaBlock(const float px[16][4], unsigned char* out)
+		{
+			float aMin = 255.0f;
+			float aMax = 0.0f;
+			for (unsigned int i = 0; i < 16; ++i) {
+				aMin = (px[i][3] < aMin) ? px[i][3] : aMin;
+				aMax = (px[i][3] > aMax) ? px[i][3] : aMax;
+			}
+			unsigned int a0 = static_cast<unsigned int>(aMax + 0.5f);
+			unsigned int a1 = static_cast<unsigned int>(aMin + 0.5f);
+			float palette[8][4] = {};
+			palette[0][0] = float(a0);
+			palette[1][0] = float(a1);
+			for (unsigned int i = 1; i < 7; ++i) {
+				palette[i + 1][0] = float(((7 - i) * a0 + i * a1) / 7);
+			}
+			uint64_t indices = 0;
+			if (a0 != a1) {
+				for (unsigned int i = 0; i < 16; ++i) {
+					float a[4] = {px[i][3], 0, 0, 0};
+					indices |= uint64_t(findNearest(a, palette, 8, 1)) << (3 * i);
+				}
+			}
+			out[0] = static_cast<unsigned char>(a0);
+			out[1] = static_cast<unsigned char>(a1);
+			for (unsigned int i = 0; i < 6; ++i) {
+				out[2 + i] = (indices >> (8 * i)) & 0xff;
+			}
+		}
+
+		class BitWriter
+		{
+		public:
+			BitWriter(unsigned char* data) :mData(data), mPos(0) {}
+			void write(uint32_t value, unsigned int bitCount)
+			{
+				for (unsigned int i = 0; i < bitCount; ++i, ++mPos) {
+					if ((value >> i) & 1) {
+						mData[mPos >> 3] |= static_cast<unsigned char>(1 << (mPos & 7));
+					}
+				}
+			}
+		private:
+			unsigned char* mData;
+			unsigned int mPos;
+		};
+
+		/**
+		 * Quantize an endpoint to 7 bit per channel plus one shared p-bit
+		 * (BC7 mode 6). The p-bit with the smaller error is used.
+		 */
+		void quantizeBc7Endpoint(const float e[4], unsigned int q[4],
+				unsigned int& pBit, float expanded[4])
+		{
+			float bestError = 1e30f;
+			for (unsigned int p = 0; p < 2; ++p) {
+				unsigned int tq[4];
+				float error = 0.0f;
+				for (unsigned int c = 0; c < 4; ++c) {
+					int v = static_cast<int>((e[c] - float(p)) * 0.5f + 0.5f);
+					v = (v < 0) ? 0 : ((v > 127) ? 127 : v);
+					tq[c] = static_cast<unsigned int>(v);
+					float d = float((tq[c] << 1) | p) - e[c];
+					error += d * d;
+				}
+				if (error < bestError) {
+					bestError = error;
+					pBit = p;
+					for (unsigned int c = 0; c < 4; ++c) {
+						q[c] = tq[c];
+						expanded[c] = float((tq[c] << 1) | p);
+					}
+				}
+			}
+		}
+
+		// return the error (sum of squared differences)
+		float findBc7Indices(const float px[16][4], const float ex[2][4],
+				unsigned int indices[16])
+		{
+			float palette[16][4];
+			for (unsigned int i = 0; i < 16; ++i) {
+				float w = BC7_WEIGHTS4[i];
+				for (unsigned int c = 0; c < 4; ++c) {
+					palette[i][c] = floorf(((64.0f - w) * ex[0][c] + w * ex[1][c] + 32.0f) / 64.0f);
+				}
+			}
+			float error = 0.0f;
+			for (unsigned int i = 0; i < 16; ++i) {
+				indices[i] = findNearest(px[i], palette, 16, 4);
+				for (unsigned int c = 0; c < 4; ++c) {
+					float d = px[i][c] - palette[indices[i]][c];
+					error += d * d;
+				}
+			}
+			return error;
+		}
+
+		/**
+		 * Least squares fit of the endpoints for the given indices.
+		 * @return False if the endpoints can't be calculated
+		 *         (e.g. all pixels use the same index).
+		 */
+		bool refitBc7Endpoints(const float px[16][4], const unsigned int indices[16],
+				float e0[4], float e1[4])
+		{
+			float a = 0.0f;
+			float b = 0.0f;
+			float c = 0.0f;
+			float rhs0[4] = {0, 0, 0, 0};
+			float rhs1[4] = {0, 0, 0, 0};
+			for (unsigned int i = 0; i < 16; ++i) {
+				float w = BC7_WEIGHTS4[indices[i]] / 64.0f;
+				a += (1.0f - w) * (1.0f - w);
+				b += (1.0f - w) * w;
+				c += w * w;
+				for (unsigned int ch = 0; ch < 4; ++ch) {
+					rhs0[ch] += (1.0f - w) * px[i][ch];
+					rhs1[ch] += w * px[i][ch];
+				}
+			}
+			float det = a * c - b * b;
+			if (fabsf(det) < 1e-6f) {
+				return false;
+			}
+			for (unsigned int ch = 0; ch < 4; ++ch) {
+				float v0 = (c * rhs0[ch] - b * rhs1[ch]) / det;
+				float v1 = (a * rhs1[ch] - b * rhs0[ch]) / det;
+				e0[ch] = (v0 < 0.0f) ? 0.0f : ((v0 > 255.0f) ? 255.0f : v0);
+				e1[ch] = (v1 < 0.0f) ? 0.0f : ((v1 > 255.0f) ? 255.0f : v1);
+			}
+			return true;
+		}
+
+		// BC7 block (16 bytes) with mode 6: one subset, rgba, 4 bit indices
+		void encodeBc7Block(const float px[16][4], unsigned char* out)
+		{
+			float e0[4];
+			float e1[4];
+			getEndpoints(px, 4, e0, e1);
+			unsigned int q[2][4];
+			unsigned int pBit[2] = {0, 0};
+			float ex[2][4];
+			quantizeBc7Endpoint(e0, q[0], pBit[0], ex[0]);
+			quantizeBc7Endpoint(e1, q[1], pBit[1], ex[1]);
+			unsigned int indices[16];
+			float error = findBc7Indices(px, ex, indices);
+
+			// the endpoints of the principal axis are not optimal
+			// (e.g. for outliers) --> refine them
+			for (unsigned int iter = 0; iter < 2 && error > 0.0f; ++iter) {
+				if (!refitBc7Endpoints(px, indices, e0, e1)) {
+					break;
+				}
+				unsigned int rq[2][4];
+				unsigned int rpBit[2] = {0, 0};
+				float rex[2][4];
+				quantizeBc7Endpoint(e0, rq[0], rpBit[0], rex[0]);
+				quantizeBc7Endpoint(e1, rq[1], rpBit[1], rex[1]);
+				unsigned int rindices[16];
+				float rerror = findBc7Indices(px, rex, rindices);
+				if (rerror >= error) {
+					break;
+				}
+				error = rerror;
+				memcpy(q, rq, sizeof(q));
+				memcpy(pBit, rpBit, sizeof(pBit));
+				memcpy(indices, rindices, sizeof(indices));
+			}
+			// the msb of the first index is implicit 0 --> swap the endpoints
+			if (indices[0] & 8) {
+				for (unsigned int c = 0; c < 4; ++c) {
+					unsigned int tmp = q[0][c];
+					q[0][c] = q[1][c];
+					q[1][c] = tmp;
+				}
+				unsigned int tmp = pBit[0];
+				pBit[0] = pBit[1];
+				pBit[1] = tmp;
+				for (unsigned int i = 0; i < 16; ++i) {
+					indices[i] = 15 - indices[i];
+				}
+			}
+			memset(out, 0, 16);
+			BitWriter bits(out);
+			bits.write(1 << 6, 7); // mode 6
+			for (unsigned int c = 0; c < 4; ++c) {
+				bits.write(q[0][c], 7);
+				bits.write(q[1][c], 7);
+			}
+			bits.write(pBit[0], 1);
+			bits.write(pBit[1], 1);
+			bits.write(indices[0], 3);
+			for (unsigned int i = 1; i < 16; ++i) {
+				bits.write(indices[i], 4);
+			}
+		}
+
+		void compressLevel(const unsigned char* rgba, unsigned int width,
+				unsigned int height, TexCompression compression, unsigned char* dst)
+		{
+			unsigned int blocksX = (width + 3) / 4;
+			unsigned int blocksY = (height + 3) / 4;
+			float px[16][4];
+			for (unsigned int by = 0; by < blocksY; ++by) {
+				for (unsigned int bx = 0; bx < blocksX; ++bx) {
+					fetchBlock(rgba, width, height, bx, by, px);
+					switch (compression) {
+						case TexCompression::BC1:
+							encodeColorBlock(px, dst);
+							dst += 8;
+							break;
+						case TexCompression::BC3:
+							encodeAlphaBlock(px, dst);
+							encodeColorBlock(px, dst + 8);
+							dst += 16;
+							break;
+						case TexCompression::BC7:
+							encodeBc7Block(px, dst);
+							dst += 16;
+							break;
+						case TexCompression::NONE:
+						case TexCompression::AUTO:
+							return;
+					}
+				}
+			}
+		}
+
+		bool hasTransparentPixels(const unsigned char* rgba, unsigned int width,
+				unsigned int height)
+		{
+			size_t pixelCount = size_t(width) * height;
+			for (size_t i = 0; i < pixelCount; ++i) {
+				if (rgba[i * 4 + 3] != 255) {
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+}
+
+const char* gs::getCompressionStr(TexCompression compression)
+{
+	switch (compression) {
+		case TexCompression::NONE:
+			return "none";
+		case TexCompression::BC1:
+			return "bc1";
+		case TexCompression::BC3:
+			return "bc3";
+		case TexCompression::BC7:
+			return "bc7";
+		case TexCompression::AUTO:
+			return "auto";
+	}
+	return "unknown";
+}
+
+bool gs::getCompressionFromStr(const std::string& name, TexCompression& outCompression)
+{
+	static const TexCompression compressions[] = {
+			TexCompression::NONE, TexCompression::BC1, TexCompression::BC3,
+			TexCompression::BC7, TexCompression::AUTO
+	};
+	for (TexCompression c : compressions) {
+		if (name == getCompressionStr(c)) {
+			outCompression = c;
+			return true;
+		}
+	}
+	return false;
+}
+
+gs::TexCompression gs::getSupportedCompression(TexCompression compression)
+{
+	switch (compression) {
+		case TexCompression::NONE:
+			return TexCompression::NONE;
+		case TexCompression::BC1:
+		case TexCompression::BC3:
+			if (isS3tcSupported()) {
+				return compression;
+			}
+			LOGW("S3TC texture compression is not supported --> no compression\n");
+			return TexCompression::NONE;
+		case TexCompression::BC7:
+			if (isBptcSupported()) {
+				return compression;
+			}
+			LOGW("BPTC texture compression is not supported --> no compression\n");
+			return TexCompression::NONE;
+		case TexCompression::AUTO:
+			if (isBptcSupported()) {
+				return TexCompression::BC7;
+			}
+			if (isS3tcSupported()) {
+				return TexCompression::AUTO;
+			}
+			return TexCompression::NONE;
+	}
+	return TexCompression::NONE;
+}
+
+GLenum gs::getCompressedGlFormat(TexCompression compression)
+{
+	switch (compression) {
+		case TexCompression::BC1:
+			return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case TexCompression::BC3:
+			return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case TexCompression::BC7:
+			return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		case TexCompression::NONE:
+		case TexCompression::AUTO:
+			break;
+	}
+	return GL_RGBA;
+}
+
+size_t gs::getCompressedLevelSize(TexCompression compression,
+		unsigned int width, unsigned int height)
+{
+	return size_t((width + 3) / 4) * ((height + 3) / 4) * getBlockBytes(compression);
+}
+
+bool gs::compressImage(DecodedImage& image, TexCompression compression, bool mipmap)
+{
+	if (compression == TexCompression::NONE) {
+		return true;
+	}
+	if (image.mCompression != TexCompression::NONE || image.mBytePerPixel != 4 ||
+			image.mChannelCount != 4 || image.mDataType != ImageDataType::UINT8 ||
+			!image.mData || !image.mWidth || !image.mHeight) {
+		LOGE("Only uncompressed rgba images can be compressed\n");
+		return false;
+	}
+	if (compression == TexCompression::AUTO) {
+		compression = hasTransparentPixels(image.mData, image.mWidth, image.mHeight) ?
+				TexCompression::BC3 : TexCompression::BC1;
+	}
+
+	unsigned int levelCount = 1;
+	size_t compressedSize = getCompressedLevelSize(compression, image.mWidth, image.mHeight);
+	if (mipmap) {
+		unsigned int w = image.mWidth;
+		unsigned int h = image.mHeight;
+		while (w > 1 || h > 1) {
+			w = (w > 1) ? w / 2 : 1;
+			h = (h > 1) ? h / 2 : 1;
+			compressedSize += getCompressedLevelSize(compression, w, h);
+			++levelCount;
+		}
+	}
+	unsigned char* compressed = allocImageData(compressedSize);
+	if (!compressed) {
+		return false;
+	}
+
+	unsigned int w = image.mWidth;
+	unsigned int h = image.mHeight;
+	const unsigned char* src = image.mData;
+	std::vector<unsigned char> levelBuffer[2];
+	unsigned char* dst = compressed;
+	for (unsigned int level = 0; level < levelCount; ++level) {
+		if (level > 0) {
+			std::vector<unsigned char>& buf = levelBuffer[level & 1];
+			unsigned int nw = (w > 1) ? w / 2 : 1;
+			unsigned int nh = (h > 1) ? h / 2 : 1;
+			buf.resize(size_t(nw) * nh * 4);
+			downsampleImage(src, w, h, buf.data(), 4);
+			src = buf.data();
+			w = nw;
+			h = nh;
+		}
+		compressLevel(src, w, h, compression, dst);
+		dst += getCompressedLevelSize(compression, w, h);
+	}
+
+	freeImageData(image.mData);
+	image.mData = compressed;
+	image.mBytePerPixel = 0;
+	image.mCompression = compression;
+	image.mLevelCount = levelCount;
+	image.mCompressedSize = compressedSize;
+	return true;
+}
@@ -0,0 +1,296 @@
+#include <gs/res/texture_decoder.h>
+#include <gs/res/texture_cache.h>
+#include <gs/res/texture_compression.h>
+#include <gs/system/log.h>
+
+#define STB_IMAGE_STATIC
+// the failure reason of stb_image is a global variable (not thread safe)
+// --> not used by the decoder threads
+#define STBI_NO_FAILURE_STRINGS
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+
+namespace gs
+{
+	namespace
+	{
+		void flipRows(unsigned char* data, unsigned int width,
+				unsigned int height, unsigned int bytePerPixel)
+		{
+			size_t lineBytes = size_t(width) * bytePerPixel;
+			std::vector<unsigned char> tmp(lineBytes);
+			unsigned char* top = data;
+			unsigned char* bottom = data + (height - 1) * lineBytes;
+			while (top < bottom) {
+				memcpy(tmp.data(), top, lineBytes);
+				memcpy(top, bottom, lineBytes);
+				memcpy(bottom, tmp.data(), lineBytes);
+				top += lineBytes;
+				bottom -= lineBytes;
+			}
+		}
+
+		// the file is only opened once (not for each stbi_info(), stbi_load(), ...)
+		bool readFileContent(const std::string& filename, std::vector<unsigned char>& outContent)
+		{
+			FILE* f = fopen(filename.c_str(), "rb");
+			if (!f) {
+				return false;
+			}
+			bool success = fseek(f, 0, SEEK_END) == 0;
+			long size = success ? ftell(f) : -1;
+			success = size > 0 && size <= INT_MAX && fseek(f, 0, SEEK_SET) == 0;
+			if (success) {
+				outContent.resize(size_t(size));
+				success = fread(outContent.data(), 1, outContent.size(), f) == outContent.size();
+			}
+			fclose(f);
+			return success;
+		}
+	}
+}
+
+unsigned char* gs::allocImageData(size_t size)
+{
+	return static_cast<unsigned char*>(STBI_MALLOC(size));
+}
+
+void gs::freeImageData(unsigned char* data)
+{
+	if (data) {
+		stbi_image_free(data);
+	}
+}
+
+unsigned char* gs::DecodedImage::releaseData()
+{
+	unsigned char* data = mData;
+	mData = nullptr;
+	return data;
+}
+
+bool gs::decodeImageFile(const std::string& filename,
+		const ImageLoadOptions& options, DecodedImage& outImage)
+{
+	if (filename.size() < 4) {
+		LOGE("to short filename\n");
+		return false;
+	}
+	std::vector<unsigned char> content;
+	if (!readFileContent(filename, content)) {
+		LOGE("read image '%s' failed\n", filename.c_str());
+		return false;
+	}
+	const stbi_uc* buffer = content.data();
+	int len = static_cast<int>(content.size());
+	int desiredChannels = STBI_rgb_alpha; // 4
+	if (options.mChannelAware) {
+		int x = 0, y = 0, comp = 0;
+		if (stbi_info_from_memory(buffer, len, &x, &y, &comp) && comp >= 1 && comp <= 4) {
+			desiredChannels = comp;
+		}
+	}
+	ImageDataType dataType = ImageDataType::UINT8;
+	if (options.mHighPrecision) {
+		if (stbi_is_hdr_from_memory(buffer, len)) {
+			dataType = ImageDataType::FLOAT;
+		}
+		else if (stbi_is_16_bit_from_memory(buffer, len)) {
+			dataType = ImageDataType::UINT16;
+		}
+	}
+	// stbi_set_flip_vertically_on_load() is never called. It's a global
+	// setting and not thread safe. The flipping is done after decoding.
+	int x = 0, y = 0, channels_in_file = 0;
+	void* pixelBuffer = nullptr;
+	unsigned int bytePerChannel = 1;
+	switch (dataType) {
+		case ImageDataType::UINT8:
+			pixelBuffer = stbi_load_from_memory(buffer, len, &x, &y,
+					&channels_in_file, desiredChannels);
+			break;
+		case ImageDataType::UINT16:
+			pixelBuffer = stbi_load_16_from_memory(buffer, len, &x, &y,
+					&channels_in_file, desiredChannels);
+			bytePerChannel = 2;
+			break;
+		case ImageDataType::FLOAT:
+			pixelBuffer = stbi_loadf_from_memory(buffer, len, &x, &y,
+					&channels_in_file, desiredChannels);
+			bytePerChannel = 4;
+			break;
+	}
+	if (!pixelBuffer || !x || !y) {
+		LOGE("load image '%s' failed\n", filename.c_str());
+		if (pixelBuffer) {
+			stbi_image_free(pixelBuffer);
+		}
+		return false;
+	}
+	// the buffer of stb_image is used without a copy
+	freeImageData(outImage.mData);
+	outImage.mData = static_cast<unsigned char*>(pixelBuffer);
+	outImage.mWidth = x;
+	outImage.mHeight = y;
+	outImage.mChannelCount = desiredChannels;
+	outImage.mDataType = dataType;
+	outImage.mBytePerPixel = desiredChannels * bytePerChannel;
+	outImage.mCompression = TexCompression::NONE;
+	outImage.mLevelCount = 1;
+	outImage.mCompressedSize = 0;
+	if (options.mFlipVertically) {
+		flipRows(outImage.mData, outImage.mWidth, outImage.mHeight, outImage.mBytePerPixel);
+	}
+	return true;
+}
+
+std::string gs::ImageLoadOptions::toString() const
+{
+	std::string str = mFlipVertically ? "flip" : "noflip";
+	if (mChannelAware) {
+		str += " channels";
+	}
+	if (mHighPrecision) {
+		str += " hdr";
+	}
+	if (mCompression != TexCompression::NONE) {
+		str += " ";
+		str += getCompressionStr(mCompression);
+		if (mMipmap) {
+			str += " mipmap";
+		}
+	}
+	return str;
+}
+
+bool gs::loadImageFile(const std::string& filename,
+		const ImageLoadOptions& options, DecodedImage& outImage)
+{
+	if (!decodeImageFile(filename, options, outImage)) {
+		return false;
+	}
+	if (options.mCompression != TexCompression::NONE &&
+			!compressImage(outImage, options.mCompression, options.mMipmap)) {
+		LOGE("compression of '%s' failed\n", filename.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool gs::getImageFileInfo(const std::string& filename, unsigned int& width,
+		unsigned int& height, unsigned int& channelsInFile)
+{
+	int x = 0, y = 0, comp = 0;
+	if (!stbi_info(filename.c_str(), &x, &y, &comp) || x <= 0 || y <= 0) {
+		return false;
+	}
+	width = x;
+	height = y;
+	channelsInFile = comp;
+	return true;
+}
+
+gs::TextureDecoder::TextureDecoder(unsigned int threadCount)
+		:mThreads(), mJobs(), mRunning(true), mSync(), mJobAvailable(), mJobDone()
+{
+	if (!threadCount) {
+		unsigned int cores = std::thread::hardware_concurrency();
+		threadCount = (cores > 1) ? cores - 1 : 1;
+	}
+	for (unsigned int i = 0; i < threadCount; ++i) {
+		mThreads.emplace_back(&TextureDecoder::workerThread, this);
+	}
+}
+
+gs::TextureDecoder::~TextureDecoder()
+{
+	{
+		std::lock_guard<std::mutex> lock(mSync);
+		mRunning = false;
+		mJobs.clear();
+	}
+	mJobAvailable.notify_all();
+	for (std::thread& t : mThreads) {
+		t.join();
+	}
+}
+
+std::shared_ptr<gs::TextureDecodeJob> gs::TextureDecoder::decode(
+		const std::string& filename, const ImageLoadOptions& options,
+		const std::shared_ptr<TextureCache>& cache)
+{
+	std::shared_ptr<TextureDecodeJob> job = std::make_shared<TextureDecodeJob>(
+			filename, options, cache);
+	{
+		std::lock_guard<std::mutex> lock(mSync);
+		mJobs.push_back(job);
+	}
+	mJobAvailable.notify_one();
+	return job;
+}
+
+void gs::TextureDecoder::copyToBuffer(const std::shared_ptr<TextureDecodeJob>& job,
+		unsigned char* dst)
+{
+	{
+		std::lock_guard<std::mutex> lock(mSync);
+		job->mCopyDst = dst;
+		job->mIsCopied.store(false);
+		// the upload waits for the copy --> before the queued decodings
+		mJobs.push_front(job);
+	}
+	mJobAvailable.notify_one();
+}
+
+void gs::TextureDecoder::wait(const TextureDecodeJob& job)
+{
+	std::unique_lock<std::mutex> lock(mSync);
+	mJobDone.wait(lock, [&job] { return job.isDone(); });
+}
+
+unsigned int gs::TextureDecoder::getQueuedCount() const
+{
+	std::lock_guard<std::mutex> lock(mSync);
+	return static_cast<unsigned int>(mJobs.size());
+}
+
+void gs::TextureDecoder::workerThread()
+{
+	for (;;) {
+		std::shared_ptr<TextureDecodeJob> job;
+		{
+			std::unique_lock<std::mutex> lock(mSync);
+			mJobAvailable.wait(lock, [this] { return !mRunning || !mJobs.empty(); });
+			if (!mRunning) {
+				return;
+			}
+			job = mJobs.front().lock();
+			mJobs.pop_front();
+		}
+		if (!job) {
+			continue; // not needed anymore
+		}
+		if (job->mCopyDst) {
+			// see copyToBuffer()
+			const DecodedImage& image = job->mImage;
+			memcpy(job->mCopyDst, image.mData, image.getDataSize());
+			job->mIsCopied.store(true);
+			continue;
+		}
+		if (job->mCache) {
+			job->mIsSuccess = job->mCache->load(job->mFilename, job->mOptions, job->mImage);
+		}
+		else {
+			job->mIsSuccess = loadImageFile(job->mFilename, job->mOptions, job->mImage);
+		}
+		{
+			// with the lock --> wait() can't miss the notification
+			std::lock_guard<std::mutex> lock(mSync);
+			job->mIsDone.store(true);
+		}
+		mJobDone.notify_all();
+	}
+}
@@ -1,11 +1,15 @@
 #include <gs/system/file_change_monitoring.h>
 
 #include <gs/system/log.h>
+#include <gs/system/hot_reload_statistic.h>
 #include <gs/common/fs.h>
+#include <gs/common/hash.h>
 #include <string.h>
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <vector>
+#include <chrono>
 #if defined(_MSC_VER)
 #pragma comment(lib, "comctl32.lib")
 #pragma comment(lib, "user32.lib")
@@ -31,11 +35,23 @@
 #define BUF_LEN     ( MAX_EVENTS * ( EVENT_SIZE + LEN_NAME )) /*buffer to store the data of events*/
 #endif
 
+namespace gs
+{
+	namespace
+	{
+		// a file which doesn't exist has the same hash like an empty file
+		uint64_t calcContentHash(const std::string& filename)
+		{
+			return hash::hashString(hash::FNV_OFFSET_BASIS, fs::readFileAsString(filename));
+		}
+	}
+}
+
 gs::FileChangeMonitoring::FileChangeMonitoring(bool useSeparateMonitoringThread)
 		:mUseSeparateMonitoringThread(useSeparateMonitoringThread),
 		mRunning(false), mInotifyFd(-1), mMonitoringThread(),
 		mFileChangeCount(0),
-		mFileChangeMonitoringCallCount(0),
+		mFileChangeMonitoringCallCount(0), mUnchangedContentCount(0),
 		mFilesByWatchId(), mFilesByWatchDir(), mFilesByName(), mFilesByCallbackId(),
 		mNextFileCallbackId(1), mSync()
 {
@@ -86,7 +102,8 @@ gs::FileChangeMonitoring::~FileChangeMonitoring()
 }
 
 unsigned int gs::FileChangeMonitoring::addFile(const std::string& origFilename,
-		TCallback callback, const std::shared_ptr<void>& param1, void* param2)
+		TCallback callback, const std::shared_ptr<void>& param1, void* param2,
+		uint32_t settleMsec, bool checkContent)
 {
 	std::string dirname;
 	std::string basename;
@@ -119,12 +136,23 @@ unsigned int gs::FileChangeMonitoring::addFile(const std::string& origFilename,
 		LOGE("Parent directory is not a directory\n");
 		return 0;
 	}
+	// read before locking (the file can be large)
+	uint64_t contentHash = checkContent ? calcContentHash(fname) : 0;
 
 	std::lock_guard<std::mutex> lock(mSync);
 	
 	unsigned int fileId = mNextFileCallbackId;
 	++mNextFileCallbackId;
 
+	auto setCallbackOptions = [&](FileEntry& fentry) {
+		Callback* cb = fentry.getCallbackForFile(basename, fileId);
+		if (cb) {
+			cb->mSettleMsec = settleMsec;
+			cb->mCheckContent = checkContent;
+			cb->mContentHash = contentHash;
+		}
+	};
+
 	{
 		auto fileEntryIt = mFilesByName.find(fname);
 		if (fileEntryIt != mFilesByName.end()) {
@@ -132,6 +160,7 @@ unsigned int gs::FileChangeMonitoring::addFile(const std::string& origFilename,
 				LOGE("Fatal implementation error! Can't find name for file entry!\n");
 				return 0;
 			}
+			setCallbackOptions(*fileEntryIt->second.mFileEntry);
 			++fileEntryIt->second.mCount;
 			mFilesByCallbackId[fileId] = FileEntryNamePair(basename, fileEntryIt->second.mFileEntry);
 			return fileId;
@@ -208,6 +237,7 @@ unsigned int gs::FileChangeMonitoring::addFile(const std::string& origFilename,
 		++mFilesByName[fname].mCount;
 		mFilesByCallbackId[fileId] = FileEntryNamePair(basename, fentry);
 	}
+	setCallbackOptions(*fentry);
 	return fileId;
 }
 
@@ -230,6 +260,7 @@ bool gs::FileChangeMonitoring::removeFile(unsigned int callbackId)
 		return false;
 	}
 	mFilesByCallbackId.erase(fileEntryItByCbId); // always remove it from cb map
+	mChangeMap.erase(callbackId);
 
 	auto fileEntryItByName = mFilesByName.find(fname);
 	if (fileEntryItByName == mFilesByName.end()) {
@@ -318,6 +349,7 @@ void gs::FileChangeMonitoring::removeAllFiles()
 	mFilesByWatchId.clear();
 	mFilesByName.clear();
 	mFilesByCallbackId.clear();
+	mChangeMap.clear();
 }
 
 std::string gs::FileChangeMonitoring::toString() const
@@ -361,18 +393,17 @@ std::string gs::FileChangeMonitoring::toString() const
 
 void gs::FileChangeMonitoring::checkChanges()
 {
-	if (mUseSeparateMonitoringThread) {
-		LOGW("checkChanges() has no effect! Separate thread for file change monitoring is used!\n");
-		return;
-	}
-
-	int changeCount = monitoringFileChanges();
-	if (changeCount < 0) {
-		LOGW("monitoringFileChanges() return an error\n");
-	}
-	else if (changeCount > 0) {
-		//LOGI("%d files changed\n", changeCount);
+	if (!mUseSeparateMonitoringThread) {
+		int changeCount = monitoringFileChanges();
+		if (changeCount < 0) {
+			LOGW("monitoringFileChanges() return an error\n");
+		}
+		else if (changeCount > 0) {
+			//LOGI("%d files changed\n", changeCount);
+		}
 	}
+	takeEvents();
+	callSettledCallbacks();
 }
 
 void *gs::FileChangeMonitoring::posixMonitoringThread(void *thisFileChangeMonitoring)
@@ -401,40 +432,9 @@ void gs::FileChangeMonitoring::monitoringThread()
 int gs::FileChangeMonitoring::monitoringFileChanges()
 {
 #if defined(_MSC_VER)
+	// the events are pushed by FileChangedCallback()
 	MsgWaitForMultipleObjectsEx(0, NULL, 0, QS_ALLINPUT, MWMO_ALERTABLE);
-	if (mChangeMap.empty()) {
-		return 0;
-	}
-	int changeCount = 0;
-	uint32_t ts = SDL_GetTicks();
-	for (TChangeMapByCallbackId::iterator itChange = mChangeMap.begin(); itChange != mChangeMap.end(); ) {
-		// 300 for 300ms callback delay
-		if (ts > itChange->second + 300) {
-			unsigned int cbId = itChange->first;
-			const auto& itEntry = mFilesByCallbackId.find(cbId);
-			if (itEntry != mFilesByCallbackId.end()) {
-				const FileEntryNamePair& fen = itEntry->second;
-				Callback* cbPtr = fen.mFileEntry->getCallbackForFile(fen.mBasename, cbId);
-				if (cbPtr) {
-					Callback& cb = *cbPtr;
-					cb.mCbFunc(cb.mFileCallbackId, cb.mOrigFilename, cb.mParam1, cb.mParam2);
-					LOGI("Call callback function for file %s, orig name %s.\n", cb.mFilename.c_str(), cb.mOrigFilename.c_str());
-					++cb.mCallCount;
-					++mFileChangeMonitoringCallCount;
-				}
-			}
-			else {
-				LOGW("Can't find callback for callback id %u.\n", cbId);
-			}
-
-			itChange = mChangeMap.erase(itChange);
-			++changeCount;
-		}
-		else {
-			++itChange;
-		}
-	}
-	return changeCount;
+	return 0;
 #else
 	char buffer[BUF_LEN];
 	ssize_t length = 0;
@@ -448,6 +448,9 @@ int gs::FileChangeMonitoring::monitoringFileChanges()
 		return -1;
 	}
 
+	uint32_t ts = SDL_GetTicks();
+	// pushed after the lookup (without the lock)
+	std::vector<ChangeEvent> events;
 	int changeCount = 0;
 	//LOGI("One or more files changed\n");
 	struct inotify_event *event;
@@ -523,9 +526,8 @@ int gs::FileChangeMonitoring::monitoringFileChanges()
 					for (auto& cbIt : fnameIt->second.mCallbacks) {
 						Callback& cb = cbIt.second;
 						LOGI("file %s, orig name %s changed!\n", cb.mFilename.c_str(), cb.mOrigFilename.c_str());
-						cb.mCbFunc(cb.mFileCallbackId, cb.mOrigFilename, cb.mParam1, cb.mParam2);
-						++cb.mCallCount;
-						++mFileChangeMonitoringCallCount;
+						// the callback is called after the settle time
+						events.push_back(ChangeEvent(cb.mFileCallbackId, ts));
 					}
 				}
 			}
@@ -536,10 +538,122 @@ int gs::FileChangeMonitoring::monitoringFileChanges()
 			}
 		}
 	}
+	for (const ChangeEvent& e : events) {
+		pushEvent(e);
+	}
 	return changeCount;
 #endif
 }
 
+void gs::FileChangeMonitoring::pushEvent(const ChangeEvent& e)
+{
+	while (!mEvents.push(e)) {
+		if (!mUseSeparateMonitoringThread) {
+			// the producer is also the consumer
+			takeEvents();
+			continue;
+		}
+		if (!mRunning) {
+			return;
+		}
+		// the queue is full --> wait for the next checkChanges()
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+void gs::FileChangeMonitoring::takeEvents()
+{
+	ChangeEvent e;
+	std::lock_guard<std::mutex> lock(mSync);
+	while (mEvents.pop(e)) {
+		if (mFilesByCallbackId.find(e.mCallbackId) == mFilesByCallbackId.end()) {
+			continue; // removed after the event
+		}
+		auto itChange = mChangeMap.find(e.mCallbackId);
+		if (itChange == mChangeMap.end()) {
+			mChangeMap[e.mCallbackId] = PendingChange(e.mTs);
+		}
+		else {
+			// a new event restarts the settle time
+			itChange->second.mLastTs = e.mTs;
+		}
+	}
+}
+
+int gs::FileChangeMonitoring::callSettledCallbacks()
+{
+	// copies --> the callbacks are called without the lock
+	std::vector<std::pair<Callback, uint32_t /* first event ts */> > settled;
+	{
+		std::lock_guard<std::mutex> lock(mSync);
+		if (mChangeMap.empty()) {
+			return 0;
+		}
+		uint32_t ts = SDL_GetTicks();
+		for (TChangeMapByCallbackId::iterator itChange = mChangeMap.begin(); itChange != mChangeMap.end(); ) {
+			unsigned int cbId = itChange->first;
+			const auto& itEntry = mFilesByCallbackId.find(cbId);
+			if (itEntry == mFilesByCallbackId.end()) {
+				LOGW("Can't find callback for callback id %u.\n", cbId);
+				itChange = mChangeMap.erase(itChange);
+				continue;
+			}
+			const FileEntryNamePair& fen = itEntry->second;
+			const Callback* cbPtr = fen.mFileEntry->getCallbackForFile(fen.mBasename, cbId);
+			if (cbPtr && ts - itChange->second.mLastTs < cbPtr->mSettleMsec) {
+				// the file can be written again
+				++itChange;
+				continue;
+			}
+			if (cbPtr) {
+				settled.push_back(std::make_pair(*cbPtr, itChange->second.mFirstTs));
+			}
+			itChange = mChangeMap.erase(itChange);
+		}
+	}
+	// the content of a file is only hashed once (e.g. more callbacks for the same file)
+	std::map<std::string, uint64_t> contentHashes;
+	for (const auto& it : settled) {
+		const Callback& cb = it.first;
+		if (cb.mCheckContent && contentHashes.find(cb.mFilename) == contentHashes.end()) {
+			contentHashes[cb.mFilename] = calcContentHash(cb.mFilename);
+		}
+	}
+	HotReloadStatistic& hrs = getHotReloadStatistic();
+	for (const auto& it : settled) {
+		const Callback& cb = it.first;
+		{
+			std::lock_guard<std::mutex> lock(mSync);
+			// can be removed by a previous callback
+			const auto& itEntry = mFilesByCallbackId.find(cb.mFileCallbackId);
+			if (itEntry == mFilesByCallbackId.end()) {
+				continue;
+			}
+			const FileEntryNamePair& fen = itEntry->second;
+			Callback* cbPtr = fen.mFileEntry->getCallbackForFile(fen.mBasename, cb.mFileCallbackId);
+			if (!cbPtr) {
+				continue;
+			}
+			if (cb.mCheckContent) {
+				uint64_t contentHash = contentHashes[cb.mFilename];
+				if (contentHash == cbPtr->mContentHash) {
+					LOGI("Content of file %s is not changed --> no callback.\n", cb.mFilename.c_str());
+					++mUnchangedContentCount;
+					continue;
+				}
+				cbPtr->mContentHash = contentHash;
+			}
+			++cbPtr->mCallCount;
+			++mFileChangeMonitoringCallCount;
+		}
+		LOGI("Call callback function for file %s, orig name %s.\n", cb.mFilename.c_str(), cb.mOrigFilename.c_str());
+		unsigned int reloadId = hrs.beginCallback(cb.mOrigFilename, it.second);
+		cb.mCbFunc(cb.mFileCallbackId, cb.mOrigFilename, cb.mParam1, cb.mParam2);
+		hrs.endCallback(reloadId);
+	}
+	return static_cast<int>(settled.size());
+}
+
 /////////////////////////////////
 
 gs::FileChangeMonitoring::FileEntry::FileEntry(
@@ -757,7 +871,7 @@ void CALLBACK gs::FileChangeMonitoring::FileChangedCallback(DWORD dwErrorCode, D
 			++fcm->mFileChangeCount;
 			for (auto& cbIt : fn->mCallbacks) {
 				Callback& cb = cbIt.second;
-				fcm->mChangeMap[cb.mFileCallbackId] = ts;
+				fcm->pushEvent(ChangeEvent(cb.mFileCallbackId, ts));
 				LOGI("file %s, orig name %s changed!\n", cb.mFilename.c_str(), cb.mOrigFilename.c_str());
 			}
 		}
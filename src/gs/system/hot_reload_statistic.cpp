@@ -0,0 +1,189 @@
+#include <gs/system/hot_reload_statistic.h>
+#include <gs/system/log.h>
+#include <SDL.h>
+#include <vector>
+#include <algorithm>
+
+namespace gs
+{
+	namespace
+	{
+		HotReloadStatistic hotReloadStatistic;
+
+		// a record which is not finished after this time is dropped
+		// (e.g. an attached resource never finished the reload)
+		const uint32_t MAX_RELOAD_MSEC = 60000;
+	}
+}
+
+uint32_t gs::HotReloadStatistic::Record::getMsec(HotReloadPhase phase) const
+{
+	switch (phase) {
+		case HotReloadPhase::DETECT:
+			return mCallbackTs - mEventTs;
+		case HotReloadPhase::LOAD:
+			return mLoadedTs - mCallbackTs;
+		case HotReloadPhase::UPLOAD:
+			return mUploadedTs - mLoadedTs;
+		case HotReloadPhase::PRESENT:
+			return mPresentedTs - mUploadedTs;
+		case HotReloadPhase::TOTAL:
+			return mPresentedTs - mEventTs;
+	}
+	return 0;
+}
+
+gs::HotReloadStatistic::HotReloadStatistic()
+		:mActive(), mHistory(), mNextReloadId(1), mCurrentReloadId(0)
+{
+}
+
+gs::HotReloadStatistic::~HotReloadStatistic()
+{
+}
+
+unsigned int gs::HotReloadStatistic::beginCallback(const std::string& filename, uint32_t eventTs)
+{
+	unsigned int reloadId = mNextReloadId;
+	++mNextReloadId;
+	if (!mNextReloadId) {
+		mNextReloadId = 1;
+	}
+	Record& r = mActive[reloadId];
+	r.mFilename = filename;
+	r.mEventTs = eventTs;
+	r.mCallbackTs = SDL_GetTicks();
+	mCurrentReloadId = reloadId;
+	return reloadId;
+}
+
+void gs::HotReloadStatistic::endCallback(unsigned int reloadId)
+{
+	mCurrentReloadId = 0;
+	Record* r = getActive(reloadId);
+	if (!r) {
+		return;
+	}
+	r->mIsCallbackDone = true;
+	if (!r->mPendingCount && !r->mUploadedTs) {
+		// nothing is attached (e.g. a script) --> the callback is the reload
+		uint32_t ts = SDL_GetTicks();
+		if (!r->mLoadedTs) {
+			r->mLoadedTs = ts;
+		}
+		r->mUploadedTs = ts;
+	}
+}
+
+unsigned int gs::HotReloadStatistic::attachCurrent()
+{
+	Record* r = getActive(mCurrentReloadId);
+	if (!r) {
+		return 0;
+	}
+	++r->mPendingCount;
+	return mCurrentReloadId;
+}
+
+void gs::HotReloadStatistic::markLoaded(unsigned int reloadId)
+{
+	Record* r = getActive(reloadId);
+	if (!r) {
+		return;
+	}
+	// the last attached resource which is loaded
+	r->mLoadedTs = SDL_GetTicks();
+}
+
+void gs::HotReloadStatistic::markUploaded(unsigned int reloadId)
+{
+	Record* r = getActive(reloadId);
+	if (!r) {
+		return;
+	}
+	uint32_t ts = SDL_GetTicks();
+	if (!r->mLoadedTs) {
+		r->mLoadedTs = ts;
+	}
+	r->mUploadedTs = ts;
+	if (r->mPendingCount) {
+		--r->mPendingCount;
+	}
+}
+
+void gs::HotReloadStatistic::release(unsigned int reloadId)
+{
+	auto it = mActive.find(reloadId);
+	if (it == mActive.end()) {
+		return;
+	}
+	Record& r = it->second;
+	if (r.mPendingCount) {
+		--r.mPendingCount;
+	}
+	if (!r.mPendingCount && !r.mUploadedTs && r.mIsCallbackDone) {
+		// nothing of this file change is shown
+		mActive.erase(it);
+	}
+}
+
+void gs::HotReloadStatistic::endFrame()
+{
+	if (mActive.empty()) {
+		return;
+	}
+	uint32_t ts = SDL_GetTicks();
+	auto it = mActive.begin();
+	while (it != mActive.end()) {
+		Record& r = it->second;
+		if (!r.mIsCallbackDone || r.mPendingCount || !r.mUploadedTs) {
+			if (ts - r.mEventTs > MAX_RELOAD_MSEC) {
+				LOGW("hot reloading of %s is not finished --> no latency\n", r.mFilename.c_str());
+				it = mActive.erase(it);
+			}
+			else {
+				++it;
+			}
+			continue;
+		}
+		r.mPresentedTs = ts;
+		LOGI("hot reloading latency of %s: %u ms (detect %u, load %u, upload %u, present %u)\n",
+				r.mFilename.c_str(), r.getMsec(HotReloadPhase::TOTAL),
+				r.getMsec(HotReloadPhase::DETECT), r.getMsec(HotReloadPhase::LOAD),
+				r.getMsec(HotReloadPhase::UPLOAD), r.getMsec(HotReloadPhase::PRESENT));
+		mHistory.push_back(std::move(r));
+		if (mHistory.size() > HISTORY_SIZE) {
+			mHistory.pop_front();
+		}
+		it = mActive.erase(it);
+	}
+}
+
+uint32_t gs::HotReloadStatistic::getPercentile(HotReloadPhase phase, unsigned int percent) const
+{
+	if (mHistory.empty()) {
+		return 0;
+	}
+	std::vector<uint32_t> values;
+	values.reserve(mHistory.size());
+	for (const Record& r : mHistory) {
+		values.push_back(r.getMsec(phase));
+	}
+	size_t index = (values.size() - 1) * std::min(percent, 100u) / 100;
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+gs::HotReloadStatistic::Record* gs::HotReloadStatistic::getActive(unsigned int reloadId)
+{
+	if (!reloadId) {
+		return nullptr;
+	}
+	auto it = mActive.find(reloadId);
+	return (it != mActive.end()) ? &it->second : nullptr;
+}
+
+gs::HotReloadStatistic& gs::getHotReloadStatistic()
+{
+	return hotReloadStatistic;
+}